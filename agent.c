@@ -0,0 +1,160 @@
+// agent.c — shared-memory observation/action channel (see agent.h).
+#define _POSIX_C_SOURCE 200809L
+#include "agent.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "the channel needs lock-free atomics to work across processes");
+_Static_assert((AGENT_SLOTS & (AGENT_SLOTS-1)) == 0, "AGENT_SLOTS must be a power of two");
+
+static double now_ms(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1e3 + ts.tv_nsec*1e-6;
+}
+
+static inline void cpu_relax(void){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Waiting on the other process: spin briefly (the answer is usually microseconds
+// away when both sides have a core), then yield the CPU, which is what hands over on a
+// machine with fewer cores than runnable threads, then sleep in short naps so an idle
+// peer costs nothing. With one CPU the peer cannot run while we spin, so that step is
+// skipped. `round` counts calls within one wait; false once the deadline passed.
+static int spin_rounds = -1;
+
+static bool backoff(int* round, double deadline){
+    if(spin_rounds < 0) spin_rounds = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 200 : 0;
+    int r = (*round)++;
+    if(r < spin_rounds){ cpu_relax(); return true; }
+    if(r < 1200){ sched_yield(); return true; }
+    if(deadline >= 0 && now_ms() >= deadline) return false;
+    struct timespec nap = { 0, 50000 };
+    nanosleep(&nap, NULL);
+    return true;
+}
+
+static AgentShared* map_region(const char* path, bool create, char* err, size_t errlen){
+    // A new environment gets a new file: an agent still mapping the old one keeps it
+    // and sees env_open cleared, instead of the pages vanishing under it.
+    if(create) unlink(path);
+    int fd = create ? open(path, O_RDWR|O_CREAT|O_EXCL, 0600) : open(path, O_RDWR);
+    if(fd < 0){ snprintf(err, errlen, "agent: cannot open %s", path); return NULL; }
+    struct stat st;
+    if(create ? ftruncate(fd, sizeof(AgentShared)) != 0 : fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AgentShared)){
+        close(fd);
+        snprintf(err, errlen, create ? "agent: cannot size %s" : "agent: %s is not an environment's channel", path);
+        return NULL;
+    }
+    void* m = mmap(NULL, sizeof(AgentShared), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED){ snprintf(err, errlen, "agent: cannot map %s", path); return NULL; }
+    return m;
+}
+
+// ===== Environment side =====
+bool agent_create(AgentLink* l, const char* path, char* err, size_t errlen){
+    memset(l, 0, sizeof *l);
+    AgentShared* sh = map_region(path, true, err, errlen);
+    if(!sh) return false;
+    // A fresh file reads as zeros: no observation, no action, no agent.
+    sh->version = AGENT_VERSION; sh->size = sizeof(AgentShared); sh->slots = AGENT_SLOTS;
+    sh->map_w = MAP_W; sh->map_h = MAP_H;
+    atomic_store(&sh->env_open, 1);
+    atomic_store_explicit(&sh->magic, AGENT_MAGIC, memory_order_release);
+    l->sh = sh; l->env = true; l->next = 1;
+    return true;
+}
+
+uint32_t agent_publish(AgentLink* l, const Game* gm, uint32_t episode, int events, bool done){
+    uint32_t seq = l->next++;
+    AgentObs* o = &l->sh->obs[seq & (AGENT_SLOTS-1)];
+    atomic_store_explicit(&o->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);      // readers that see new fields see seq 0 too
+    o->tick = gm->ticks; o->episode = episode; o->events = (uint32_t)events;
+    o->score = gm->score; o->lives = gm->lives; o->pellets = gm->pellets; o->eat_streak = gm->eat_streak;
+    o->done = done; o->won = gm->won; o->over = gm->over; o->phase_mode = (uint8_t)current_phase_mode(gm);
+    o->pac = (AgentPos){ gm->pac.x, gm->pac.y, gm->pac.dx, gm->pac.dy };
+    for(int i=0;i<4;i++){
+        const Ghost* g = &gm->ghosts[i];
+        o->ghost[i] = (AgentPos){ g->e.x, g->e.y, g->e.dx, g->e.dy };
+        o->ghost_mode[i] = g->mode; o->fright_timer[i] = g->fright_timer;
+    }
+    o->bits = gm->bits;
+    atomic_store_explicit(&o->seq, seq, memory_order_release);
+    atomic_store_explicit(&l->sh->obs_seq, seq, memory_order_release);
+    return seq;
+}
+
+int agent_wait_action(AgentLink* l, uint32_t seq, int timeout_ms){
+    AgentShared* sh = l->sh;
+    double deadline = timeout_ms < 0 ? -1 : now_ms() + timeout_ms;
+    int round = 0;
+    while(atomic_load_explicit(&sh->act_seq, memory_order_acquire) != seq){
+        if(round >= 1200 && !atomic_load_explicit(&sh->agent_open, memory_order_relaxed) &&
+           atomic_load_explicit(&sh->act_seq, memory_order_relaxed) != 0) return AGENT_GONE;
+        if(!backoff(&round, deadline)) return AGENT_TIMEOUT;
+    }
+    return atomic_load_explicit(&sh->action, memory_order_relaxed);
+}
+
+// ===== Agent side =====
+bool agent_attach(AgentLink* l, const char* path, char* err, size_t errlen){
+    memset(l, 0, sizeof *l);
+    AgentShared* sh = map_region(path, false, err, errlen);
+    if(!sh) return false;
+    if(atomic_load_explicit(&sh->magic, memory_order_acquire) != AGENT_MAGIC ||
+       sh->version != AGENT_VERSION || sh->size != sizeof(AgentShared) || sh->map_w != MAP_W || sh->map_h != MAP_H){
+        munmap(sh, sizeof(AgentShared));
+        snprintf(err, errlen, "agent: %s is from another version or board size", path);
+        return false;
+    }
+    atomic_store(&sh->agent_open, 1);
+    l->sh = sh;
+    return true;
+}
+
+const AgentObs* agent_wait_obs(AgentLink* l, uint32_t after, int timeout_ms){
+    AgentShared* sh = l->sh;
+    double deadline = timeout_ms < 0 ? -1 : now_ms() + timeout_ms;
+    int round = 0;
+    uint32_t seq;
+    while((seq = atomic_load_explicit(&sh->obs_seq, memory_order_acquire)) == after){
+        if(!atomic_load_explicit(&sh->env_open, memory_order_relaxed)) return NULL;
+        if(!backoff(&round, deadline)) return NULL;
+    }
+    return &sh->obs[seq & (AGENT_SLOTS-1)];
+}
+
+const AgentObs* agent_obs(const AgentLink* l, uint32_t seq){
+    const AgentObs* o = &l->sh->obs[seq & (AGENT_SLOTS-1)];
+    return seq && atomic_load_explicit(&o->seq, memory_order_acquire) == seq ? o : NULL;
+}
+
+bool agent_obs_valid(const AgentObs* o, uint32_t seq){
+    atomic_thread_fence(memory_order_acquire);      // the reads of *o happen before this check
+    return atomic_load_explicit(&((AgentObs*)o)->seq, memory_order_relaxed) == seq;
+}
+
+void agent_act(AgentLink* l, uint32_t seq, int action){
+    atomic_store_explicit(&l->sh->action, action, memory_order_relaxed);
+    atomic_store_explicit(&l->sh->act_seq, seq, memory_order_release);
+}
+
+void agent_close(AgentLink* l, const char* path){
+    if(!l->sh) return;
+    if(l->env){ atomic_store(&l->sh->env_open, 0); if(path) unlink(path); }
+    else atomic_store(&l->sh->agent_open, 0);
+    munmap(l->sh, sizeof(AgentShared));
+    l->sh = NULL;
+}
@@ -0,0 +1,99 @@
+// agent.h — observation/action channel for an agent in another local process. The
+// environment (headless --agent) and the agent map the same file (a tmpfs path such
+// as /dev/shm/pacman_agent, so nothing touches a disk). The environment writes each
+// tick's state straight into the next slot of a ring in the mapping, with the board in
+// the simulation's own bit-plane layout. The agent reads it in place and answers by
+// storing an action and the number of the observation it answers. Both sides only
+// wait on atomic counters in the mapping: no sockets, system calls or serialization
+// per step, so the step rate is set by the simulation and the agent's policy.
+//
+// Lockstep: every observation gets exactly one action, and the environment steps only
+// once it has it. Episodes follow each other; the last observation of one has `done`
+// set, and its action is an acknowledgement (ignored). The ring keeps the last
+// AGENT_SLOTS observations for frame stacking; agent_obs_valid() tells whether an
+// older one has been overwritten while it was being read.
+//
+// Atomics in the mapping are lock-free 32-bit ones, which work across processes.
+#ifndef PACMAN_AGENT_H
+#define PACMAN_AGENT_H
+
+#include "sim.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AGENT_MAGIC 0x31474150u     // "PAG1"
+#define AGENT_VERSION 1
+#define AGENT_SLOTS 16              // observation ring, a power of two
+#define AGENT_DEFAULT_PATH "/dev/shm/pacman_agent"
+
+// Actions: a heading, which is also its index into NAV_DIRS (nav.h), or:
+#define AGENT_RIGHT 0
+#define AGENT_LEFT  1
+#define AGENT_DOWN  2               // +y: rows count down the screen
+#define AGENT_UP    3
+#define AGENT_KEEP  (-1)            // keep the current heading
+#define AGENT_RESET (-2)            // end the episode now; the next observation starts a new one
+// agent_wait_action() only:
+#define AGENT_TIMEOUT (-3)
+#define AGENT_GONE    (-4)          // the agent detached
+
+typedef struct { int32_t x, y, dx, dy; } AgentPos;
+
+// One tick as the agent sees it. 64-byte aligned so slots never share a cache line.
+typedef struct {
+    _Atomic uint32_t seq;           // observation number held; 0 while being written
+    uint32_t tick;                  // game ticks so far
+    uint32_t episode;               // counts from 0
+    uint32_t events;                // EV_* flags of the tick that led here
+    int32_t score, lives, pellets, eat_streak;
+    uint8_t done, won, over, phase_mode;    // phase_mode: GhostMode of the schedule
+    AgentPos pac, ghost[4];
+    uint32_t ghost_mode[4];         // GhostMode
+    uint32_t fright_timer[4];       // tick frightened ends (compare with `tick`)
+    BoardBits bits;                 // wall, gate, pellet, power: bit x of row y
+} __attribute__((aligned(64))) AgentObs;
+
+typedef struct {
+    _Atomic uint32_t magic;         // AGENT_MAGIC once the rest of the header is set
+    uint32_t version, size, slots, map_w, map_h;
+    _Atomic uint32_t env_open;      // cleared when the environment closes
+    char pad0[36];
+    _Atomic uint32_t obs_seq;       // newest published observation; 0 before the first
+    char pad1[60];
+    _Atomic uint32_t act_seq;       // observation the newest action answers
+    _Atomic int32_t action;
+    _Atomic uint32_t agent_open;    // set while an agent is attached
+    char pad2[52];
+    AgentObs obs[AGENT_SLOTS];      // observation n lives in obs[n % AGENT_SLOTS]
+} AgentShared;
+
+typedef struct {
+    AgentShared* sh;
+    bool env;                       // created (environment side) rather than attached
+    uint32_t next;                  // environment: number of the next observation
+} AgentLink;
+
+// Environment side: create (or replace) the mapping at path. false with the reason in err.
+bool agent_create(AgentLink* l, const char* path, char* err, size_t errlen);
+// Fill the next slot from gm and publish it; returns its number.
+uint32_t agent_publish(AgentLink* l, const Game* gm, uint32_t episode, int events, bool done);
+// Wait for the action answering observation seq. timeout_ms < 0 waits indefinitely.
+int agent_wait_action(AgentLink* l, uint32_t seq, int timeout_ms);
+
+// Agent side: attach to an environment's mapping.
+bool agent_attach(AgentLink* l, const char* path, char* err, size_t errlen);
+// Newest observation numbered after `after`, or NULL once timeout_ms passes (< 0: no
+// limit) or the environment has closed. The pointer is into the mapping.
+const AgentObs* agent_wait_obs(AgentLink* l, uint32_t after, int timeout_ms);
+// Observation seq if the ring still holds it, else NULL.
+const AgentObs* agent_obs(const AgentLink* l, uint32_t seq);
+// After reading *o in place: whether it still held observation seq throughout.
+bool agent_obs_valid(const AgentObs* o, uint32_t seq);
+void agent_act(AgentLink* l, uint32_t seq, int action);
+
+// Unmap; the environment also marks the channel closed and removes the file.
+void agent_close(AgentLink* l, const char* path);
+
+#endif
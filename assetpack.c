@@ -0,0 +1,141 @@
+// assetpack.c — mapping, lookup, writing and verifying asset archives (see assetpack.h).
+#include "assetpack.h"
+#include "mapfile.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(ArchiveHeader)==32, "ArchiveHeader layout");
+_Static_assert(sizeof(ArchiveEntry)==64, "ArchiveEntry layout");
+
+struct AssetPack {
+    MappedFile file;
+    int count;
+    const ArchiveEntry* entries;
+};
+
+static size_t align_up(size_t v){ return (v + ARCHIVE_ALIGN-1) & ~(size_t)(ARCHIVE_ALIGN-1); }
+
+static uint32_t fnv(const uint8_t* p, size_t n){
+    uint32_t h = 2166136261u;
+    for(size_t i=0;i<n;i++){ h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+static bool fail(char* err, size_t errlen, const char* fmt, ...){
+    if(err && errlen){ va_list ap; va_start(ap, fmt); vsnprintf(err, errlen, fmt, ap); va_end(ap); }
+    return false;
+}
+
+// ===== Loading =====
+AssetPack* assetpack_open(const char* path, char* err, size_t errlen){
+    AssetPack* p = calloc(1, sizeof *p);
+    if(!p){ fail(err, errlen, "out of memory"); return NULL; }
+    if(!mapfile_open(&p->file, path, err, errlen)){ free(p); return NULL; }
+    const uint8_t* data = p->file.data; size_t size = p->file.size;
+    const ArchiveHeader* h = (const ArchiveHeader*)data;
+    const char* why = NULL;
+    if(size < sizeof *h || memcmp(h->magic, ARCHIVE_MAGIC, 4)!=0) why = "not an asset archive";
+    else if(h->version!=ARCHIVE_VERSION) why = "unsupported archive version";
+    else if(h->file_size!=size) why = "truncated archive";
+    else if(h->count>4096 || h->entries_off%8 || (uint64_t)h->entries_off + (uint64_t)h->count*sizeof(ArchiveEntry) > size)
+        why = "bad directory";
+    if(!why){
+        p->count = (int)h->count;
+        p->entries = (const ArchiveEntry*)(data + h->entries_off);
+        for(int i=0;i<p->count && !why;i++){
+            const ArchiveEntry* e = &p->entries[i];
+            if(memchr(e->name, 0, ARCHIVE_NAME_LEN)==NULL || !e->name[0]) why = "bad entry name";
+            else if((uint64_t)e->offset + e->size > size) why = "entry out of bounds";
+        }
+    }
+    if(why){ fail(err, errlen, "%s: %s", path, why); assetpack_close(p); return NULL; }
+    return p;
+}
+
+void assetpack_close(AssetPack* p){
+    if(!p) return;
+    mapfile_close(&p->file);
+    free(p);
+}
+
+int assetpack_count(const AssetPack* p){ return p ? p->count : 0; }
+const ArchiveEntry* assetpack_entry(const AssetPack* p, int i){ return &p->entries[i]; }
+const void* assetpack_data(const AssetPack* p, int i){ return p->file.data + p->entries[i].offset; }
+
+const void* assetpack_find(const AssetPack* p, const char* name, size_t* size){
+    for(int i=0;p && i<p->count;i++)       // a handful of entries: a scan beats a hash here
+        if(strcmp(p->entries[i].name, name)==0){
+            if(size) *size = p->entries[i].size;
+            return assetpack_data(p, i);
+        }
+    return NULL;
+}
+
+int assetpack_verify(const AssetPack* p, char* err, size_t errlen){
+    int bad = 0;
+    for(int i=0;i<p->count;i++){
+        const ArchiveEntry* e = &p->entries[i];
+        if(fnv(assetpack_data(p, i), e->size)!=e->checksum){
+            if(!bad) fail(err, errlen, "%s: checksum mismatch", e->name);
+            bad++;
+        }
+        for(int j=0;j<i;j++) if(strcmp(p->entries[j].name, e->name)==0){
+            if(!bad) fail(err, errlen, "%s: duplicate name", e->name);
+            bad++;
+        }
+    }
+    return bad;
+}
+
+// ===== Writing =====
+static uint8_t* read_file(const char* path, size_t* size){
+    FILE* f = fopen(path, "rb");
+    if(!f) return NULL;
+    fseek(f, 0, SEEK_END); long n = ftell(f); fseek(f, 0, SEEK_SET);
+    uint8_t* buf = n>=0 ? malloc((size_t)n + 1) : NULL;
+    if(buf && fread(buf, 1, (size_t)n, f)!=(size_t)n){ free(buf); buf = NULL; }
+    fclose(f);
+    *size = (size_t)n;
+    return buf;
+}
+
+bool assetpack_write(const char* path, const char* const* names, const char* const* files, int count, char* err, size_t errlen){
+    ArchiveEntry* ent = calloc((size_t)count + 1, sizeof *ent);
+    uint8_t** blobs = calloc((size_t)count + 1, sizeof *blobs);
+    bool ok = ent && blobs;
+    if(!ok) fail(err, errlen, "out of memory");
+    size_t off = align_up(sizeof(ArchiveHeader) + (size_t)count*sizeof(ArchiveEntry));
+    for(int i=0;ok && i<count;i++){
+        size_t n;
+        if(strlen(names[i])>=ARCHIVE_NAME_LEN){ ok = fail(err, errlen, "%s: name longer than %d bytes", names[i], ARCHIVE_NAME_LEN-1); break; }
+        if(!(blobs[i] = read_file(files[i], &n))){ ok = fail(err, errlen, "cannot read %s", files[i]); break; }
+        if(off + n > UINT32_MAX){ ok = fail(err, errlen, "archive larger than 4 GiB"); break; }
+        memcpy(ent[i].name, names[i], strlen(names[i]));
+        ent[i].offset = (uint32_t)off; ent[i].size = (uint32_t)n;
+        ent[i].checksum = fnv(blobs[i], n);
+        off = align_up(off + n);
+    }
+    FILE* f = ok ? fopen(path, "wb") : NULL;
+    if(ok && !f) ok = fail(err, errlen, "cannot create %s", path);
+    if(ok){
+        ArchiveHeader h; memset(&h, 0, sizeof h);
+        memcpy(h.magic, ARCHIVE_MAGIC, 4);
+        h.version = ARCHIVE_VERSION; h.count = (uint32_t)count;
+        h.entries_off = sizeof h; h.file_size = (uint32_t)off;
+        static const uint8_t zero[ARCHIVE_ALIGN];
+        size_t pos = sizeof h + (size_t)count*sizeof *ent;
+        ok = fwrite(&h, sizeof h, 1, f)==1 && fwrite(ent, sizeof *ent, (size_t)count, f)==(size_t)count;
+        for(int i=0;ok && i<count;i++){
+            ok = fwrite(zero, 1, ent[i].offset - pos, f)==ent[i].offset - pos && fwrite(blobs[i], 1, ent[i].size, f)==ent[i].size;
+            pos = ent[i].offset + ent[i].size;
+        }
+        if(ok) ok = fwrite(zero, 1, off - pos, f)==off - pos;
+        if(fclose(f)!=0) ok = false;
+        if(!ok) fail(err, errlen, "cannot write %s", path);
+    }
+    for(int i=0;blobs && i<count;i++) free(blobs[i]);
+    free(blobs); free(ent);
+    return ok;
+}
@@ -0,0 +1,51 @@
+// assetpack.h — every game asset (font, music, sound effects) in one file that is
+// memory-mapped once at startup. Assets are looked up by their path below assets/
+// ("audio/menu_title.wav") and handed out as pointers into the mapping, so the front
+// end can wrap them in SDL_RWFromConstMem and decode straight from the page cache with
+// no intermediate copies. Archives are written by tools/assetc.c. No SDL dependency.
+//
+// File layout, little-endian:
+//   ArchiveHeader | ArchiveEntry[count] | file data (each blob 16-byte aligned)
+#ifndef PACMAN_ASSETPACK_H
+#define PACMAN_ASSETPACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARCHIVE_MAGIC "PMAR"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_NAME_LEN 48
+#define ARCHIVE_ALIGN 16
+
+typedef struct {
+    char magic[4];
+    uint32_t version, count;
+    uint32_t entries_off, file_size;
+    uint32_t reserved[3];
+} ArchiveHeader;
+
+typedef struct {
+    char name[ARCHIVE_NAME_LEN];     // NUL-terminated, '/' separated
+    uint32_t offset, size;
+    uint32_t checksum;               // FNV-1a of the data (checked by assetc check)
+    uint32_t reserved;
+} ArchiveEntry;
+
+typedef struct AssetPack AssetPack;
+
+// Map an archive and check its directory. NULL on failure with the reason in err.
+AssetPack* assetpack_open(const char* path, char* err, size_t errlen);
+void assetpack_close(AssetPack* pack);
+int assetpack_count(const AssetPack* pack);
+const ArchiveEntry* assetpack_entry(const AssetPack* pack, int i);
+const void* assetpack_data(const AssetPack* pack, int i);
+// Data of the named asset, valid until assetpack_close(); NULL if absent.
+const void* assetpack_find(const AssetPack* pack, const char* name, size_t* size);
+
+// Offline side (tools/assetc.c): pack files from disk under the given names.
+bool assetpack_write(const char* path, const char* const* names, const char* const* files, int count, char* err, size_t errlen);
+// Directory checks plus a checksum of every blob; returns the number of bad entries.
+int assetpack_verify(const AssetPack* pack, char* err, size_t errlen);
+
+#endif
@@ -0,0 +1,278 @@
+// batch.c — structure-of-arrays stepping of many games; mirrors game_step() in sim.c.
+// A tick is a sequence of passes over a chunk of environments. The passes that touch
+// every environment (schedule, targeting, movement, collision tests) are branch-light
+// loops over the field arrays; the rare per-game events (eating a ghost, dying,
+// clearing the board) are handled one environment at a time afterwards.
+
+#include "batch.h"
+#include "nav.h"
+#include "graph.h"
+#include <stdlib.h>
+#include <string.h>
+
+// NAV_DIRS index of a unit heading, by (dy+1)*3 + (dx+1); -1 for (0,0) or diagonals.
+static const int8_t DIR_OF[9] = { -1, 3, -1, 1, -1, 0, -1, 2, -1 };
+
+// Fill the glide and scatter tables by asking the scalar code, so they cannot disagree.
+static void build_tables(BatchSim* b){
+    static const Point CORNER[4]={{MAP_W-2,0},{1,0},{MAP_W-2,MAP_H-2},{1,MAP_H-2}};
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) for(int h=0;h<4;h++){
+        b->glide[y][x][h] = (int8_t)graph_glide_dir(b->graph, x, y, h);
+        for(int g=0;g<4;g++){
+            int dir = nav_next_dir(b->nav, (Point){x,y}, CORNER[g]);
+            if(dir<0){
+                Entity en={x,y,NAV_DIRS[h][0],NAV_DIRS[h][1],0,0};
+                choose_dir_toward(&b->proto, &en, CORNER[g], passable_for_ghost);
+                dir = DIR_OF[(en.dy+1)*3 + en.dx+1];
+            }
+            b->scatter[g][y][x][h] = (int8_t)dir;
+        }
+    }
+}
+
+bool batch_init(BatchSim* b, int n, uint64_t base_seed){
+    memset(b, 0, sizeof *b);
+    b->n = n;
+    // Shared tables are built here, on one thread, before any worker reads them.
+    game_new(&b->proto, 0);
+    b->nav = b->proto.nav; b->graph = b->proto.graph;
+    if(!b->nav || !b->graph || n<=0) return false;
+    size_t m = (size_t)n;
+    bool ok = true;
+#define ALLOC(field) ok = ok && ((field) = calloc(m, sizeof *(field))) != NULL
+    ALLOC(b->pac_x); ALLOC(b->pac_y); ALLOC(b->pac_dx); ALLOC(b->pac_dy);
+    for(int g=0;g<4;g++){ ALLOC(b->gx[g]); ALLOC(b->gy[g]); ALLOC(b->gdx[g]); ALLOC(b->gdy[g]); ALLOC(b->gmode[g]); ALLOC(b->gfright[g]); }
+    ALLOC(b->score); ALLOC(b->lives); ALLOC(b->pellets); ALLOC(b->eat_streak);
+    ALLOC(b->won); ALLOC(b->over); ALLOC(b->ticks); ALLOC(b->phase_start); ALLOC(b->phase_idx);
+    ALLOC(b->rng); ALLOC(b->pellet); ALLOC(b->power);
+    ALLOC(b->seed); ALLOC(b->episode); ALLOC(b->events);
+#undef ALLOC
+    ok = ok && (b->glide = calloc(MAP_H, sizeof *b->glide)) && (b->scatter = calloc(4, sizeof *b->scatter));
+    if(!ok){ batch_free(b); return false; }
+    build_tables(b);
+    for(int e=0;e<n;e++) batch_reset(b, e, base_seed + (uint64_t)e);
+    return true;
+}
+
+void batch_free(BatchSim* b){
+    free(b->pac_x); free(b->pac_y); free(b->pac_dx); free(b->pac_dy);
+    for(int g=0;g<4;g++){ free(b->gx[g]); free(b->gy[g]); free(b->gdx[g]); free(b->gdy[g]); free(b->gmode[g]); free(b->gfright[g]); }
+    free(b->score); free(b->lives); free(b->pellets); free(b->eat_streak);
+    free(b->won); free(b->over); free(b->ticks); free(b->phase_start); free(b->phase_idx);
+    free(b->rng); free(b->pellet); free(b->power);
+    free(b->seed); free(b->episode); free(b->events);
+    free(b->glide); free(b->scatter);
+    memset(b, 0, sizeof *b);
+}
+
+static void reset_positions_env(BatchSim* b, int e){
+    const Game* pr = &b->proto;
+    b->pac_x[e]=(int16_t)pr->pac.startx; b->pac_y[e]=(int16_t)pr->pac.starty; b->pac_dx[e]=-1; b->pac_dy[e]=0;
+    for(int g=0;g<4;g++){
+        b->gx[g][e]=(int16_t)pr->ghosts[g].e.startx; b->gy[g][e]=(int16_t)pr->ghosts[g].e.starty;
+        b->gdx[g][e]=1; b->gdy[g][e]=0;
+    }
+}
+
+void batch_reset(BatchSim* b, int e, uint64_t seed){
+    const Game* pr = &b->proto;
+    reset_positions_env(b, e);
+    for(int g=0;g<4;g++){ b->gmode[g][e]=MODE_SCATTER; b->gfright[g][e]=0; }
+    b->score[e]=0; b->lives[e]=pr->lives; b->pellets[e]=pr->pellets; b->eat_streak[e]=0;
+    b->won[e]=0; b->over[e]=0; b->ticks[e]=0; b->phase_start[e]=0; b->phase_idx[e]=0;
+    b->rng[e] = seed ? seed : SIM_DEFAULT_SEED;
+    memcpy(b->pellet[e], pr->bits.pellet, sizeof b->pellet[e]);
+    memcpy(b->power[e], pr->bits.power, sizeof b->power[e]);
+    b->seed[e]=seed; b->events[e]=0;
+}
+
+// ghost_target() for ghost g across [lo,hi), then clamped to the board as step_ghosts() does.
+static void targets(const BatchSim* b, int g, int lo, int hi, int16_t* restrict tx, int16_t* restrict ty){
+    static const int CX[4]={MAP_W-2,1,MAP_W-2,1}, CY[4]={0,0,MAP_H-2,MAP_H-2};
+    const int16_t* restrict px=b->pac_x+lo; const int16_t* restrict py=b->pac_y+lo;
+    const int16_t* restrict gx=b->gx[g]+lo; const int16_t* restrict gy=b->gy[g]+lo;
+    const int16_t* restrict rx=b->gx[RED]+lo; const int16_t* restrict ry=b->gy[RED]+lo;
+    const int8_t* restrict pdx=b->pac_dx+lo; const int8_t* restrict pdy=b->pac_dy+lo;
+    const uint8_t* restrict mode=b->gmode[g]+lo;
+    int n=hi-lo, ahead = g==PINK ? 4 : 2, sx=CX[g], sy=CY[g];
+    for(int i=0;i<n;i++){
+        int ax = px[i]+pdx[i]*ahead, ay = py[i]+pdy[i]*ahead;
+        ax = ax<0 ? MAP_W-1 : ax>=MAP_W ? 0 : ax;
+        int cx=px[i], cy=py[i];                                   // RED
+        if(g==PINK){ cx=ax; cy=ay; }
+        else if(g==BLUE){ cx=2*ax-rx[i]; cy=2*ay-ry[i]; }
+        else if(g==ORANGE){
+            int dx=px[i]-gx[i], dy=py[i]-gy[i];
+            int near = dx*dx+dy*dy < 64;
+            cx = near ? CX[ORANGE] : cx; cy = near ? CY[ORANGE] : cy;
+        }
+        int scatter = mode[i]==MODE_SCATTER;
+        cx = scatter ? sx : cx; cy = scatter ? sy : cy;
+        cx = cx<0 ? 0 : cx>=MAP_W ? MAP_W-1 : cx;
+        cy = cy<0 ? 0 : cy>=MAP_H ? MAP_H-1 : cy;
+        tx[i]=(int16_t)cx; ty[i]=(int16_t)cy;
+    }
+}
+
+// Heading for ghost g in every live game: follow the corridor, or decide at a node.
+static void decide(BatchSim* b, int g, int lo, int hi, const uint8_t* live, const int16_t* tx, const int16_t* ty){
+    int16_t *gx=b->gx[g], *gy=b->gy[g]; int8_t *gdx=b->gdx[g], *gdy=b->gdy[g];
+    const uint8_t* mode=b->gmode[g];
+    for(int e=lo;e<hi;e++){
+        if(!live[e-lo]) continue;
+        int h = DIR_OF[(gdy[e]+1)*3 + gdx[e]+1];
+        int dir = h>=0 ? b->glide[gy[e]][gx[e]][h] : -1;
+        if(dir<0 && mode[e]==MODE_FRIGHT) dir = (int)(sim_rand(&b->rng[e])%4);
+        else if(dir<0 && mode[e]==MODE_SCATTER && h>=0) dir = b->scatter[g][gy[e]][gx[e]][h];
+        else if(dir<0){
+            Point src={gx[e],gy[e]}, tgt={tx[e-lo],ty[e-lo]};
+            dir = nav_next_dir(b->nav, src, tgt);
+            if(dir<0){
+                Entity en={gx[e],gy[e],gdx[e],gdy[e],0,0};
+                choose_dir_toward(&b->proto, &en, tgt, passable_for_ghost);
+                gdx[e]=(int8_t)en.dx; gdy[e]=(int8_t)en.dy;
+            }
+        }
+        if(dir>=0){ gdx[e]=(int8_t)NAV_DIRS[dir][0]; gdy[e]=(int8_t)NAV_DIRS[dir][1]; }
+    }
+}
+
+static void step_range(BatchSim* b, const int8_t* act, int lo, int hi){
+    const Game* pr = &b->proto;
+    const uint32_t *wall = pr->bits.wall, *gate = pr->bits.gate;
+    int n = hi-lo;
+    uint8_t live[BATCH_CHUNK], cur[BATCH_CHUNK], blocked[BATCH_CHUNK];
+    int16_t tx[BATCH_CHUNK], ty[BATCH_CHUNK], nx[BATCH_CHUNK], ny[BATCH_CHUNK];
+
+    // Restart finished games, apply this tick's input.
+    for(int e=lo;e<hi;e++){
+        if(b->auto_reset && (b->won[e] || b->over[e])){
+            b->episode[e]++;
+            batch_reset(b, e, b->seed[e] + (uint64_t)b->n);
+        }
+        if(act && act[e]>=0){ b->pac_dx[e]=(int8_t)NAV_DIRS[act[e]][0]; b->pac_dy[e]=(int8_t)NAV_DIRS[act[e]][1]; }
+    }
+    for(int i=0;i<n;i++){ live[i] = !(b->won[lo+i] | b->over[lo+i]); b->events[lo+i]=0; b->ticks[lo+i] += live[i]; }
+
+    // Scatter/chase schedule (paused while any ghost is frightened).
+    for(int e=lo;e<hi;e++){
+        int idx = b->phase_idx[e];
+        uint32_t dur = PHASES[idx].dur_ticks;
+        bool any_fright = b->gmode[0][e]==MODE_FRIGHT || b->gmode[1][e]==MODE_FRIGHT
+                       || b->gmode[2][e]==MODE_FRIGHT || b->gmode[3][e]==MODE_FRIGHT;
+        if(live[e-lo] && !any_fright && dur && b->ticks[e] - b->phase_start[e] >= dur && idx < PHASE_COUNT-1){
+            b->phase_idx[e] = (uint8_t)++idx; b->phase_start[e] = b->ticks[e];
+            for(int g=0;g<4;g++) b->gmode[g][e] = (uint8_t)PHASES[idx].mode;   // none frightened here
+        }
+        cur[e-lo] = (uint8_t)PHASES[idx].mode;
+    }
+
+    // Pac-Man: move if passable, then pellet test against this game's bit planes.
+    for(int e=lo;e<hi;e++){
+        if(!live[e-lo]) continue;
+        int x=b->pac_x[e]+b->pac_dx[e], y=b->pac_y[e]+b->pac_dy[e];
+        if(in_bounds(x,y) && ((wall[y]|gate[y])>>x & 1u)) continue;
+        x = x<0 ? MAP_W-1 : x>=MAP_W ? 0 : x;
+        b->pac_x[e]=(int16_t)x; b->pac_y[e]=(int16_t)y;
+        if(!in_bounds(x,y)) continue;
+        uint32_t bit=1u<<x;
+        if(!((b->pellet[e][y]|b->power[e][y]) & bit)) continue;
+        bool power = b->power[e][y] & bit;
+        b->pellet[e][y] &= ~bit; b->power[e][y] &= ~bit;
+        b->pellets[e]--; b->eat_streak[e]=0;
+        if(power){
+            b->score[e]+=50; b->events[e]|=EV_POWER;
+            for(int g=0;g<4;g++){ b->gmode[g][e]=MODE_FRIGHT; b->gfright[g][e]=b->ticks[e]+FRIGHT_TICKS; }
+        }else{ b->score[e]+=10; b->events[e]|=EV_PELLET; }
+        if(b->pellets[e]<=0){ b->won[e]=1; b->events[e]|=EV_WON; live[e-lo]=0; }
+    }
+
+    // Ghosts in id order, so Inky sees where Blinky moved this tick.
+    for(int g=0;g<4;g++){
+        int16_t* restrict gx=b->gx[g]+lo; int16_t* restrict gy=b->gy[g]+lo;
+        int8_t* restrict gdx=b->gdx[g]+lo; int8_t* restrict gdy=b->gdy[g]+lo;
+        uint8_t* restrict mode=b->gmode[g]+lo;
+        const uint32_t* restrict fright=b->gfright[g]+lo; const uint32_t* restrict tick=b->ticks+lo;
+        for(int i=0;i<n;i++){
+            int expire = live[i] & (mode[i]==MODE_FRIGHT) & (tick[i]>=fright[i]);
+            mode[i] = expire ? cur[i] : mode[i];
+        }
+        targets(b, g, lo, hi, tx, ty);
+        decide(b, g, lo, hi, live, tx, ty);
+        for(int i=0;i<n;i++){
+            int x=gx[i]+gdx[i];
+            nx[i] = (int16_t)(x<0 ? MAP_W-1 : x>=MAP_W ? 0 : x);
+            ny[i] = (int16_t)(gy[i]+gdy[i]);
+        }
+        for(int i=0;i<n;i++) blocked[i] = in_bounds(nx[i],ny[i]) && (wall[ny[i]]>>nx[i] & 1u);
+        for(int i=0;i<n;i++){
+            int move = live[i] & !blocked[i], bounce = live[i] & blocked[i];
+            gx[i] = move ? nx[i] : gx[i]; gy[i] = move ? ny[i] : gy[i];
+            gdx[i] = (int8_t)(bounce ? -gdx[i] : gdx[i]); gdy[i] = (int8_t)(bounce ? -gdy[i] : gdy[i]);
+        }
+    }
+
+    // Collisions: a 4-bit mask per game of ghosts on Pac-Man's tile; resolve the few hits.
+    uint8_t hit[BATCH_CHUNK];
+    {
+        const int16_t* restrict px=b->pac_x+lo; const int16_t* restrict py=b->pac_y+lo;
+        for(int i=0;i<n;i++) hit[i]=0;
+        for(int g=0;g<4;g++){
+            const int16_t* restrict gx=b->gx[g]+lo; const int16_t* restrict gy=b->gy[g]+lo;
+            for(int i=0;i<n;i++) hit[i] |= (uint8_t)(((gx[i]==px[i]) & (gy[i]==py[i]) & live[i]) << g);
+        }
+    }
+    for(int e=lo;e<hi;e++){
+        int h=hit[e-lo];
+        for(int g=0; h; g++, h>>=1){
+            if(!(h & 1)) continue;
+            if(b->gmode[g][e]==MODE_FRIGHT){
+                int s=b->eat_streak[e];
+                b->score[e] += 200 << (s>3?3:s); b->eat_streak[e]++;
+                b->gx[g][e]=(int16_t)pr->ghosts[g].e.startx; b->gy[g][e]=(int16_t)pr->ghosts[g].e.starty;
+                b->gmode[g][e]=cur[e-lo]; b->gfright[g][e]=0;
+                b->events[e]|=EV_GHOST_EATEN;
+            }else{
+                b->lives[e]--; b->events[e]|=EV_DEATH;
+                if(b->lives[e]<=0){ b->over[e]=1; b->events[e]|=EV_OVER; }
+                reset_positions_env(b, e);
+                break;
+            }
+        }
+    }
+}
+
+typedef struct { BatchSim* b; const int8_t* act; } StepJob;
+
+static void step_chunk(void* ctx, int chunk, int worker){
+    (void)worker;
+    StepJob* j = ctx;
+    int lo = chunk*BATCH_CHUNK, hi = lo+BATCH_CHUNK;
+    if(hi > j->b->n) hi = j->b->n;
+    step_range(j->b, j->act, lo, hi);
+}
+
+void batch_step(BatchSim* b, const int8_t* actions, Pool* pool){
+    StepJob job = { b, actions };
+    int chunks = (b->n + BATCH_CHUNK-1) / BATCH_CHUNK;
+    if(pool) pool_run(pool, chunks, step_chunk, &job);
+    else for(int c=0;c<chunks;c++) step_chunk(&job, c, 0);
+}
+
+void batch_get(const BatchSim* b, int e, Game* out){
+    game_new(out, b->seed[e]);
+    out->pac.x=b->pac_x[e]; out->pac.y=b->pac_y[e]; out->pac.dx=b->pac_dx[e]; out->pac.dy=b->pac_dy[e];
+    for(int g=0;g<4;g++){
+        Ghost* gh=&out->ghosts[g];
+        gh->e.x=b->gx[g][e]; gh->e.y=b->gy[g][e]; gh->e.dx=b->gdx[g][e]; gh->e.dy=b->gdy[g][e];
+        gh->mode=(GhostMode)b->gmode[g][e]; gh->fright_timer=b->gfright[g][e];
+    }
+    out->score=b->score[e]; out->lives=b->lives[e]; out->pellets=b->pellets[e]; out->eat_streak=b->eat_streak[e];
+    out->won=b->won[e]; out->over=b->over[e];
+    out->ticks=b->ticks[e]; out->rng=b->rng[e];
+    out->phase_idx=b->phase_idx[e]; out->phase_start=b->phase_start[e];
+    memcpy(out->bits.pellet, b->pellet[e], sizeof out->bits.pellet);
+    memcpy(out->bits.power, b->power[e], sizeof out->bits.power);
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++)
+        if((out->board[y][x]=='.' || out->board[y][x]=='o') && !is_food_at(out,x,y)) out->board[y][x]=' ';
+}
@@ -0,0 +1,59 @@
+// batch.h — many independent LEVEL0 games stepped together, for training farms.
+// Per-game state is stored structure-of-arrays (one array per field, indexed by
+// environment), so the per-tick passes — fright expiry, ghost targeting, movement,
+// collision tests — are straight loops over contiguous arrays that the compiler can
+// vectorize. Each environment follows exactly the rules of game_step() (sim.h):
+// batch_get() + game_hash() of an environment equals the hash of a Game driven
+// with the same seed and inputs.
+#ifndef PACMAN_BATCH_H
+#define PACMAN_BATCH_H
+
+#include "sim.h"
+#include "pool.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BATCH_CHUNK 64          // environments per pool task
+
+typedef struct {
+    int n;
+    const struct NavTable* nav;
+    const struct MazeGraph* graph;
+    Game proto;                 // fresh game: start positions, walls and gate (never change)
+    // Decisions that depend only on tile and heading, tabulated once per batch:
+    // corridor glide (graph_glide_dir, -1 at nodes) and, per ghost, the heading
+    // taken toward its fixed scatter corner.
+    int8_t (*glide)[MAP_W][4];
+    int8_t (*scatter)[MAP_H][MAP_W][4];
+
+    // Pac-Man
+    int16_t *pac_x, *pac_y; int8_t *pac_dx, *pac_dy;
+    // Ghosts: [ghost][env]
+    int16_t *gx[4], *gy[4]; int8_t *gdx[4], *gdy[4];
+    uint8_t *gmode[4]; uint32_t *gfright[4];
+    // Progress
+    int32_t *score, *lives, *pellets, *eat_streak;
+    uint8_t *won, *over;
+    uint32_t *ticks, *phase_start; uint8_t *phase_idx;
+    uint64_t *rng;
+    uint32_t (*pellet)[MAP_H], (*power)[MAP_H];
+    // Per-episode bookkeeping
+    uint64_t *seed; uint32_t *episode;
+    int32_t *events;            // EV_* flags from the last batch_step()
+    bool auto_reset;            // finished games restart on the following step
+} BatchSim;
+
+// n environments; environment e starts with seed base_seed+e. false if out of memory.
+bool batch_init(BatchSim* b, int n, uint64_t base_seed);
+void batch_free(BatchSim* b);
+void batch_reset(BatchSim* b, int env, uint64_t seed);
+
+// One tick for every environment. actions[e] is a NAV_DIRS index applied with
+// game_set_dir() before the tick, or -1 to keep the heading; actions may be NULL.
+// pool may be NULL to run on the calling thread.
+void batch_step(BatchSim* b, const int8_t* actions, Pool* pool);
+
+// Copy one environment out as an ordinary Game (for rendering, hashing, debugging).
+void batch_get(const BatchSim* b, int env, Game* out);
+
+#endif
@@ -0,0 +1,116 @@
+// agent_bench.c — shared-memory agent channel (agent.c) against stepping in-process.
+// A forked child plays the agent: it waits for each observation, reads the board
+// planes and entities in place and answers with the bench_suite heading policy. The
+// parent is the environment loop of headless --agent. The same games are then played
+// directly with game_step(); both runs must end with the same game hashes, and the
+// difference in steps/s is what the channel costs per step.
+// Build: cc -O2 -pthread -I. bench/agent_bench.c agent.c sim.c nav.c graph.c trace.c telemetry.c -o agent_bench
+// Usage: ./agent_bench [games] [path]   (defaults 200, a scratch file under /dev/shm or /tmp)
+
+#define _POSIX_C_SOURCE 200809L
+#include "agent.h"
+#include "nav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_TICKS 20000
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// New heading every 6 ticks from a per-episode PRNG, as in bench_suite's games.
+static const int HEADINGS[4] = { AGENT_RIGHT, AGENT_LEFT, AGENT_DOWN, AGENT_UP };
+static int policy(uint64_t* prng, uint32_t tick){ return tick%6==0 ? HEADINGS[sim_rand(prng)%4] : AGENT_KEEP; }
+
+// The named actions must steer where they say, or an agent written against agent.h
+// turns the wrong way while both runs below still agree.
+static bool headings_match(void){
+    static const int want[4][3] = { {AGENT_RIGHT,1,0}, {AGENT_LEFT,-1,0}, {AGENT_DOWN,0,1}, {AGENT_UP,0,-1} };
+    for(int i=0;i<4;i++) if(NAV_DIRS[want[i][0]][0]!=want[i][1] || NAV_DIRS[want[i][0]][1]!=want[i][2]) return false;
+    return true;
+}
+
+static int agent_child(const char* path){
+    AgentLink l; char err[256];
+    double give_up = now_sec() + 5;
+    while(!agent_attach(&l, path, err, sizeof err)){
+        if(now_sec() > give_up){ fprintf(stderr, "%s\n", err); return 1; }
+        nanosleep(&(struct timespec){ 0, 1000000 }, NULL);
+    }
+    uint32_t seen = 0, episode = UINT32_MAX; uint64_t prng = 0; unsigned long food = 0;
+    const AgentObs* o;
+    while((o = agent_wait_obs(&l, seen, 10000))){
+        uint32_t seq = atomic_load_explicit(&((AgentObs*)o)->seq, memory_order_acquire);
+        if(o->episode != episode){ episode = o->episode; prng = 1000 + (uint64_t)episode + 1; }
+        for(int y=0;y<MAP_H;y++) food += (unsigned)popcount32(o->bits.pellet[y] | o->bits.power[y]);  // touch the planes
+        agent_act(&l, seq, o->done ? AGENT_KEEP : policy(&prng, o->tick));
+        seen = seq;
+    }
+    agent_close(&l, NULL);
+    return food ? 0 : 1;
+}
+
+int main(int argc, char** argv){
+    long games = argc>1 ? atol(argv[1]) : 200;
+    if(!headings_match()){ fprintf(stderr, "AGENT_RIGHT/LEFT/DOWN/UP do not match NAV_DIRS\n"); return 1; }
+    char path[256];
+    if(argc>2) snprintf(path, sizeof path, "%s", argv[2]);
+    else snprintf(path, sizeof path, "%s/pacman_agent_bench.%d", access("/dev/shm", W_OK)==0 ? "/dev/shm" : "/tmp", (int)getpid());
+
+    AgentLink env; char err[256];
+    if(!agent_create(&env, path, err, sizeof err)){ fprintf(stderr, "%s\n", err); return 1; }
+    pid_t child = fork();
+    if(child < 0){ perror("fork"); agent_close(&env, path); return 1; }
+    if(child == 0) _exit(agent_child(path));
+
+    // Through the channel.
+    Game gm; uint32_t sum_ipc = 2166136261u; long steps = 0; bool ok = true;
+    double t0 = now_sec();
+    for(long n=0; n<games && ok; n++){
+        game_new(&gm, (uint64_t)n + 1);
+        int ev = 0;
+        for(;;){
+            bool done = gm.won || gm.over || gm.ticks>=MAX_TICKS;
+            uint32_t seq = agent_publish(&env, &gm, (uint32_t)n, ev, done);
+            int act = agent_wait_action(&env, seq, 10000);
+            if(act==AGENT_TIMEOUT || act==AGENT_GONE){ fprintf(stderr, "agent lost at game %ld\n", n); ok = false; break; }
+            if(done) break;
+            if(act >= 0) game_set_dir(&gm, NAV_DIRS[act][0], NAV_DIRS[act][1]);
+            ev = game_step(&gm); steps++;
+        }
+        sum_ipc = (sum_ipc ^ game_hash(&gm))*16777619u;
+    }
+    double t_ipc = now_sec()-t0;
+    agent_close(&env, path);
+    int status = 0;
+    waitpid(child, &status, 0);
+    if(!WIFEXITED(status) || WEXITSTATUS(status)!=0) ok = false;
+
+    // In-process, same seeds and policy.
+    uint32_t sum_direct = 2166136261u; long direct_steps = 0;
+    t0 = now_sec();
+    for(long n=0; n<games; n++){
+        game_new(&gm, (uint64_t)n + 1); uint64_t prng = 1000 + (uint64_t)n + 1;
+        while(!gm.won && !gm.over && gm.ticks<MAX_TICKS){
+            int act = policy(&prng, gm.ticks);
+            if(act >= 0) game_set_dir(&gm, NAV_DIRS[act][0], NAV_DIRS[act][1]);
+            game_step(&gm); direct_steps++;
+        }
+        sum_direct = (sum_direct ^ game_hash(&gm))*16777619u;
+    }
+    double t_direct = now_sec()-t0;
+
+    bool same = ok && sum_ipc==sum_direct && steps==direct_steps;
+    printf("direct        %10.0f steps/s  %8.3f us/step\n", direct_steps/t_direct, t_direct*1e6/direct_steps);
+    printf("shared memory %10.0f steps/s  %8.3f us/step  (+%.3f us per step for the round trip)\n",
+           steps/t_ipc, t_ipc*1e6/(steps? steps : 1), (t_ipc/(steps? steps : 1) - t_direct/direct_steps)*1e6);
+    printf("games x%ld, %ld steps, checksum %08X vs direct %08X: %s\n",
+           games, steps, (unsigned)sum_ipc, (unsigned)sum_direct, same? "same games" : "DIFFER");
+    return same ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+// batch_bench.c — batched SoA simulator (batch.c) against the one-Game-at-a-time
+// step function: checks every environment stays hash-identical to a Game driven
+// with the same seed and inputs, then reports env-steps/s for scalar game_step(),
+// the batch on one thread, and the batch on the work-stealing pool.
+// Build: cc -O3 -march=native -pthread -I. bench/batch_bench.c batch.c pool.c sim.c nav.c graph.c trace.c telemetry.c -o batch_bench
+
+#define _POSIX_C_SOURCE 199309L
+#include "batch.h"
+#include "nav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// Same random policy for both sides: a new heading every few ticks per environment.
+static void policy(uint64_t* rng, int n, uint32_t tick, int8_t* act){
+    for(int e=0;e<n;e++) act[e] = (tick+(uint32_t)e)%6==0 ? (int8_t)(sim_rand(&rng[e])%4) : -1;
+}
+
+int main(int argc, char** argv){
+    int n = argc>1 ? atoi(argv[1]) : 4096;
+    int ticks = argc>2 ? atoi(argv[2]) : 2000;
+    if(n<1) n=1;
+    int8_t* act = malloc((size_t)n);
+    uint64_t* prng = malloc((size_t)n*sizeof *prng);
+    Game* games = malloc((size_t)n*sizeof *games);
+    BatchSim b;
+    if(!act || !prng || !games || !batch_init(&b, n, 1)){ fprintf(stderr, "out of memory\n"); return 1; }
+
+    // Equivalence: every environment against its own Game, hashed every tick.
+    for(int e=0;e<n;e++){ game_new(&games[e], 1+(uint64_t)e); prng[e]=1000+(uint64_t)e; }
+    long bad=0, finished=0; int first_bad=-1;
+    for(int t=0;t<ticks && !bad;t++){
+        policy(prng, n, (uint32_t)t, act);
+        batch_step(&b, act, NULL);
+        for(int e=0;e<n;e++){
+            if(act[e]>=0) game_set_dir(&games[e], NAV_DIRS[act[e]][0], NAV_DIRS[act[e]][1]);
+            int ev = game_step(&games[e]);
+            Game got; batch_get(&b, e, &got);
+            if(game_hash(&got)!=game_hash(&games[e]) || ev!=b.events[e]){ if(!bad) first_bad=t+1; bad++; }
+        }
+    }
+    for(int e=0;e<n;e++) finished += games[e].won || games[e].over;
+    printf("equivalence         %d envs x %d ticks, %ld finished, %ld mismatches", n, ticks, finished, bad);
+    if(bad) printf(" (first at tick %d)", first_bad);
+    printf("\n");
+    if(bad) return 1;
+
+    // Throughput. Finished games restart so every step does real work.
+    batch_free(&b);
+    for(int e=0;e<n;e++){ game_new(&games[e], 1+(uint64_t)e); prng[e]=1000+(uint64_t)e; }
+    double t0=now_sec();
+    for(int t=0;t<ticks;t++){
+        policy(prng, n, (uint32_t)t, act);
+        for(int e=0;e<n;e++){
+            Game* gm=&games[e];
+            if(gm->won || gm->over) game_new(gm, gm->rng);
+            if(act[e]>=0) game_set_dir(gm, NAV_DIRS[act[e]][0], NAV_DIRS[act[e]][1]);
+            game_step(gm);
+        }
+    }
+    double scalar=(double)n*ticks/(now_sec()-t0);
+    printf("game_step (AoS)     %.2f M env-steps/s\n", scalar/1e6);
+
+    int cores = pool_cpu_count();
+    for(int threads=0;;){                    // inline, then 1, 2, 4, ... threads up to one per CPU
+        Pool* pool = threads ? pool_create(threads) : NULL;
+        if(threads && !pool){ fprintf(stderr, "pool_create(%d) failed\n", threads); return 1; }
+        if(!batch_init(&b, n, 1)){ fprintf(stderr, "out of memory\n"); return 1; }
+        b.auto_reset = true;
+        for(int e=0;e<n;e++) prng[e]=1000+(uint64_t)e;
+        t0=now_sec();
+        for(int t=0;t<ticks;t++){ policy(prng, n, (uint32_t)t, act); batch_step(&b, act, pool); }
+        double dt=now_sec()-t0, rate=(double)n*ticks/dt;
+        int used = threads ? threads : 1;
+        if(threads) printf("batch, pool x%-2d     %.2f M env-steps/s  %.2f M/s per core  steals %ld\n",
+                           threads, rate/1e6, rate/1e6/used, pool_steals(pool));
+        else printf("batch (SoA), inline %.2f M env-steps/s  (%.2fx game_step)\n", rate/1e6, rate/scalar);
+        batch_free(&b);
+        pool_destroy(pool);
+        if(threads==cores) break;
+        threads = !threads ? 1 : threads*2 < cores ? threads*2 : cores;
+    }
+    free(act); free(prng); free(games);
+    return 0;
+}
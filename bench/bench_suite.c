@@ -0,0 +1,241 @@
+// bench_suite.c — the benchmark gate for simulation changes. Micro cases time the
+// hot functions on LEVEL0 over fixed input sets; macro cases play whole games from
+// fixed seeds. Every case folds its results into a checksum that must equal the
+// golden value below, so an optimisation that changes behaviour fails the suite
+// (exit status 1) instead of just looking fast. Rendering has its own cases in the
+// game binary: ./pacman2 --bench-render.
+// Build: cc -O2 -pthread -I. bench/bench_suite.c sim.c nav.c graph.c trace.c telemetry.c stress.c batch.c pool.c -o bench_suite
+// Usage: ./bench_suite [--reps N] [--only NAME] [--update]
+//   --update prints the golden table for the current behaviour instead of checking it;
+//   paste it into GOLDEN only when a behaviour change is intended.
+
+#define _POSIX_C_SOURCE 199309L
+#include "sim.h"
+#include "nav.h"
+#include "stress.h"
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static uint32_t fold(uint32_t h, uint32_t v){ return (h ^ v) * 16777619u; }
+#define FOLD_INIT 2166136261u
+
+// ===== Fixed inputs =====
+#define MICRO_N 4096
+static Game level;                                   // LEVEL0, fresh
+static Point walk[MAP_W*MAP_H]; static int nwalk;    // ghost-walkable tiles
+static Point pair_src[MICRO_N], pair_dst[MICRO_N];
+static Entity dir_ent[MICRO_N]; static Point dir_tgt[MICRO_N];
+static Game* states;                                 // snapshots taken along played games
+
+// Same policy everywhere (and in pacman2 --bench-render): a random heading every 6 ticks.
+static void policy(Game* gm, uint64_t* prng){
+    if(gm->ticks%6==0){ int d=(int)(sim_rand(prng)%4); game_set_dir(gm, NAV_DIRS[d][0], NAV_DIRS[d][1]); }
+}
+
+static bool setup(void){
+    game_new(&level, 1);
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++)
+        if(passable_for_ghost(&level,x,y)) walk[nwalk++]=(Point){x,y};
+    uint64_t r=42;
+    for(int i=0;i<MICRO_N;i++){
+        pair_src[i]=walk[sim_rand(&r)%nwalk]; pair_dst[i]=walk[sim_rand(&r)%nwalk];
+        Point p=walk[sim_rand(&r)%nwalk]; int d=(int)(sim_rand(&r)%4);
+        dir_ent[i]=(Entity){p.x,p.y,NAV_DIRS[d][0],NAV_DIRS[d][1],p.x,p.y};
+        dir_tgt[i]=(Point){(int)(sim_rand(&r)%MAP_W),(int)(sim_rand(&r)%MAP_H)};
+    }
+    // Mid-game states (ghosts spread out, modes mixed) from a few played games.
+    states=malloc(MICRO_N*sizeof *states);
+    if(!states) return false;
+    int got=0;
+    for(uint64_t seed=1; got<MICRO_N; seed++){
+        Game gm; game_new(&gm, seed); uint64_t prng=1000+seed;
+        while(!gm.won && !gm.over && got<MICRO_N){
+            policy(&gm,&prng); game_step(&gm);
+            if(gm.ticks%3==0) states[got++]=gm;
+        }
+    }
+    return true;
+}
+
+// ===== Micro cases: one repetition each, returning a checksum of the outputs =====
+static uint32_t run_next_step_bfs(void){
+    uint32_t h=FOLD_INIT;
+    for(int i=0;i<MICRO_N;i++){
+        Point p=next_step_bfs(&level,pair_src[i],pair_dst[i],passable_for_ghost);
+        h=fold(h,(uint32_t)(p.x*64+p.y));
+    }
+    return h;
+}
+
+static uint32_t run_choose_dir_toward(void){
+    uint32_t h=FOLD_INIT;
+    for(int i=0;i<MICRO_N;i++){
+        Entity e=dir_ent[i];
+        choose_dir_toward(&level,&e,dir_tgt[i],passable_for_ghost);
+        h=fold(h,(uint32_t)((e.dx+1)*4+(e.dy+1)));
+    }
+    return h;
+}
+
+static uint32_t run_ghost_target(void){
+    uint32_t h=FOLD_INIT;
+    for(int i=0;i<MICRO_N;i++) for(int id=0;id<4;id++){
+        Point p=ghost_target((GhostId)id,states[i].pac,states[i].ghosts);
+        h=fold(h,(uint32_t)(p.x*256+p.y));
+    }
+    return h;
+}
+
+static uint32_t run_game_step(void){
+    uint32_t h=FOLD_INIT;
+    for(int i=0;i<MICRO_N;i++){
+        Game gm=states[i];
+        h=fold(h,(uint32_t)game_step(&gm));
+        h=fold(h,(uint32_t)(gm.pac.x*64+gm.pac.y)); h=fold(h,(uint32_t)gm.score);
+        for(int g=0;g<4;g++) h=fold(h,(uint32_t)(gm.ghosts[g].e.x*64+gm.ghosts[g].e.y));
+    }
+    return h;
+}
+
+// ===== Macro cases =====
+#define MACRO_GAMES 1000
+#define MACRO_MAX_TICKS 20000
+static long macro_ticks;      // ticks simulated by the last repetition, for the rate column
+
+static uint32_t run_games(void){
+    uint32_t h=FOLD_INIT; macro_ticks=0;
+    for(uint64_t seed=1;seed<=MACRO_GAMES;seed++){
+        Game gm; game_new(&gm, seed); uint64_t prng=1000+seed;
+        while(!gm.won && !gm.over && gm.ticks<MACRO_MAX_TICKS){ policy(&gm,&prng); game_step(&gm); }
+        macro_ticks+=gm.ticks;
+        h=fold(h,game_hash(&gm));
+    }
+    return h;
+}
+
+#define BATCH_N 1024
+#define BATCH_TICKS 2000
+static uint32_t run_batch(void){
+    static int8_t act[BATCH_N];
+    BatchSim b;
+    if(!batch_init(&b, BATCH_N, 1)) return 0;
+    b.auto_reset=true;
+    uint64_t r=7;
+    for(int t=0;t<BATCH_TICKS;t++){
+        for(int e=0;e<BATCH_N;e++) act[e] = (t+e)%6==0 ? (int8_t)(sim_rand(&r)%4) : -1;
+        batch_step(&b, act, NULL);
+    }
+    uint32_t h=FOLD_INIT;
+    for(int e=0;e<BATCH_N;e++){ Game gm; batch_get(&b,e,&gm); h=fold(h,game_hash(&gm)); h=fold(h,b.episode[e]); }
+    batch_free(&b);
+    macro_ticks=(long)BATCH_N*BATCH_TICKS;
+    return h;
+}
+
+#define STRESS_SIZE 129
+#define STRESS_GHOSTS 256
+#define STRESS_TICKS 500
+static uint32_t run_stress(void){
+    StressWorld sw;
+    if(!stress_init(&sw, STRESS_SIZE, STRESS_SIZE, STRESS_GHOSTS, 1)) return 0;
+    for(int t=0;t<STRESS_TICKS;t++) stress_step(&sw);
+    uint32_t h=FOLD_INIT;
+    h=fold(h,(uint32_t)sw.score); h=fold(h,(uint32_t)sw.deaths);
+    h=fold(h,(uint32_t)sw.ghosts_eaten); h=fold(h,(uint32_t)sw.pellets); h=fold(h,sw.pac);
+    for(int i=0;i<sw.nghosts;i++) h=fold(h,sw.ghosts[i].at);
+    stress_free(&sw);
+    macro_ticks=STRESS_TICKS;
+    return h;
+}
+
+// ===== Suite =====
+typedef struct {
+    const char* name;
+    uint32_t (*run)(void);
+    long ops;                 // calls per repetition for micro cases; 0 = macro (reports ticks)
+} Case;
+
+static const Case CASES[] = {
+    { "next_step_bfs",     run_next_step_bfs,     MICRO_N   },
+    { "choose_dir_toward", run_choose_dir_toward, MICRO_N   },
+    { "ghost_target",      run_ghost_target,      MICRO_N*4 },
+    { "game_step",         run_game_step,         MICRO_N   },
+    { "games_x1000",       run_games,             0 },
+    { "batch_1024x2000",   run_batch,             0 },
+    { "stress_129_g256",   run_stress,            0 },
+};
+static const int CASE_COUNT = sizeof CASES / sizeof CASES[0];
+
+// Checksums of the current behaviour; regenerate with --update.
+typedef struct { const char* name; uint32_t sum; } Golden;
+static const Golden GOLDEN[] = {
+    { "next_step_bfs", 0x8ED10A8Du },
+    { "choose_dir_toward", 0xB0B15C8Du },
+    { "ghost_target", 0x71CA2E37u },
+    { "game_step", 0xEBDF73D5u },
+    { "games_x1000", 0x7C4432D5u },
+    { "batch_1024x2000", 0x62ECDD93u },
+    { "stress_129_g256", 0x7F1A5AD2u },
+};
+static const int GOLDEN_COUNT = sizeof GOLDEN / sizeof GOLDEN[0];
+
+static bool golden_for(const char* name, uint32_t* out){
+    for(int i=0;i<GOLDEN_COUNT;i++) if(strcmp(GOLDEN[i].name,name)==0){ *out=GOLDEN[i].sum; return true; }
+    return false;
+}
+
+static int cmp_double(const void* a, const void* b){
+    double x=*(const double*)a, y=*(const double*)b; return (x>y)-(x<y);
+}
+
+int main(int argc, char** argv){
+    int reps=5; const char* only=NULL; bool update=false;
+    for(int i=1;i<argc;i++){
+        if(strcmp(argv[i],"--reps")==0 && i+1<argc) reps=atoi(argv[++i]);
+        else if(strcmp(argv[i],"--only")==0 && i+1<argc) only=argv[++i];
+        else if(strcmp(argv[i],"--update")==0) update=true;
+        else { fprintf(stderr, "usage: %s [--reps N] [--only NAME] [--update]\n", argv[0]); return 2; }
+    }
+    if(reps<1) reps=1;
+    if(reps>64) reps=64;
+    if(!setup()){ fprintf(stderr, "out of memory\n"); return 1; }
+
+    int failed=0;
+    for(int c=0;c<CASE_COUNT;c++){
+        const Case* k=&CASES[c];
+        if(only && strcmp(only,k->name)!=0) continue;
+        double t[64]; uint32_t sum=0; bool stable=true;
+        for(int r=0;r<reps;r++){
+            double t0=now_sec();
+            uint32_t s=k->run();
+            t[r]=now_sec()-t0;
+            if(r && s!=sum) stable=false;
+            sum=s;
+        }
+        qsort(t, (size_t)reps, sizeof t[0], cmp_double);
+        double med=t[reps/2];
+        uint32_t want=0; bool known=golden_for(k->name,&want);
+        bool ok = stable && (update || (known && sum==want));
+        if(update) printf("    { \"%s\", 0x%08Xu },\n", k->name, sum);
+        else if(k->ops) printf("%-18s %10.1f ns/call   checksum %08X  %s\n", k->name, med*1e9/k->ops, sum, ok?"ok":"FAIL");
+        else printf("%-18s %10.2f ms/run  %10.0f ticks/s  checksum %08X  %s\n",
+                    k->name, med*1e3, macro_ticks/med, sum, ok?"ok":"FAIL");
+        if(!ok){
+            failed++;
+            if(!stable) fprintf(stderr, "%s: checksum differs between repetitions\n", k->name);
+            else if(!known) fprintf(stderr, "%s: no golden checksum\n", k->name);
+            else fprintf(stderr, "%s: expected %08X, got %08X\n", k->name, want, sum);
+        }
+    }
+    free(states);
+    if(failed) printf("%d case(s) FAILED\n", failed);
+    return failed ? 1 : 0;
+}
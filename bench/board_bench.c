@@ -0,0 +1,155 @@
+// board_bench.c — char grid vs bit planes on the queries the simulation hot loop
+// makes: passability tests, pellet counting, nearest-pellet search (the headless
+// bot's BFS) and the ghost path fallback. The char versions are the pre-bitboard
+// code, kept here as the reference; every pair is checked for equal results.
+// Build: cc -O2 -pthread -I. bench/board_bench.c sim.c nav.c graph.c trace.c telemetry.c -o board_bench
+
+#define _POSIX_C_SOURCE 199309L
+#include "sim.h"
+#include "nav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// ===== Char-grid reference =====
+static bool char_pass_pac(const Game* gm,int x,int y){ if(!in_bounds(x,y)) return true; char c=gm->board[y][x]; return c!='#' && c!='H'; }
+static int char_count(const Game* gm){
+    int c=0; for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) if(gm->board[y][x]=='.'||gm->board[y][x]=='o') c++; return c;
+}
+// Steps from Pac-Man to the nearest pellet, -1 if none: queue BFS over chars.
+static int char_nearest(const Game* gm){
+    static unsigned char vis[MAP_H][MAP_W];
+    static uint8_t qx[MAP_W*MAP_H], qy[MAP_W*MAP_H]; static uint16_t qd[MAP_W*MAP_H];
+    memset(vis,0,sizeof vis);
+    int head=0, tail=0;
+    qx[tail]=(uint8_t)gm->pac.x; qy[tail]=(uint8_t)gm->pac.y; qd[tail++]=0; vis[gm->pac.y][gm->pac.x]=1;
+    while(head<tail){
+        int x=qx[head], y=qy[head], d=qd[head]; head++;
+        char c=gm->board[y][x];
+        if(c=='.'||c=='o') return d;
+        for(int i=0;i<4;i++){
+            int nx=(x+NAV_DIRS[i][0]+MAP_W)%MAP_W, ny=y+NAV_DIRS[i][1];
+            if(!in_bounds(nx,ny) || !char_pass_pac(gm,nx,ny) || vis[ny][nx]) continue;
+            vis[ny][nx]=1; qx[tail]=(uint8_t)nx; qy[tail]=(uint8_t)ny; qd[tail++]=(uint16_t)(d+1);
+        }
+    }
+    return -1;
+}
+
+// ===== Bit-plane version =====
+// Same body as passable_for_pac() in sim.c, inlined here like the char reference.
+static bool bits_pass_pac(const Game* gm,int x,int y){ if(!in_bounds(x,y)) return true; return !((gm->bits.wall[y]|gm->bits.gate[y])>>x & 1u); }
+
+// Same search as a frontier flood: one shift/AND pass per row per distance layer.
+static int bits_nearest(const Game* gm){
+    uint32_t open[MAP_H], food[MAP_H], seen[MAP_H]={0}, front[MAP_H]={0}, next[MAP_H];
+    for(int y=0;y<MAP_H;y++){
+        open[y] = ~(gm->bits.wall[y]|gm->bits.gate[y]) & ROW_MASK;
+        food[y] = gm->bits.pellet[y]|gm->bits.power[y];
+    }
+    seen[gm->pac.y]=front[gm->pac.y]=1u<<gm->pac.x;
+    int lo=gm->pac.y, hi=gm->pac.y;
+    for(int d=0;;d++){
+        uint32_t hit=0, any=0;
+        for(int y=lo;y<=hi;y++) hit |= front[y] & food[y];
+        if(hit) return d;
+        if(lo>0) lo--;
+        if(hi<MAP_H-1) hi++;
+        for(int y=lo;y<=hi;y++){
+            uint32_t f=front[y];
+            uint32_t n = f<<1 | f>>1 | (f>>(MAP_W-1) & 1u) | (f&1u)<<(MAP_W-1);
+            if(y>0) n |= front[y-1];
+            if(y<MAP_H-1) n |= front[y+1];
+            next[y] = n & open[y] & ~seen[y];
+            any |= next[y];
+        }
+        if(!any) return -1;
+        for(int y=lo;y<=hi;y++){ front[y]=next[y]; seen[y]|=next[y]; }
+    }
+}
+
+#define STATES 2000
+
+int main(void){
+    // Boards from a fresh level to nearly cleared: state s has about s/STATES of its
+    // pellets eaten, and Pac-Man stands on a random open tile.
+    static Game states[STATES];
+    int ns=0; uint32_t lcg=12345;
+    for(; ns<STATES; ns++){
+        Game* gm=&states[ns]; game_new(gm, (uint64_t)ns+1);
+        uint32_t keep = (uint32_t)(1000 - 990L*ns/STATES);
+        for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+            lcg=lcg*1103515245u+12345u;
+            if(!is_food_at(gm,x,y) || (lcg>>8)%1000 < keep) continue;
+            gm->bits.pellet[y] &= ~(1u<<x); gm->bits.power[y] &= ~(1u<<x); gm->board[y][x]=' '; gm->pellets--;
+        }
+        do{ lcg=lcg*1103515245u+12345u; gm->pac.x=(int)((lcg>>8)%MAP_W); gm->pac.y=(int)((lcg>>16)%MAP_H); }
+        while(!passable_for_pac(gm,gm->pac.x,gm->pac.y));
+    }
+    printf("board states        %d (pellets %d..%d)\n", ns, states[ns-1].pellets, states[0].pellets);
+    volatile long sink=0; long bad=0, fail=0;
+
+    // Passability: every tile of every state.
+    double t=now_sec();
+    for(int s=0;s<ns;s++) for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) sink+=char_pass_pac(&states[s],x,y);
+    double t_char=now_sec()-t;
+    t=now_sec();
+    for(int s=0;s<ns;s++) for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) sink+=bits_pass_pac(&states[s],x,y);
+    double t_bits=now_sec()-t;
+    for(int s=0;s<ns;s++) for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) bad += char_pass_pac(&states[s],x,y)!=passable_for_pac(&states[s],x,y);
+    double q=(double)ns*MAP_W*MAP_H;
+    printf("pac passability     char %.2f ns  bits %.2f ns  (%ld mismatches)\n", t_char*1e9/q, t_bits*1e9/q, bad);
+    fail+=bad;
+
+    // Pellet count: full scan vs popcount (what game_new/reset used to pay).
+    bad=0;
+    t=now_sec(); for(int s=0;s<ns;s++) sink+=char_count(&states[s]); t_char=now_sec()-t;
+    t=now_sec(); for(int s=0;s<ns;s++) sink+=count_pellets(&states[s]); t_bits=now_sec()-t;
+    for(int s=0;s<ns;s++) bad += char_count(&states[s])!=count_pellets(&states[s]) || count_pellets(&states[s])!=states[s].pellets;
+    printf("count_pellets       char %.1f ns  popcount %.1f ns  (%ld mismatches)\n", t_char*1e9/ns, t_bits*1e9/ns, bad);
+    fail+=bad;
+
+    // Nearest pellet from Pac-Man: the headless bot's per-tick search.
+    bad=0;
+    t=now_sec(); for(int s=0;s<ns;s++) sink+=char_nearest(&states[s]); t_char=now_sec()-t;
+    t=now_sec(); for(int s=0;s<ns;s++) sink+=bits_nearest(&states[s]); t_bits=now_sec()-t;
+    for(int s=0;s<ns;s++) bad += char_nearest(&states[s])!=bits_nearest(&states[s]);
+    printf("nearest pellet BFS  queue %.2f us  frontier %.2f us  (%ld mismatches)\n", t_char*1e6/ns, t_bits*1e6/ns, bad);
+    fail+=bad;
+
+    // Ghost path fallback (used when the nav table is unavailable), all pairs vs the table.
+    const Game* gm=&states[0];
+    const NavTable* nt=nav_for_layout(LEVEL0);
+    if(!nt){ fprintf(stderr, "nav table build failed\n"); return 1; }
+    int n=nt->count; long pairs=0; bad=0;
+    for(int a=0;a<n;a++) for(int b=0;b<n;b++){
+        Point pa={nt->tx[a],nt->ty[a]}, pb={nt->tx[b],nt->ty[b]};
+        bad += board_path_dir(gm,pa,pb,true)!=nav_next_dir(nt,pa,pb); pairs++;
+    }
+    enum { QUERIES=20000 };
+    lcg=777;
+    t=now_sec();
+    for(int i=0;i<QUERIES;i++){
+        lcg=lcg*1103515245u+12345u; int a=(lcg>>8)%n; lcg=lcg*1103515245u+12345u; int b=(lcg>>8)%n;
+        Point s=next_step_bfs(gm,(Point){nt->tx[a],nt->ty[a]},(Point){nt->tx[b],nt->ty[b]},passable_for_ghost); sink+=s.x;
+    }
+    t_char=now_sec()-t;
+    lcg=777;
+    t=now_sec();
+    for(int i=0;i<QUERIES;i++){
+        lcg=lcg*1103515245u+12345u; int a=(lcg>>8)%n; lcg=lcg*1103515245u+12345u; int b=(lcg>>8)%n;
+        sink+=board_path_dir(gm,(Point){nt->tx[a],nt->ty[a]},(Point){nt->tx[b],nt->ty[b]},true);
+    }
+    t_bits=now_sec()-t;
+    printf("ghost path step     next_step_bfs %.2f us  board_path_dir %.2f us  (%ld pairs, %ld mismatches vs nav table)\n",
+           t_char*1e6/QUERIES, t_bits*1e6/QUERIES, pairs, bad);
+    fail+=bad;
+    (void)sink;
+    return fail? 1 : 0;
+}
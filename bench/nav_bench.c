@@ -0,0 +1,137 @@
+// nav_bench.c — ghost navigation on LEVEL0: next-hop table vs per-call BFS (memory
+// footprint, all-pairs equivalence, lookup timing) and the junction graph (size,
+// distance queries checked against BFS, share of ghost moves that need a decision, an
+// open room refused instead of overflowing it).
+// Build: cc -O2 -pthread -I. bench/nav_bench.c sim.c nav.c graph.c trace.c telemetry.c -o nav_bench
+
+#define _POSIX_C_SOURCE 199309L
+#include "sim.h"
+#include "nav.h"
+#include "graph.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+int main(void){
+    Game gm; game_new(&gm, 1);
+    static NavTable table;
+    double t0=now_sec();
+    if(!nav_build(&table, LEVEL0)){ fprintf(stderr, "nav table build failed\n"); return 1; }
+    double build_ms=(now_sec()-t0)*1e3;
+    const NavTable* nt = &table;
+    int n = nt->count;
+
+    printf("build               %.2f ms\n", build_ms);
+    printf("walkable tiles      %d of %d\n", n, MAP_W*MAP_H);
+    printf("index (uint16)      %zu bytes\n", sizeof nt->index);
+    printf("reverse index       %zu bytes\n", sizeof nt->tx + sizeof nt->ty);
+    printf("next-hop matrix     %zu bytes (%d x %d x 1)\n", (size_t)n*n, n, n);
+    printf("total               %zu bytes\n", nav_footprint(nt));
+
+    // Every (src,dst) pair must agree with next_step_bfs().
+    long mismatches=0, pairs=0;
+    for(int s=0;s<n;s++) for(int d=0;d<n;d++){
+        Point src={nt->tx[s],nt->ty[s]}, dst={nt->tx[d],nt->ty[d]};
+        Point bfs=next_step_bfs(&gm,src,dst,passable_for_ghost);
+        int dir=nav_next_dir(nt,src,dst);
+        Point tab=src;
+        if(dir>=0){ tab.x=(src.x+NAV_DIRS[dir][0]+MAP_W)%MAP_W; tab.y=src.y+NAV_DIRS[dir][1]; }
+        if(bfs.x!=tab.x || bfs.y!=tab.y) mismatches++;
+        pairs++;
+    }
+    printf("equivalence         %ld pairs, %ld mismatches\n", pairs, mismatches);
+
+    // Timing: same pseudo-random query stream through both paths.
+    enum { QUERIES = 200000 };
+    unsigned lcg=12345; volatile int sink=0;
+    double t=now_sec();
+    for(int q=0;q<QUERIES;q++){
+        lcg=lcg*1103515245u+12345u; int s=(lcg>>8)%n;
+        lcg=lcg*1103515245u+12345u; int d=(lcg>>8)%n;
+        Point p=next_step_bfs(&gm,(Point){nt->tx[s],nt->ty[s]},(Point){nt->tx[d],nt->ty[d]},passable_for_ghost);
+        sink+=p.x;
+    }
+    double bfs_ns=(now_sec()-t)*1e9/QUERIES;
+    lcg=12345;
+    t=now_sec();
+    for(int q=0;q<QUERIES;q++){
+        lcg=lcg*1103515245u+12345u; int s=(lcg>>8)%n;
+        lcg=lcg*1103515245u+12345u; int d=(lcg>>8)%n;
+        sink+=nav_next_dir(nt,(Point){nt->tx[s],nt->ty[s]},(Point){nt->tx[d],nt->ty[d]});
+    }
+    double tab_ns=(now_sec()-t)*1e9/QUERIES;
+    printf("next_step_bfs       %.1f ns/query\n", bfs_ns);
+    printf("nav_next_dir        %.1f ns/query (%.0fx)\n", tab_ns, tab_ns>0? bfs_ns/tab_ns : 0.0);
+    nav_release(&table);
+
+    // ----- Junction graph -----
+    const MazeGraph* mg = gm.graph;
+    if(!mg){ fprintf(stderr, "graph build failed\n"); return 1; }
+    int corridor=0;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) if(mg->edge_of[y][x]!=GRAPH_NONE) corridor++;
+    printf("graph nodes         %d (corridor tiles %d of %d walkable)\n", mg->nodes, corridor, n);
+    printf("graph edges         %d\n", mg->edges);
+    printf("node distance table %zu bytes\n", (size_t)mg->nodes*mg->nodes*sizeof *mg->dist);
+
+    // graph_dist() must equal BFS distance for every pair of walkable tiles.
+    static int dist[MAP_H][MAP_W];
+    static Point queue[MAP_W*MAP_H];
+    long dist_bad=0;
+    for(int s=0;s<n;s++){
+        for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) dist[y][x]=-1;
+        int head=0, tail=0;
+        queue[tail++]=(Point){nt->tx[s],nt->ty[s]}; dist[nt->ty[s]][nt->tx[s]]=0;
+        while(head<tail){
+            Point c=queue[head++];
+            for(int i=0;i<4;i++){
+                int x=(c.x+NAV_DIRS[i][0]+MAP_W)%MAP_W, y=c.y+NAV_DIRS[i][1];
+                if(!in_bounds(x,y) || is_wall_at(&gm,x,y) || dist[y][x]>=0) continue;
+                dist[y][x]=dist[c.y][c.x]+1; queue[tail++]=(Point){x,y};
+            }
+        }
+        for(int d=0;d<n;d++) if(graph_dist(mg,(Point){nt->tx[s],nt->ty[s]},(Point){nt->tx[d],nt->ty[d]})!=dist[nt->ty[d]][nt->tx[d]]) dist_bad++;
+    }
+    printf("graph_dist check    %ld pairs, %ld mismatches\n", pairs, dist_bad);
+
+    lcg=12345;
+    t=now_sec();
+    for(int q=0;q<QUERIES;q++){
+        lcg=lcg*1103515245u+12345u; int s=(lcg>>8)%n;
+        lcg=lcg*1103515245u+12345u; int d=(lcg>>8)%n;
+        sink+=graph_dist(mg,(Point){nt->tx[s],nt->ty[s]},(Point){nt->tx[d],nt->ty[d]});
+    }
+    printf("graph_dist          %.1f ns/query\n", (now_sec()-t)*1e9/QUERIES);
+
+    // How often does a ghost actually stand on a junction when it moves?
+    srand(1);
+    long moves=0, decisions=0;
+    for(int g=0;g<50;g++){
+        Game sim; game_new(&sim, (uint64_t)g+1);
+        while(!sim.won && !sim.over && sim.ticks<3000){
+            for(int i=0;i<4;i++){ moves++; if(graph_is_node(mg,sim.ghosts[i].e.x,sim.ghosts[i].e.y)) decisions++; }
+            static const int turn[4][2]={{0,-1},{-1,0},{0,1},{1,0}};
+            if(sim.ticks%8==0){ int r=rand()%4; game_set_dir(&sim,turn[r][0],turn[r][1]); }
+            game_step(&sim);
+        }
+    }
+    printf("ghost decisions     %ld of %ld moves (%.1f%%)\n", decisions, moves, moves? 100.0*decisions/moves : 0.0);
+
+    // An open room makes nearly every tile a junction: more nodes than the graph holds,
+    // which graph_build() must refuse rather than write past its arrays.
+    static char room[MAP_H][MAP_W+1];
+    static const char* room_rows[MAP_H];
+    for(int y=0;y<MAP_H;y++){
+        for(int x=0;x<MAP_W;x++) room[y][x] = (x==0 || y==0 || x==MAP_W-1 || y==MAP_H-1) ? '#' : '.';
+        room_rows[y] = room[y];
+    }
+    static MazeGraph open_room;
+    bool refused = !graph_build(&open_room, room_rows, true) && open_room.too_open;
+    graph_release(&open_room);
+    printf("open room graph     %s\n", refused ? "refused (too open)" : "NOT refused");
+    return (mismatches || dist_bad || !refused)? 1 : 0;
+}
@@ -0,0 +1,180 @@
+// reload_bench.c — live level reload (levelwatch.h) against loading the level afresh.
+// A scratch copy of a text level is edited in two ways, pellets only and one wall
+// opened, and each edit and its undo is reloaded into a game in progress with
+// live_reload() + live_apply(). The reference is
+// what a reload cost before: parse, build both ghost tables and reset the board.
+// Every reload is checked against that from-scratch state: board, bit planes and
+// pellet count (tiles the edit left alone keep what was eaten), the next-hop table and
+// the graph distances. Last, the time from a save to the watcher's callback.
+// Build: cc -O2 -pthread -I. bench/reload_bench.c levelwatch.c levelpack.c mapfile.c sim.c nav.c graph.c trace.c telemetry.c -o reload_bench
+// Usage: ./reload_bench [level.txt] [reloads]   (defaults levels/classic.txt, 200)
+
+#define _POSIX_C_SOURCE 200809L
+#include "levelwatch.h"
+#include "levelpack.h"
+#include "nav.h"
+#include "graph.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now_ms(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1e3 + ts.tv_nsec*1e-6;
+}
+
+static bool write_level(const char* path, const LevelSource* s){
+    char tmp[600]; snprintf(tmp, sizeof tmp, "%s.tmp", path);
+    FILE* f = fopen(tmp, "w");
+    if(!f) return false;
+    fprintf(f, "name %s\npac %d %d\n", s->name, s->pac_spawn.x, s->pac_spawn.y);
+    for(int i=0;i<4;i++) fprintf(f, "ghost %d %d\n", s->ghost_spawn[i].x, s->ghost_spawn[i].y);
+    fprintf(f, "phases");
+    for(int i=0;i<s->phase_count;i++) fprintf(f, " %c%u", s->phases[i].mode==MODE_SCATTER ? 'S' : 'C', s->phases[i].dur_ticks*TICK_MS);
+    fprintf(f, "\nmap\n");
+    for(int y=0;y<MAP_H;y++) fprintf(f, "%.*s\n", MAP_W, s->tiles[y]);
+    return fclose(f)==0 && rename(tmp, path)==0;     // a save by rename, as editors do
+}
+
+// The played game moved onto lv from scratch: every tile the reload changed takes
+// lv's contents, every other tile keeps what the played board shows.
+static bool matches_scratch(const Game* gm, const Game* before, const Level* old, const Level* lv){
+    Game want = *before; want.level = lv;
+    reset_board(&want);
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++)
+        if(old->layout[y][x]==lv->layout[y][x]) want.board[y][x] = before->board[y][x];
+    memset(&want.bits, 0, sizeof want.bits);
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        char c = want.board[y][x]; uint32_t bit = 1u<<x;
+        if(c=='#') want.bits.wall[y] |= bit;
+        else if(c=='H') want.bits.gate[y] |= bit;
+        else if(c=='.') want.bits.pellet[y] |= bit;
+        else if(c=='o') want.bits.power[y] |= bit;
+    }
+    if(memcmp(gm->board, want.board, sizeof want.board) || memcmp(&gm->bits, &want.bits, sizeof want.bits) ||
+       gm->pellets != count_pellets(&want)) return false;
+    NavTable nt; MazeGraph mg;
+    if(!nav_build(&nt, lv->layout) || !graph_build(&mg, lv->layout, true)) return false;
+    bool same = nt.count==lv->nav->count && memcmp(nt.index, lv->nav->index, sizeof nt.index)==0 &&
+                memcmp(nt.next, lv->nav->next, (size_t)nt.count*nt.count)==0;
+    for(int a=0; same && a<nt.count; a+=7) for(int b=0; same && b<nt.count; b+=3){
+        Point pa = { nt.tx[a], nt.ty[a] }, pb = { nt.tx[b], nt.ty[b] };
+        same = graph_dist(&mg, pa, pb)==graph_dist(lv->graph, pa, pb);
+    }
+    nav_release(&nt); graph_release(&mg);
+    return same;
+}
+
+typedef struct { const char* name; double reload_ms, apply_ms, tables_ms; int tiles; long ok; } Case;
+
+static atomic_int notified;
+static void on_change(void* ctx){ (void)ctx; atomic_fetch_add(&notified, 1); }
+
+int main(int argc, char** argv){
+    const char* src_path = argc>1 ? argv[1] : "levels/classic.txt";
+    int reloads = argc>2 ? atoi(argv[2]) : 200;
+    char err[256], path[256];
+    LevelSource base;
+    if(!levelpack_parse_text(src_path, &base, err, sizeof err)){ fprintf(stderr, "%s\n", err); return 1; }
+    snprintf(path, sizeof path, "%s/pacman_reload_bench.%d.txt", access("/dev/shm", W_OK)==0 ? "/dev/shm" : "/tmp", (int)getpid());
+
+    // The two edits: pellets (power pellets turned into plain ones and a scatter of
+    // plain ones into power pellets), and the first wall tile between two pellets opened.
+    LevelSource pellets = base, wall = base;
+    int wx = -1, wy = -1;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        char* c = &pellets.tiles[y][x];
+        if(*c=='o') *c = '.';
+        else if(*c=='.' && (x+y)%9==0) *c = 'o';
+        if(wx<0 && x>0 && x<MAP_W-1 && y>0 && y<MAP_H-1 && base.tiles[y][x]=='#' &&
+           ((base.tiles[y][x-1]=='.' && base.tiles[y][x+1]=='.') || (base.tiles[y-1][x]=='.' && base.tiles[y+1][x]=='.'))){ wx = x; wy = y; }
+    }
+    if(wx<0){ fprintf(stderr, "no wall to open in %s\n", src_path); return 1; }
+    wall.tiles[wy][wx] = '.';
+
+    if(!write_level(path, &base)){ fprintf(stderr, "cannot write %s\n", path); return 1; }
+    LiveLevel* ll = live_open(path, err, sizeof err);
+    if(!ll){ fprintf(stderr, "%s\n", err); unlink(path); return 1; }
+
+    // A game some way in, so eaten tiles must survive the reloads.
+    Game gm; game_new_level(&gm, live_level(ll), 1);
+    uint64_t prng = 1001;
+    for(int t=0;t<300 && !gm.over;t++){
+        if(t%6==0){ int d = (int)(sim_rand(&prng)%4); game_set_dir(&gm, NAV_DIRS[d][0], NAV_DIRS[d][1]); }
+        game_step(&gm);
+    }
+
+    Case cases[2] = { {"pellet edit", 0,0,0,0,0}, {"wall edit", 0,0,0,0,0} };
+    const LevelSource* edits[2] = { &pellets, &wall };
+    long total = 0;
+    for(int c=0;c<2;c++){
+        Case* k = &cases[c];
+        for(int i=0;i<reloads;i++){
+            // Edit, then undo the edit: two reloads per round.
+            for(int undo=0; undo<2; undo++){
+                if(!write_level(path, undo ? &base : edits[c])){ fprintf(stderr, "cannot write %s\n", path); return 1; }
+                Game before = gm; const Level* old = gm.level;
+                const LevelDiff* d; LiveTimes lt;
+                double t0 = now_ms();
+                int r = live_reload(ll, &d, &lt, err, sizeof err);
+                double t1 = now_ms();
+                if(r!=1){ fprintf(stderr, "reload: %s\n", r<0 ? err : "no change seen"); return 1; }
+                live_apply(&gm, live_level(ll), d);
+                double t2 = now_ms();
+                k->reload_ms += t1-t0; k->apply_ms += t2-t1; k->tables_ms += lt.tables_ms; k->tiles = d->n;
+                k->ok += matches_scratch(&gm, &before, old, gm.level);
+                total++;
+                game_step(&gm);
+            }
+        }
+    }
+
+    // What reloading did before: parse, both tables, a fresh board.
+    double full_ms = 0;
+    for(int i=0;i<reloads;i++){
+        double t0 = now_ms();
+        LevelSource s; NavTable nt; MazeGraph mg;
+        bool parsed = levelpack_parse_text(path, &s, err, sizeof err);
+        for(int y=0;y<MAP_H;y++) s.rows[y] = s.tiles[y];
+        if(!parsed || !nav_build(&nt, s.rows) || !graph_build(&mg, s.rows, true)){ fprintf(stderr, "full load failed\n"); return 1; }
+        Level lv = { s.rows, s.pac_spawn, {s.ghost_spawn[0], s.ghost_spawn[1], s.ghost_spawn[2], s.ghost_spawn[3]}, s.phases, s.phase_count, &nt, &mg, 0 };
+        Game fresh; game_new_level(&fresh, &lv, 1);
+        full_ms += now_ms()-t0;
+        nav_release(&nt); graph_release(&mg);
+    }
+
+    printf("full load (parse, tables, board)     %8.3f ms\n", full_ms/reloads);
+    long ok = 0;
+    for(int c=0;c<2;c++){
+        Case* k = &cases[c]; int n = 2*reloads;
+        printf("%-12s %3d tiles  reload %8.3f ms (tables %7.3f)  apply %6.2f us  %5.1fx faster\n",
+               k->name, k->tiles, k->reload_ms/n, k->tables_ms/n, k->apply_ms*1e3/n,
+               full_ms/reloads / ((k->reload_ms + k->apply_ms)/n));
+        ok += k->ok;
+    }
+    printf("reloads matching a from-scratch load: %ld of %ld\n", ok, total);
+
+    // Save to callback through the watcher.
+    LevelWatch* w = levelwatch_start(path, on_change, NULL);
+    double lat = 0; int seen = 0;
+    if(w){
+        nanosleep(&(struct timespec){ 0, 100000000 }, NULL);
+        for(int i=0;i<5;i++){
+            int before = atomic_load(&notified);
+            double t0 = now_ms();
+            write_level(path, i%2 ? &base : &pellets);
+            while(atomic_load(&notified)==before && now_ms()-t0 < 2000) nanosleep(&(struct timespec){ 0, 100000 }, NULL);
+            if(atomic_load(&notified)!=before){ lat += now_ms()-t0; seen++; }
+        }
+        levelwatch_stop(w);
+    }
+    if(seen) printf("save to watcher callback             %8.1f ms (%d of 5 saves seen)\n", lat/seen, seen);
+    else printf("save to watcher callback: no notifications\n");
+
+    live_close(ll);
+    unlink(path);
+    return ok==total && seen==5 ? 0 : 1;
+}
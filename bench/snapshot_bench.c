@@ -0,0 +1,109 @@
+// snapshot_bench.c — save-states and the delta-compressed history (snapshot.c): checks
+// that restoring any snapshot, directly or rebuilt from the ring, gives a game with
+// the recorded game_hash() and that play continued from it matches the original run,
+// then reports save/restore/delta costs and history bytes per tick.
+// Build: cc -O2 -pthread -I. bench/snapshot_bench.c snapshot.c sim.c nav.c graph.c trace.c telemetry.c -o snapshot_bench
+
+#define _POSIX_C_SOURCE 199309L
+#include "snapshot.h"
+#include "nav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GAMES 200
+#define MAX_TICKS 3000
+#define HISTORY 64
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// A new random heading every 6 ticks, as in the other benchmarks; -1 keeps the heading.
+static int policy(const Game* gm, uint64_t* rng){ return gm->ticks % 6==0 ? (int)(sim_rand(rng)%4) : -1; }
+static void apply(Game* gm, int d){ if(d>=0) game_set_dir(gm, NAV_DIRS[d][0], NAV_DIRS[d][1]); }
+
+int main(void){
+    static uint32_t hash[MAX_TICKS+1];
+    static Snapshot snaps[MAX_TICKS+1];
+    static int8_t act[MAX_TICKS];                  // input applied before tick i+1
+    SnapRing ring;
+    if(!snapring_init(&ring, HISTORY)){ fprintf(stderr, "out of memory\n"); return 1; }
+    long bad=0, checked=0, deltas=0; size_t delta_bytes=0, ring_peak=0;
+    for(int s=1;s<=GAMES && !bad;s++){
+        Game gm; game_new(&gm, (uint64_t)s);
+        uint64_t prng = 1000+(uint64_t)s;
+        snapring_reset(&ring, &gm);
+        snapshot_save(&gm, &snaps[0]); hash[0] = game_hash(&gm);
+        int t = 0;
+        while(!gm.won && !gm.over && t<MAX_TICKS){
+            act[t] = (int8_t)policy(&gm, &prng);
+            apply(&gm, act[t]); game_step(&gm); t++;
+            snapshot_save(&gm, &snaps[t]); hash[t] = game_hash(&gm);
+            snapring_push(&ring, &gm);
+            uint8_t d[SNAP_DELTA_MAX];
+            size_t n = snapshot_delta(&snaps[t-1], &snaps[t], d);
+            Snapshot x = snaps[t-1];
+            if(!n || !snapshot_apply(&x, d, n) || memcmp(&x, &snaps[t], offsetof(Snapshot, flags)+1)!=0){ if(!bad) printf("delta mismatch: seed %d tick %d\n", s, t); bad++; }
+            deltas++; delta_bytes += n;
+            size_t rb = snapring_bytes(&ring); if(rb>ring_peak) ring_peak = rb;
+        }
+        // Restore every tick into a game at its end state (out-of-order rewind).
+        Game back = gm;
+        for(int i=t;i>=0;i--){
+            snapshot_load(&back, &snaps[i]); checked++;
+            if(game_hash(&back)!=hash[i]){ if(!bad) printf("restore mismatch: seed %d tick %d\n", s, i); bad++; }
+        }
+        // Every frame still in the ring; then roll back to the oldest and play the
+        // same inputs forward again.
+        int kept = snapring_count(&ring);
+        for(int b=0;b<kept;b++){
+            Snapshot x; int i = t-b; checked++;
+            if(!snapring_get(&ring, b, &x)){ bad++; continue; }
+            snapshot_load(&back, &x);
+            if(game_hash(&back)!=hash[i]){ if(!bad) printf("ring mismatch: seed %d tick %d\n", s, i); bad++; }
+        }
+        Snapshot oldest; int from = t-(kept-1);
+        snapring_get(&ring, kept-1, &oldest);
+        snapring_drop(&ring, kept-1);
+        snapshot_load(&back, &oldest);
+        for(int i=from;i<t;i++){ apply(&back, act[i]); game_step(&back); snapring_push(&ring, &back); }
+        if(game_hash(&back)!=hash[t] || snapring_count(&ring)!=kept){ if(!bad) printf("rollback mismatch: seed %d\n", s); bad++; }
+    }
+    printf("equivalence         %d games, %ld restores checked, %ld mismatches\n", GAMES, checked, bad);
+    if(bad) return 1;
+    printf("snapshot            %zu bytes; deltas avg %.1f bytes/tick; ring of %d ticks peaked at %zu bytes (%zu raw)\n",
+           sizeof(Snapshot), (double)delta_bytes/deltas, HISTORY, ring_peak, (size_t)HISTORY*sizeof(Snapshot));
+
+    // Costs, on the states of the last game.
+    Game gm; game_new(&gm, 1);
+    uint64_t prng = 1001; int t = 0;
+    while(!gm.won && !gm.over && t<MAX_TICKS){ apply(&gm, policy(&gm, &prng)); game_step(&gm); snapshot_save(&gm, &snaps[t++]); }
+    const int reps = 2000;
+    volatile uint32_t sink = 0;
+    double t0 = now_sec();
+    for(int r=0;r<reps;r++) for(int i=0;i<t;i++){ snapshot_save(&gm, &snaps[i]); sink += snaps[i].ticks; }
+    double save_ns = (now_sec()-t0)*1e9/((double)reps*t);
+    t0 = now_sec();
+    for(int r=0;r<reps;r++) for(int i=0;i<t;i++){ snapshot_load(&gm, &snaps[i]); sink += gm.ticks; }
+    double load_ns = (now_sec()-t0)*1e9/((double)reps*t);
+    uint8_t d[SNAP_DELTA_MAX];
+    t0 = now_sec();
+    for(int r=0;r<reps;r++) for(int i=1;i<t;i++) sink += (uint32_t)snapshot_delta(&snaps[i-1], &snaps[i], d);
+    double enc_ns = (now_sec()-t0)*1e9/((double)reps*(t-1));
+    t0 = now_sec();
+    for(int r=0;r<reps/10;r++){
+        snapring_reset(&ring, &gm);
+        for(int i=0;i<t;i++){ snapshot_load(&gm, &snaps[i]); snapring_push(&ring, &gm); }
+        Snapshot x; for(int b=0;b<snapring_count(&ring);b++) sink += snapring_get(&ring, b, &x);
+    }
+    double ring_us = (now_sec()-t0)*1e6/(reps/10);
+    printf("save                %7.1f ns\n", save_ns);
+    printf("restore             %7.1f ns (end state rewound to every tick)\n", load_ns);
+    printf("delta encode        %7.1f ns\n", enc_ns);
+    printf("ring push + get all %7.1f us for %d ticks\n", ring_us, t);
+    snapring_free(&ring);
+    return sink==0xFFFFFFFFu;
+}
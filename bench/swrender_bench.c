@@ -0,0 +1,114 @@
+// swrender_bench.c — software renderer and capture pipeline (swrender.c, capture.c):
+// TILE-sized fills and overlay blends against plain per-pixel loops, whole frames of
+// the games_x1000 opening games with a checksum over every pixel drawn (so a change
+// to the renderer or the rules shows up), then frames/s through the encoder thread
+// into a scratch Y4M file (deleted afterwards).
+// Build: cc -O2 -pthread -I. bench/swrender_bench.c swrender.c capture.c sim.c nav.c graph.c trace.c telemetry.c -o swrender_bench
+
+#define _POSIX_C_SOURCE 199309L
+#include "swrender.h"
+#include "capture.h"
+#include "nav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GAMES 20
+#define GOLDEN 0x52A2D834u
+#define REPS 200000
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// Plain loops for comparison; noinline so the compiler cannot fold them into the caller.
+__attribute__((noinline)) static void fill_plain(Framebuffer* fb, int x, int y, int w, int h, uint32_t rgb){
+    for(int r=0;r<h;r++) for(int c=0;c<w;c++) fb->px[(size_t)(y+r)*fb->stride + x+c] = rgb;
+}
+
+__attribute__((noinline)) static void blend_plain(Framebuffer* fb, int x, int y, int w, int h, uint32_t rgb, int alpha){
+    int a = alpha + (alpha >> 7);
+    for(int r=0;r<h;r++) for(int c=0;c<w;c++){
+        uint32_t* p = &fb->px[(size_t)(y+r)*fb->stride + x+c];
+        uint32_t d = *p, out = 0;
+        for(int s=0;s<24;s+=8) out |= (((d>>s & 255)*(uint32_t)(256-a) + (rgb>>s & 255)*(uint32_t)a) >> 8) << s;
+        *p = out;
+    }
+}
+
+static uint32_t fnv(uint32_t h, const uint32_t* px, size_t n){
+    for(size_t i=0;i<n;i++) h = (h ^ px[i]) * 16777619u;
+    return h;
+}
+
+int main(void){
+    Framebuffer fb, ref;
+    SwRenderer sr;
+    if(!fb_init(&fb, SW_W, SW_H) || !fb_init(&ref, SW_W, SW_H) || !swr_init(&sr)){ fprintf(stderr, "out of memory\n"); return 1; }
+
+    // Fills and blends must match the plain loops exactly.
+    bool same = true;
+    for(int i=0;i<64;i++){
+        int x = (i*37)%(SW_W-40), y = (i*53)%(SW_H-40);      // blend rect stays inside too
+        fb_fill(&fb, x, y, SW_TILE, SW_TILE, (uint32_t)i*0x010203u); fill_plain(&ref, x, y, SW_TILE, SW_TILE, (uint32_t)i*0x010203u);
+        fb_blend(&fb, x+3, y+3, 33, 17, 0x405060, i*4); blend_plain(&ref, x+3, y+3, 33, 17, 0x405060, i*4);
+    }
+    same = memcmp(fb.px, ref.px, (size_t)SW_W*SW_H*4)==0;
+    printf("fill/blend vs plain loops: %s\n", same? "identical" : "DIFFER");
+
+    double t0 = now_sec();
+    for(int i=0;i<REPS;i++) fb_fill(&fb, (i%27)*SW_TILE, (i%30)*SW_TILE, SW_TILE, SW_TILE, (uint32_t)i);
+    double t_fill = now_sec()-t0; t0 = now_sec();
+    for(int i=0;i<REPS;i++) fill_plain(&fb, (i%27)*SW_TILE, (i%30)*SW_TILE, SW_TILE, SW_TILE, (uint32_t)i);
+    double t_plain = now_sec()-t0; t0 = now_sec();
+    for(int i=0;i<REPS/20;i++) fb_blend(&fb, 120, 230, 320, 160, 0, 180);
+    double t_blend = now_sec()-t0; t0 = now_sec();
+    for(int i=0;i<REPS/20;i++) blend_plain(&fb, 120, 230, 320, 160, 0, 180);
+    double t_bplain = now_sec()-t0;
+    printf("fb_fill %dx%d     %8.1f ns  (plain loop %8.1f ns)\n", SW_TILE, SW_TILE, t_fill*1e9/REPS, t_plain*1e9/REPS);
+    printf("fb_blend 320x160  %8.1f ns  (plain loop %8.1f ns)\n", t_blend*1e9/(REPS/20), t_bplain*1e9/(REPS/20));
+
+    // Whole games, a frame per tick, same seeds and heading policy as bench_suite.
+    Game gm; uint32_t sum = 2166136261u; long frames = 0; double t_draw = 0;
+    for(uint64_t seed=1; seed<=GAMES; seed++){
+        game_new(&gm, seed); uint64_t prng = 1000+seed;
+        Point prev[5];
+        while(!gm.won && !gm.over && gm.ticks<20000){
+            if(gm.ticks%6==0){ int d=(int)(sim_rand(&prng)%4); game_set_dir(&gm, NAV_DIRS[d][0], NAV_DIRS[d][1]); }
+            swr_positions(&gm, prev);
+            game_step(&gm);
+            t0 = now_sec();
+            swr_draw(&sr, &fb, &gm, prev, 0.5f);
+            t_draw += now_sec()-t0;
+            sum = fnv(sum, fb.px, (size_t)SW_W*SW_H);
+            frames++;
+        }
+    }
+    bool ok = sum==GOLDEN;
+    printf("swr_draw games x%d  %8.1f us/frame  %ld frames  checksum %08X  %s\n",
+           GAMES, t_draw*1e6/frames, frames, (unsigned)sum, ok? "ok" : "FAIL");
+    if(!ok) printf("expected checksum %08X: the picture or the game changed\n", GOLDEN);
+
+    // Through the encoder thread.
+    char err[256];
+    const char* scratch = "swrender_bench.y4m";
+    Capture* cap = capture_open(scratch, SW_W, SW_H, 100, 11, CAPTURE_SLOTS, err, sizeof err);
+    if(!cap){ fprintf(stderr, "%s\n", err); return 1; }
+    game_new(&gm, 1);
+    t0 = now_sec();
+    for(int i=0;i<500;i++){
+        Framebuffer slot = { capture_begin(cap), SW_W, SW_H, SW_W };
+        swr_draw(&sr, &slot, &gm, NULL, 1.0f);
+        capture_commit(cap);
+    }
+    CaptureStats st = capture_close(cap);
+    double dt = now_sec()-t0;
+    remove(scratch);
+    printf("draw+encode y4m  %8.1f frames/s  encode %.1f us/frame  producer waits %ld\n",
+           st.frames/dt, st.frames? st.encode_s*1e6/st.frames : 0.0, st.waits);
+
+    swr_free(&sr); fb_free(&fb); fb_free(&ref);
+    return ok && same && st.ok ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+// capture.c — frame ring, encoder thread, Y4M and PNG writers (see capture.h).
+#define _POSIX_C_SOURCE 200809L
+#include "capture.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct Capture {
+    int w, h, slots;
+    uint32_t* ring;                 // slots * w*h pixels
+    long head, tail;                // frames committed / encoded; slot is n % slots
+    bool quit;
+    pthread_mutex_t mu;
+    pthread_cond_t ready, freed;    // a frame was committed / a slot was encoded
+    pthread_t thread;
+    // Encoder side
+    bool y4m;
+    FILE* out;                      // the Y4M stream
+    char* pattern;                  // PNG file name pattern
+    uint8_t* buf;                   // one converted frame (YUV, or the PNG zlib stream)
+    uint8_t* raw;                   // PNG scanlines
+    CaptureStats st;
+};
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// ===== Y4M =====
+// BT.601 limited range; chroma is the average of each 2x2 block (C420jpeg siting).
+static void to_yuv420(const uint32_t* px, int w, int h, uint8_t* out){
+    uint8_t *Y = out, *U = out + (size_t)w*h, *V = U + (size_t)(w/2)*(h/2);
+    for(int y=0;y<h;y+=2){
+        for(int x=0;x<w;x+=2){
+            int rs=0, gs=0, bs=0;
+            for(int k=0;k<4;k++){
+                int xx = x + (k&1), yy = y + (k>>1);
+                uint32_t p = px[(size_t)yy*w + xx];
+                int r = p>>16 & 255, g = p>>8 & 255, b = p & 255;
+                Y[(size_t)yy*w + xx] = (uint8_t)(((66*r + 129*g + 25*b + 128) >> 8) + 16);
+                rs += r; gs += g; bs += b;
+            }
+            rs = (rs+2)>>2; gs = (gs+2)>>2; bs = (bs+2)>>2;
+            size_t c = (size_t)(y/2)*(w/2) + x/2;
+            U[c] = (uint8_t)(((-38*rs - 74*gs + 112*bs + 128) >> 8) + 128);
+            V[c] = (uint8_t)(((112*rs - 94*gs - 18*bs + 128) >> 8) + 128);
+        }
+    }
+}
+
+static bool write_y4m(Capture* c, const uint32_t* px){
+    size_t n = (size_t)c->w*c->h*3/2;
+    to_yuv420(px, c->w, c->h, c->buf);
+    return fputs("FRAME\n", c->out) >= 0 && fwrite(c->buf, 1, n, c->out) == n;
+}
+
+// ===== PNG =====
+static uint32_t crc_table[256];
+
+static void crc_init(void){
+    for(uint32_t n=0;n<256;n++){
+        uint32_t v = n;
+        for(int k=0;k<8;k++) v = v&1 ? 0xEDB88320u ^ (v>>1) : v>>1;
+        crc_table[n] = v;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t* p, size_t n){
+    for(size_t i=0;i<n;i++) crc = crc_table[(crc ^ p[i]) & 255] ^ (crc >> 8);
+    return crc;
+}
+
+static void put32(uint8_t* p, uint32_t v){ p[0]=(uint8_t)(v>>24); p[1]=(uint8_t)(v>>16); p[2]=(uint8_t)(v>>8); p[3]=(uint8_t)v; }
+
+static bool chunk(FILE* f, const char* type, const uint8_t* data, uint32_t len){
+    uint8_t hdr[8]; put32(hdr, len); memcpy(hdr+4, type, 4);
+    uint32_t crc = crc_update(0xFFFFFFFFu, hdr+4, 4);
+    crc = crc_update(crc, data, len) ^ 0xFFFFFFFFu;
+    uint8_t tail[4]; put32(tail, crc);
+    return fwrite(hdr, 1, 8, f)==8 && (!len || fwrite(data, 1, len, f)==len) && fwrite(tail, 1, 4, f)==4;
+}
+
+// Size of the zlib stream for `raw` bytes in stored blocks of at most 65535.
+static size_t zlib_stored_size(size_t raw){ return 2 + raw + 5*((raw + 65534)/65535) + 4; }
+
+static uint32_t adler32(const uint8_t* p, size_t n){
+    uint32_t a = 1, b = 0;
+    while(n){
+        size_t k = n < 5552 ? n : 5552;             // largest run before b can overflow
+        n -= k;
+        while(k--){ a += *p++; b += a; }
+        a %= 65521; b %= 65521;
+    }
+    return b<<16 | a;
+}
+
+static bool write_png(Capture* c, const uint32_t* px, long index){
+    int w = c->w, h = c->h;
+    size_t row = 1 + (size_t)w*3, raw = row*h;
+    uint8_t* r = c->raw;
+    for(int y=0;y<h;y++){
+        *r++ = 0;                                   // filter: none
+        for(int x=0;x<w;x++){ uint32_t p = px[(size_t)y*w + x]; *r++ = (uint8_t)(p>>16); *r++ = (uint8_t)(p>>8); *r++ = (uint8_t)p; }
+    }
+    uint8_t* z = c->buf;                            // zlib stream of stored blocks
+    uint8_t* o = z;
+    *o++ = 0x78; *o++ = 0x01;
+    for(size_t off=0; off<raw; ){
+        size_t n = raw-off < 65535 ? raw-off : 65535;
+        o[0] = off+n==raw; o[1] = (uint8_t)n; o[2] = (uint8_t)(n>>8); o[3] = (uint8_t)~n; o[4] = (uint8_t)(~n>>8);
+        memcpy(o+5, c->raw+off, n);
+        o += 5+n; off += n;
+    }
+    put32(o, adler32(c->raw, raw)); o += 4;
+
+    char name[1024];
+    snprintf(name, sizeof name, c->pattern, (int)index);
+    FILE* f = fopen(name, "wb");
+    if(!f) return false;
+    uint8_t ihdr[13]; put32(ihdr, (uint32_t)w); put32(ihdr+4, (uint32_t)h);
+    ihdr[8]=8; ihdr[9]=2; ihdr[10]=ihdr[11]=ihdr[12]=0; // 8-bit RGB, no interlace
+    bool ok = fwrite("\x89PNG\r\n\x1a\n", 1, 8, f)==8 && chunk(f, "IHDR", ihdr, 13) &&
+              chunk(f, "IDAT", z, (uint32_t)(o - z)) && chunk(f, "IEND", NULL, 0);
+    return fclose(f)==0 && ok;
+}
+
+// ===== Encoder thread =====
+static void* encoder(void* arg){
+    Capture* c = arg;
+    size_t frame = (size_t)c->w*c->h;
+    pthread_mutex_lock(&c->mu);
+    for(;;){
+        while(c->tail == c->head && !c->quit) pthread_cond_wait(&c->ready, &c->mu);
+        if(c->tail == c->head) break;               // quit with nothing queued
+        long n = c->tail;
+        pthread_mutex_unlock(&c->mu);
+        double t0 = now_sec();
+        const uint32_t* px = c->ring + (size_t)(n % c->slots)*frame;
+        bool ok = c->y4m ? write_y4m(c, px) : write_png(c, px, n);
+        c->st.encode_s += now_sec() - t0;
+        if(ok) c->st.frames++; else c->st.ok = false;
+        pthread_mutex_lock(&c->mu);
+        c->tail++;
+        pthread_cond_signal(&c->freed);
+    }
+    pthread_mutex_unlock(&c->mu);
+    return NULL;
+}
+
+// The pattern reaches snprintf as its format: exactly one %d, %i or %u (flags and a
+// width allowed) and any number of %%, nothing else.
+static bool frame_pattern(const char* p){
+    int convs = 0;
+    for(; *p; p++){
+        if(*p!='%') continue;
+        if(p[1]=='%'){ p++; continue; }
+        p++;
+        while(*p && strchr("-+ #0", *p)) p++;
+        while(*p>='0' && *p<='9') p++;
+        if(*p!='d' && *p!='i' && *p!='u') return false;
+        convs++;
+    }
+    return convs==1;
+}
+
+Capture* capture_open(const char* path, int w, int h, int fps_num, int fps_den, int slots, char* err, size_t errlen){
+    if(w<=0 || h<=0 || (w|h)&1){ snprintf(err, errlen, "capture: frame size %dx%d must be even", w, h); return NULL; }
+    size_t len = strlen(path);
+    bool y4m = len>=4 && strcmp(path+len-4, ".y4m")==0;
+    if(!y4m && !frame_pattern(path)){ snprintf(err, errlen, "capture: %s is neither *.y4m nor a PNG pattern with one %%d like f%%05d.png", path); return NULL; }
+    Capture* c = calloc(1, sizeof *c);
+    if(!c){ snprintf(err, errlen, "capture: out of memory"); return NULL; }
+    c->w = w; c->h = h; c->slots = slots>0 ? slots : CAPTURE_SLOTS; c->y4m = y4m; c->st.ok = true;
+    size_t frame = (size_t)w*h;
+    c->ring = malloc(frame*c->slots*sizeof *c->ring);
+    c->buf = malloc(y4m ? frame*3/2 : zlib_stored_size((1 + (size_t)w*3)*h));
+    if(!c->ring || !c->buf){ snprintf(err, errlen, "capture: out of memory"); goto fail; }
+    if(y4m){
+        if(!(c->out = fopen(path, "wb"))){ snprintf(err, errlen, "capture: cannot write %s", path); goto fail; }
+        fprintf(c->out, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg\n", w, h, fps_num, fps_den);
+    }else{
+        c->pattern = malloc(len+1);
+        c->raw = malloc((1 + (size_t)w*3)*h);
+        if(!c->pattern || !c->raw){ snprintf(err, errlen, "capture: out of memory"); goto fail; }
+        memcpy(c->pattern, path, len+1);
+        crc_init();
+    }
+    pthread_mutex_init(&c->mu, NULL);
+    pthread_cond_init(&c->ready, NULL); pthread_cond_init(&c->freed, NULL);
+    if(pthread_create(&c->thread, NULL, encoder, c)!=0){
+        snprintf(err, errlen, "capture: cannot start the encoder thread");
+        pthread_cond_destroy(&c->ready); pthread_cond_destroy(&c->freed); pthread_mutex_destroy(&c->mu);
+        goto fail;
+    }
+    return c;
+fail:
+    if(c->out) fclose(c->out);
+    free(c->pattern); free(c->raw); free(c->buf); free(c->ring); free(c);
+    return NULL;
+}
+
+uint32_t* capture_begin(Capture* c){
+    pthread_mutex_lock(&c->mu);
+    if(c->head - c->tail == c->slots){
+        c->st.waits++;
+        while(c->head - c->tail == c->slots) pthread_cond_wait(&c->freed, &c->mu);
+    }
+    long n = c->head;
+    pthread_mutex_unlock(&c->mu);
+    return c->ring + (size_t)(n % c->slots)*c->w*c->h;
+}
+
+void capture_commit(Capture* c){
+    pthread_mutex_lock(&c->mu);
+    c->head++;
+    pthread_cond_signal(&c->ready);
+    pthread_mutex_unlock(&c->mu);
+}
+
+CaptureStats capture_close(Capture* c){
+    pthread_mutex_lock(&c->mu);
+    c->quit = true;
+    pthread_cond_signal(&c->ready);
+    pthread_mutex_unlock(&c->mu);
+    pthread_join(c->thread, NULL);
+    CaptureStats st = c->st;
+    if(c->out && fclose(c->out)!=0) st.ok = false;
+    pthread_cond_destroy(&c->ready); pthread_cond_destroy(&c->freed); pthread_mutex_destroy(&c->mu);
+    free(c->pattern); free(c->raw); free(c->buf); free(c->ring); free(c);
+    return st;
+}
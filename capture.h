@@ -0,0 +1,39 @@
+// capture.h — frames to video files on a background thread. The producer draws each
+// frame straight into a slot of a ring (no copy), commits it and carries on; an
+// encoder thread converts and writes slots in order. The producer only waits when
+// the whole ring is still queued, so nothing is dropped and a fast producer runs at
+// encoder speed.
+//
+// Output by file name: "*.y4m" is one YUV4MPEG2 stream (4:2:0, BT.601 limited range;
+// ffmpeg -i game.y4m game.mp4), anything else is a printf pattern with exactly one
+// %d/%i/%u conversion (flags and width allowed, %% for a literal) naming a PNG per frame ("frames/f%05d.png"; RGB, stored deflate blocks,
+// so large but lossless and cheap to write).
+#ifndef PACMAN_CAPTURE_H
+#define PACMAN_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CAPTURE_SLOTS 8             // default ring size
+
+typedef struct Capture Capture;
+
+typedef struct {
+    long frames;                    // written
+    long waits;                     // times the producer found the ring full
+    double encode_s;                // encoder busy time (conversion and writing)
+    bool ok;                        // every write succeeded
+} CaptureStats;
+
+// w and h even (4:2:0); frame rate fps_num/fps_den is stored in Y4M headers.
+// NULL on failure with the reason in err.
+Capture* capture_open(const char* path, int w, int h, int fps_num, int fps_den, int slots, char* err, size_t errlen);
+// Slot for the next frame: w*h pixels 0x00RRGGBB, row stride w. Waits while the
+// ring is full. Valid until capture_commit().
+uint32_t* capture_begin(Capture* c);
+void capture_commit(Capture* c);
+// Encode what is queued, stop the thread and close the output.
+CaptureStats capture_close(Capture* c);
+
+#endif
@@ -0,0 +1,77 @@
+// channel.c — triple buffer and SPSC ring (see channel.h).
+#include "channel.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TBUF_FRESH 4u
+
+bool tbuf_init(TripleBuf* tb, size_t size){
+    memset(tb, 0, sizeof *tb);
+    unsigned char* mem = calloc(3, size ? size : 1);
+    if(!mem) return false;
+    for(int i=0;i<3;i++) tb->slot[i] = mem + (size_t)i*size;
+    tb->size = size;
+    tb->front = 0; atomic_init(&tb->middle, 1); tb->back = 2;
+    return true;
+}
+
+void tbuf_free(TripleBuf* tb){
+    free(tb->slot[0]);                  // one block; the slots never move, only the indices
+    memset(tb, 0, sizeof *tb);
+}
+
+void* tbuf_back(TripleBuf* tb){ return tb->slot[tb->back]; }
+
+void tbuf_publish(TripleBuf* tb){
+    // Release: the slot's contents are visible to whoever acquires it from middle.
+    uint32_t old = atomic_exchange_explicit(&tb->middle, tb->back | TBUF_FRESH, memory_order_acq_rel);
+    tb->back = old & 3u;
+    atomic_fetch_add_explicit(&tb->published, 1, memory_order_relaxed);
+    if(old & TBUF_FRESH) atomic_fetch_add_explicit(&tb->overwritten, 1, memory_order_relaxed);
+}
+
+const void* tbuf_read(TripleBuf* tb, bool* fresh){
+    bool got = atomic_load_explicit(&tb->middle, memory_order_relaxed) & TBUF_FRESH;
+    if(got){
+        uint32_t old = atomic_exchange_explicit(&tb->middle, tb->front, memory_order_acq_rel);
+        tb->front = old & 3u;
+    }
+    if(fresh) *fresh = got;
+    return tb->slot[tb->front];
+}
+
+bool tbuf_pending(TripleBuf* tb){ return atomic_load_explicit(&tb->middle, memory_order_acquire) & TBUF_FRESH; }
+
+bool spsc_init(SpscQueue* q, uint32_t capacity, size_t item_size){
+    memset(q, 0, sizeof *q);
+    if(!capacity || (capacity & (capacity-1))) return false;
+    q->buf = malloc((size_t)capacity * item_size);
+    if(!q->buf) return false;
+    q->mask = capacity-1; q->item = item_size;
+    atomic_init(&q->head, 0); atomic_init(&q->tail, 0);
+    return true;
+}
+
+void spsc_free(SpscQueue* q){ free(q->buf); memset(q, 0, sizeof *q); }
+
+bool spsc_push(SpscQueue* q, const void* item){
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if(head - tail > q->mask) return false;
+    memcpy(q->buf + (size_t)(head & q->mask)*q->item, item, q->item);
+    atomic_store_explicit(&q->head, head+1, memory_order_release);
+    return true;
+}
+
+bool spsc_pop(SpscQueue* q, void* item){
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if(head == tail) return false;
+    memcpy(item, q->buf + (size_t)(tail & q->mask)*q->item, q->item);
+    atomic_store_explicit(&q->tail, tail+1, memory_order_release);
+    return true;
+}
+
+bool spsc_empty(SpscQueue* q){
+    return atomic_load_explicit(&q->head, memory_order_acquire) == atomic_load_explicit(&q->tail, memory_order_relaxed);
+}
@@ -0,0 +1,53 @@
+// channel.h — lock-free hand-off between exactly two threads. TripleBuf passes the
+// latest value of some state (the writer never waits and the reader always gets the
+// newest complete copy, older unread ones are overwritten); SpscQueue passes every
+// message in order through a bounded ring. No SDL dependency, C11 atomics only.
+#ifndef PACMAN_CHANNEL_H
+#define PACMAN_CHANNEL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Three slots: the writer fills its back slot and swaps it with the shared middle one;
+// the reader swaps its front slot with the middle one when a fresh value is waiting.
+typedef struct {
+    _Atomic uint32_t middle;    // slot index, | TBUF_FRESH when published and not yet read
+    _Atomic uint32_t published, overwritten;   // overwritten: published but never read
+    uint32_t back;              // writer's slot
+    uint32_t front;             // reader's slot
+    size_t size;
+    unsigned char* slot[3];
+} TripleBuf;
+
+// Slots of `size` bytes, all zeroed; false if out of memory.
+bool tbuf_init(TripleBuf* tb, size_t size);
+void tbuf_free(TripleBuf* tb);
+// Writer: fill tbuf_back(), then tbuf_publish() makes it the newest value.
+void* tbuf_back(TripleBuf* tb);
+void tbuf_publish(TripleBuf* tb);
+// Reader: the newest published value (zeroed before the first publish), valid until
+// the next call; *fresh tells whether it was published since the last call.
+const void* tbuf_read(TripleBuf* tb, bool* fresh);
+// Reader: whether tbuf_read() would find something fresh, without taking it.
+bool tbuf_pending(TripleBuf* tb);
+
+// Bounded ring of fixed-size items, capacity a power of two.
+typedef struct {
+    _Atomic uint32_t head;      // next slot to write, advanced by the producer
+    char pad0[60];
+    _Atomic uint32_t tail;      // next slot to read, advanced by the consumer
+    char pad1[60];
+    uint32_t mask;
+    size_t item;
+    unsigned char* buf;
+} SpscQueue;
+
+bool spsc_init(SpscQueue* q, uint32_t capacity, size_t item_size);
+void spsc_free(SpscQueue* q);
+bool spsc_push(SpscQueue* q, const void* item);   // producer; false when full
+bool spsc_pop(SpscQueue* q, void* item);          // consumer; false when empty
+bool spsc_empty(SpscQueue* q);                    // consumer
+
+#endif
@@ -0,0 +1,157 @@
+// graph.c — junction/corridor graph built once per layout and passability.
+
+#include "graph.h"
+#include "nav.h"
+#include <stdlib.h>
+#include <string.h>
+
+static MazeGraph* graph_cache;
+
+static bool walkable(const char* const* layout, bool ghost, int x, int y){
+    if(!in_bounds(x,y)) return false;
+    char c = layout[y][x];
+    return c!='#' && (ghost || c!='H');
+}
+
+int graph_dir_index(int dx, int dy){
+    for(int i=0;i<4;i++) if(NAV_DIRS[i][0]==dx && NAV_DIRS[i][1]==dy) return i;
+    return -1;
+}
+
+static void step_dir(int* x, int* y, int dir){
+    *x += NAV_DIRS[dir][0]; *y += NAV_DIRS[dir][1];
+    if(*x<0) *x=MAP_W-1; else if(*x>=MAP_W) *x=0;
+}
+
+// -1 once the node arrays are full.
+static int add_node(MazeGraph* mg, int x, int y){
+    if(mg->nodes >= GRAPH_MAX_NODES) return -1;
+    int id = mg->nodes++;
+    mg->node_of[y][x]=(uint16_t)id; mg->nx[id]=(uint8_t)x; mg->ny[id]=(uint8_t)y;
+    for(int i=0;i<4;i++) mg->node_edge[id][i]=GRAPH_NONE;
+    return id;
+}
+
+// Walk every untraced exit of node a until the next node, labelling corridor tiles.
+// false once the edge array is full.
+static bool trace_edges(MazeGraph* mg, int a){
+    for(int d=0;d<4;d++){
+        if(!(mg->exits[mg->ny[a]][mg->nx[a]] & (1<<d)) || mg->node_edge[a][d]!=GRAPH_NONE) continue;
+        if(mg->edges >= GRAPH_MAX_EDGES) return false;
+        int e = mg->edges++;
+        int x=mg->nx[a], y=mg->ny[a], dir=d, len=0;
+        mg->node_edge[a][d]=(uint16_t)e;
+        for(;;){
+            step_dir(&x,&y,dir); len++;
+            if(graph_is_node(mg,x,y)) break;
+            mg->edge_of[y][x]=(uint16_t)e; mg->off[y][x]=(uint16_t)len;
+            int rest = mg->exits[y][x] & ~(1<<(dir^1));
+            int nd=-1; for(int i=0;i<4;i++) if(rest & (1<<i)){ nd=i; break; }
+            dir=nd;
+        }
+        int b = mg->node_of[y][x];
+        mg->node_edge[b][dir^1]=(uint16_t)e;
+        mg->edge[e]=(GraphEdge){ (uint16_t)a, (uint16_t)b, (uint8_t)d, (uint8_t)(dir^1), (uint16_t)len };
+    }
+    return true;
+}
+
+bool graph_build(MazeGraph* mg, const char* const* layout, bool ghost){
+    memset(mg, 0, sizeof *mg);
+    mg->layout=layout; mg->ghost=ghost;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        mg->node_of[y][x]=GRAPH_NONE; mg->edge_of[y][x]=GRAPH_NONE;
+        if(!walkable(layout,ghost,x,y)) continue;
+        for(int i=0;i<4;i++){
+            int nx=x, ny=y; step_dir(&nx,&ny,i);
+            if(walkable(layout,ghost,nx,ny)) mg->exits[y][x] |= (uint8_t)(1<<i);
+        }
+    }
+    // Nodes: every walkable tile that is not a plain two-exit corridor cell.
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        if(!walkable(layout,ghost,x,y)) continue;
+        int deg=0; for(int i=0;i<4;i++) deg += (mg->exits[y][x]>>i)&1;
+        if(deg!=2 && add_node(mg,x,y)<0){ mg->too_open = true; return false; }
+    }
+    for(int n=0;n<mg->nodes;n++) if(!trace_edges(mg,n)){ mg->too_open = true; return false; }
+    // Closed loops made only of corridor cells have no junction; promote one cell each.
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        if(!walkable(layout,ghost,x,y) || graph_is_node(mg,x,y) || mg->edge_of[y][x]!=GRAPH_NONE) continue;
+        int a = add_node(mg,x,y);
+        if(a<0 || !trace_edges(mg,a)){ mg->too_open = true; return false; }
+    }
+
+    // All-pairs node distances (Floyd–Warshall over a few dozen nodes).
+    int n = mg->nodes;
+    mg->dist = malloc((size_t)n*n*sizeof *mg->dist);
+    if(!mg->dist) return false;
+    for(int i=0;i<n*n;i++) mg->dist[i]=GRAPH_NONE;
+    for(int i=0;i<n;i++) mg->dist[i*n+i]=0;
+    for(int e=0;e<mg->edges;e++){
+        GraphEdge* ge=&mg->edge[e];
+        if(ge->len < mg->dist[ge->a*n+ge->b]){ mg->dist[ge->a*n+ge->b]=ge->len; mg->dist[ge->b*n+ge->a]=ge->len; }
+    }
+    for(int k=0;k<n;k++) for(int i=0;i<n;i++){
+        if(mg->dist[i*n+k]==GRAPH_NONE) continue;
+        for(int j=0;j<n;j++){
+            if(mg->dist[k*n+j]==GRAPH_NONE) continue;
+            unsigned d = (unsigned)mg->dist[i*n+k] + mg->dist[k*n+j];
+            if(d < mg->dist[i*n+j]) mg->dist[i*n+j]=(uint16_t)d;
+        }
+    }
+    return true;
+}
+
+void graph_release(MazeGraph* mg){ free(mg->dist); mg->dist=NULL; mg->nodes=mg->edges=0; }
+
+const MazeGraph* graph_for_layout(const char* const* layout, bool ghost){
+    for(MazeGraph* mg=graph_cache; mg; mg=mg->link) if(mg->layout==layout && mg->ghost==ghost) return mg;
+    MazeGraph* mg = malloc(sizeof *mg);
+    if(!mg) return NULL;
+    if(!graph_build(mg, layout, ghost)){ free(mg); return NULL; }
+    mg->link = graph_cache; graph_cache = mg;
+    return mg;
+}
+
+// A tile reaches the graph through at most two nodes: itself, or both ends of its corridor.
+static int anchors(const MazeGraph* mg, Point p, int node[2], int cost[2]){
+    if(graph_is_node(mg,p.x,p.y)){ node[0]=mg->node_of[p.y][p.x]; cost[0]=0; return 1; }
+    const GraphEdge* e=&mg->edge[mg->edge_of[p.y][p.x]];
+    int o=mg->off[p.y][p.x];
+    node[0]=e->a; cost[0]=o; node[1]=e->b; cost[1]=e->len-o;
+    return 2;
+}
+
+int graph_dist(const MazeGraph* mg, Point a, Point b){
+    if(!walkable(mg->layout,mg->ghost,a.x,a.y) || !walkable(mg->layout,mg->ghost,b.x,b.y)) return -1;
+    int na[2], ca[2], nb[2], cb[2];
+    int ka=anchors(mg,a,na,ca), kb=anchors(mg,b,nb,cb);
+    int best=-1;
+    if(!graph_is_node(mg,a.x,a.y) && mg->edge_of[a.y][a.x]==mg->edge_of[b.y][b.x] && !graph_is_node(mg,b.x,b.y))
+        best=abs((int)mg->off[a.y][a.x]-(int)mg->off[b.y][b.x]);
+    for(int i=0;i<ka;i++) for(int j=0;j<kb;j++){
+        uint16_t d=mg->dist[na[i]*mg->nodes+nb[j]];
+        if(d==GRAPH_NONE) continue;
+        int t=ca[i]+d+cb[j];
+        if(best<0 || t<best) best=t;
+    }
+    return best;
+}
+
+bool graph_ahead(const MazeGraph* mg, Point p, int dir, Point* node, int* steps){
+    if(dir<0 || !in_bounds(p.x,p.y) || !(mg->exits[p.y][p.x] & (1<<dir))) return false;
+    int x=p.x, y=p.y; step_dir(&x,&y,dir);
+    int id, n;
+    if(graph_is_node(mg,x,y)){ id=mg->node_of[y][x]; n=1; }
+    else{
+        const GraphEdge* e=&mg->edge[mg->edge_of[y][x]];
+        int o=mg->off[y][x];
+        // Moving away from edge.a means the next node is edge.b, and vice versa.
+        bool toward_b = graph_is_node(mg,p.x,p.y) ? (mg->node_of[p.y][p.x]==e->a && dir==e->dir_a)
+                                                  : o > mg->off[p.y][p.x];
+        if(toward_b){ id=e->b; n=1+e->len-o; } else { id=e->a; n=1+o; }
+    }
+    if(node){ node->x=mg->nx[id]; node->y=mg->ny[id]; }
+    if(steps) *steps=n;
+    return true;
+}
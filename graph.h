@@ -0,0 +1,65 @@
+// graph.h — compressed maze graph: junctions/dead ends are nodes, corridors between
+// them are edges carrying their length. Ghosts glide along corridors without any
+// targeting work and only decide at nodes; distance and "what's ahead" queries run
+// over a few dozen nodes instead of every tile.
+#ifndef PACMAN_GRAPH_H
+#define PACMAN_GRAPH_H
+
+#include "sim.h"
+#include <stdint.h>
+
+#define GRAPH_NONE 0xFFFF
+#define GRAPH_MAX_NODES (MAP_W*MAP_H/2)
+#define GRAPH_MAX_EDGES (MAP_W*MAP_H)
+
+// Corridor from node a (leaving in dir_a) to node b (arriving so that b leaves back
+// along it in dir_b), len steps long. Directions index NAV_DIRS (R, L, D, U).
+typedef struct { uint16_t a, b; uint8_t dir_a, dir_b; uint16_t len; } GraphEdge;
+
+typedef struct MazeGraph {
+    const char* const* layout;
+    bool ghost;                          // ghost passability (gate open) or Pac-Man's
+    bool too_open;                       // graph_build failed: more nodes or edges than fit below
+    uint8_t  exits[MAP_H][MAP_W];        // bit i set: can step in NAV_DIRS[i] (tunnel wraps)
+    uint16_t node_of[MAP_H][MAP_W];      // node id, GRAPH_NONE on corridor tiles and walls
+    uint16_t edge_of[MAP_H][MAP_W];      // corridor tiles: edge id
+    uint16_t off[MAP_H][MAP_W];          // corridor tiles: steps from edge.a
+    int nodes, edges;
+    uint8_t  nx[GRAPH_MAX_NODES], ny[GRAPH_MAX_NODES];
+    uint16_t node_edge[GRAPH_MAX_NODES][4]; // edge leaving the node in each direction
+    GraphEdge edge[GRAPH_MAX_EDGES];
+    uint16_t* dist;                      // nodes*nodes shortest path lengths, GRAPH_NONE if unreachable
+    struct MazeGraph* link;              // cache chain
+} MazeGraph;
+
+// Shared graph for a level layout; built on first use and cached like nav_for_layout().
+// NULL if graph_build() fails (the ghosts then fall back to per-step targeting).
+const MazeGraph* graph_for_layout(const char* const* layout, bool ghost);
+// Build a private graph into caller storage / free its distance matrix. false if out of
+// memory, or with too_open set if the layout has more than GRAPH_MAX_NODES junctions or
+// GRAPH_MAX_EDGES corridors (open rooms: nearly every tile of one is a junction).
+bool graph_build(MazeGraph* mg, const char* const* layout, bool ghost);
+void graph_release(MazeGraph* mg);
+
+static inline bool graph_is_node(const MazeGraph* mg, int x, int y){ return mg->node_of[y][x]!=GRAPH_NONE; }
+
+// Direction to keep following a corridor when arriving with heading dir (-1 if the
+// tile is a node or the heading does not fit the corridor).
+static inline int graph_glide_dir(const MazeGraph* mg, int x, int y, int dir){
+    if(graph_is_node(mg,x,y) || dir<0) return -1;
+    int rest = mg->exits[y][x] & ~(1<<(dir^1));
+    for(int i=0;i<4;i++) if(rest & (1<<i)) return i;
+    return -1;
+}
+
+// Shortest path length between two walkable tiles, or -1 (wall / unreachable).
+int graph_dist(const MazeGraph* mg, Point a, Point b);
+
+// Pre-turn query: from p heading dir, the next node reached and how many steps away.
+// Returns false if dir is blocked at p.
+bool graph_ahead(const MazeGraph* mg, Point p, int dir, Point* node, int* steps);
+
+// Index into NAV_DIRS for a unit heading, -1 for (0,0).
+int graph_dir_index(int dx, int dy);
+
+#endif
@@ -0,0 +1,406 @@
+// headless.c — fast-forward simulation with no SDL: plays whole games with a simple
+// pellet-seeking bot as fast as the CPU allows and prints score/lives/ticks.
+// Standalone build: cc -O2 -pthread -DHEADLESS_MAIN headless.c sim.c nav.c graph.c trace.c telemetry.c stress.c replay.c batch.c pool.c mcts.c swrender.c capture.c agent.c -o pacman_headless
+// Also reachable from the SDL build as: ./pacman2 --headless [options]
+
+#define _POSIX_C_SOURCE 199309L
+#include "headless.h"
+#include "sim.h"
+#include "stress.h"
+#include "replay.h"
+#include "batch.h"
+#include "mcts.h"
+#include "nav.h"
+#include "swrender.h"
+#include "capture.h"
+#include "agent.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// Greedy bot: BFS to the nearest pellet (or frightened ghost), treating tiles at or
+// next to a non-frightened ghost as walls. Keeps its heading if nothing is reachable.
+static void bot_steer(Game* gm, InputLog* log){
+    static unsigned char blocked[MAP_H][MAP_W], vis[MAP_H][MAP_W];
+    static signed char first[MAP_H][MAP_W];
+    static int qx[MAP_W*MAP_H], qy[MAP_W*MAP_H];
+    const int dirs[4][2]={{0,-1},{-1,0},{0,1},{1,0}};
+    memset(blocked, 0, sizeof blocked); memset(vis, 0, sizeof vis);
+    for(int i=0;i<4;i++){
+        const Ghost* g=&gm->ghosts[i];
+        if(g->mode==MODE_FRIGHT) continue;
+        blocked[g->e.y][g->e.x]=1;
+        for(int d=0;d<4;d++){
+            int nx=(g->e.x+dirs[d][0]+MAP_W)%MAP_W, ny=g->e.y+dirs[d][1];
+            if(in_bounds(nx,ny)) blocked[ny][nx]=1;
+        }
+    }
+    int head=0, tail=0;
+    vis[gm->pac.y][gm->pac.x]=1;
+    for(int d=0;d<4;d++){
+        int nx=(gm->pac.x+dirs[d][0]+MAP_W)%MAP_W, ny=gm->pac.y+dirs[d][1];
+        if(!in_bounds(nx,ny) || !passable_for_pac(gm,nx,ny) || blocked[ny][nx] || vis[ny][nx]) continue;
+        vis[ny][nx]=1; first[ny][nx]=(signed char)d; qx[tail]=nx; qy[tail]=ny; tail++;
+    }
+    while(head<tail){
+        int x=qx[head], y=qy[head]; head++;
+        bool prey=false;
+        for(int i=0;i<4;i++) if(gm->ghosts[i].mode==MODE_FRIGHT && gm->ghosts[i].e.x==x && gm->ghosts[i].e.y==y) prey=true;
+        if(is_food_at(gm,x,y) || prey){
+            int d=first[y][x]; replay_set_dir(log, gm, dirs[d][0], dirs[d][1]); return;
+        }
+        for(int d=0;d<4;d++){
+            int nx=(x+dirs[d][0]+MAP_W)%MAP_W, ny=y+dirs[d][1];
+            if(!in_bounds(nx,ny) || !passable_for_pac(gm,nx,ny) || blocked[ny][nx] || vis[ny][nx]) continue;
+            vis[ny][nx]=1; first[ny][nx]=first[y][x]; qx[tail]=nx; qy[tail]=ny; tail++;
+        }
+    }
+}
+
+static void usage(void){
+    fprintf(stderr,
+        "usage: --headless [--games N] [--max-ticks T] [--seed S] [--quiet] [--record FILE] [--telemetry FILE]\n"
+        "       --headless --replay FILE [--capture OUT [--capture-fps N]]\n"
+        "       --headless --batch N [--ticks T] [--threads K] [--seed S]\n"
+        "       --headless --mcts [--games N] [--budget MS | --rollouts N] [--threads K] [--horizon T]\n"
+        "       --headless --agent [PATH] [--games N] [--max-ticks T] [--seed S]\n"
+        "       --headless --stress [--size N] [--ghosts N] [--ticks T] [--seed S] [--per-ghost-bfs]\n"
+        "  --games N        number of games to simulate (default 1000)\n"
+        "  --max-ticks T    abandon a game after T ticks (default 20000)\n"
+        "  --seed S         game n is seeded with S+n (default: time)\n"
+        "  --quiet          only print the summary line\n"
+        "  --record FILE    save the input log of game 0 for --replay\n"
+        "  --telemetry FILE append the games' events (telemetry.h) to FILE, for tools/telemstat\n"
+        "  --replay FILE    re-simulate an input log and check its per-tick state hashes\n"
+        "  --capture OUT    render the games or the replay to video: OUT.y4m, or a PNG\n"
+        "                   pattern like frames/f%%05d.png (software renderer, no SDL)\n"
+        "  --capture-fps N  video frame rate, entities interpolated between ticks\n"
+        "                   (default: one frame per tick)\n"
+        "  --agent [PATH]   let an external process play through the shared-memory channel\n"
+        "                   in agent.h (default " AGENT_DEFAULT_PATH ")\n"
+        "  --stress         generated NxN maze with many ghosts instead of LEVEL0 games\n"
+        "  --size N         stress maze width and height (default 513)\n"
+        "  --ghosts N       stress ghost count (default 256)\n"
+        "  --ticks T        stress/batch ticks to run (default 1000)\n"
+        "  --per-ghost-bfs  stress baseline: one BFS per ghost instead of the shared flow field\n"
+        "  --batch N        step N independent games together (SoA batch) with random inputs\n"
+        "  --threads K      batch / search worker threads (default: one per CPU)\n"
+        "  --mcts           steer with the tree-search autopilot instead of the greedy bot\n"
+        "  --budget MS      search time per tick (default 55)\n"
+        "  --rollouts N     fixed rollouts per search thread instead of a time budget\n"
+        "  --horizon T      rollout length in ticks (default 40)\n");
+}
+
+static int run_stress(int size, int nghosts, long ticks, unsigned seed, bool per_ghost){
+    if(size<1 || size>STRESS_MAX_SIZE || nghosts<1 || nghosts>STRESS_MAX_GHOSTS){
+        fprintf(stderr, "stress: --size must be 1..%d and --ghosts 1..%d\n", STRESS_MAX_SIZE, STRESS_MAX_GHOSTS);
+        return 2;
+    }
+    StressWorld sw;
+    double t0=now_sec();
+    if(!stress_init(&sw, size, size, nghosts, seed)){ fprintf(stderr, "stress: out of memory\n"); return 1; }
+    double gen=now_sec()-t0, t_field=0, t_move=0, t_coll=0;
+    for(long i=0;i<ticks;i++){
+        double a=now_sec();
+        if(!per_ghost) stress_build_field(&sw);
+        double b=now_sec();
+        if(per_ghost) stress_move_per_ghost_bfs(&sw); else stress_move(&sw);
+        double c=now_sec();
+        stress_collide(&sw);
+        double d=now_sec();
+        t_field+=b-a; t_move+=c-b; t_coll+=d-c;
+    }
+    double total=t_field+t_move+t_coll;
+    printf("stress maze %dx%d ghosts %d ticks %ld mode %s seed %u gen %.1fms\n",
+           sw.w, sw.h, nghosts, ticks, per_ghost? "per-ghost-bfs" : "flow-field", seed, gen*1e3);
+    printf("stress per tick: total %.3fms field %.3fms move %.3fms collide %.4fms tiles_expanded %.0f\n",
+           ticks? total*1e3/ticks : 0.0, ticks? t_field*1e3/ticks : 0.0, ticks? t_move*1e3/ticks : 0.0,
+           ticks? t_coll*1e3/ticks : 0.0, ticks? (double)sw.bfs_tiles/ticks : 0.0);
+    printf("stress result: score %ld deaths %ld ghosts_eaten %ld pellets_left %ld ticks/s %.0f\n",
+           sw.score, sw.deaths, sw.ghosts_eaten, sw.pellets, total>0? ticks/total : 0.0);
+    stress_free(&sw);
+    return 0;
+}
+
+// ===== Video capture (--capture) =====
+// Frames come from the software renderer (swrender.h) drawing straight into the
+// capture ring, and are encoded on capture.c's thread while the games go on. One
+// frame per tick, or with --capture-fps the nearest whole number of frames per tick,
+// interpolated. Runs as fast as rendering and encoding allow, not in real time.
+typedef struct {
+    Capture* cap;
+    SwRenderer sr;
+    int sub;                    // frames per tick
+    Point last[5];              // entity tiles at the previous tick
+    bool started;               // a frame of the current game was drawn
+    long frames; double draw_s;
+} Video;
+
+static int gcd(int a, int b){ while(b){ int t=a%b; a=b; b=t; } return a; }
+
+static bool video_open(Video* v, const char* path, int fps){
+    memset(v, 0, sizeof *v);
+    v->sub = fps>0 ? (fps*STEP_MS + 500)/1000 : 1;
+    if(v->sub<1) v->sub = 1;
+    int num = v->sub*1000, den = STEP_MS, g = gcd(num, den);
+    num /= g; den /= g;
+    char err[256];
+    if(!swr_init(&v->sr)){ fprintf(stderr, "capture: out of memory\n"); return false; }
+    if(!(v->cap = capture_open(path, SW_W, SW_H, num, den, CAPTURE_SLOTS, err, sizeof err))){
+        fprintf(stderr, "%s\n", err); swr_free(&v->sr); return false;
+    }
+    return true;
+}
+
+static void video_frames(Video* v, const Game* gm, int n, bool move){
+    for(int k=1;k<=n;k++){
+        Framebuffer fb = { capture_begin(v->cap), SW_W, SW_H, SW_W };
+        double t0 = now_sec();
+        swr_draw(&v->sr, &fb, gm, move? v->last : NULL, (float)k/n);
+        v->draw_s += now_sec() - t0;
+        capture_commit(v->cap);
+        v->frames++;
+    }
+}
+
+// After a new game starts and after every tick.
+static void video_tick(void* ctx, const Game* gm){
+    Video* v = ctx;
+    video_frames(v, gm, v->started? v->sub : 1, v->started);
+    swr_positions(gm, v->last);
+    v->started = true;
+}
+
+// Hold the final picture for a second, then start over with the next game.
+static void video_end_game(Video* v, const Game* gm){
+    video_frames(v, gm, v->sub*(1000/STEP_MS), false);
+    v->started = false;
+}
+
+static bool video_close(Video* v, const char* path, double wall){
+    CaptureStats st = capture_close(v->cap);
+    swr_free(&v->sr);
+    double secs = (double)v->frames*STEP_MS/(1000.0*v->sub);
+    printf("capture %s frames %ld fps %.2f video %.1fs draw %.1fus/frame encode %.1fus/frame wall %.2fs %.1fx real time producer waits %ld%s\n",
+           path, st.frames, 1000.0*v->sub/STEP_MS, secs, v->frames? v->draw_s*1e6/v->frames : 0.0,
+           st.frames? st.encode_s*1e6/st.frames : 0.0, wall, wall>0? secs/wall : 0.0, st.waits, st.ok? "" : " WRITE ERRORS");
+    if(!st.ok) fprintf(stderr, "capture: could not write every frame of %s\n", path);
+    return st.ok;
+}
+
+static int run_replay(const char* path, const char* capture, int capture_fps){
+    InputLog log;
+    if(!replay_load(&log, path)){ fprintf(stderr, "replay: cannot read input log %s\n", path); return 1; }
+    Game gm; uint32_t bad=0;
+    Video video;
+    if(capture && !video_open(&video, capture, capture_fps)){ replay_free(&log); return 1; }
+    double t0=now_sec();
+    bool ok=replay_run_each(&log, &gm, &bad, capture? video_tick : NULL, &video);
+    if(capture && ok) video_end_game(&video, &gm);
+    double dt=now_sec()-t0;
+    if(ok) printf("replay %s seed %llu events %u ticks %u score %d lives %d result %s: all hashes match (%.2fms, %.0f ticks/s)\n",
+                  path, (unsigned long long)log.seed, log.nev, log.ticks, gm.score, gm.lives,
+                  gm.won? "won" : gm.over? "over" : "unfinished", dt*1e3, dt>0? log.ticks/dt : 0.0);
+    else printf("replay %s seed %llu: DESYNC at tick %u of %u\n", path, (unsigned long long)log.seed, bad, log.ticks);
+    if(capture && !video_close(&video, capture, now_sec()-t0)) ok = false;
+    replay_free(&log);
+    return ok? 0 : 1;
+}
+
+// ===== External agent (--agent) =====
+// Games played by another process through agent.h, in lockstep: publish the state,
+// wait for the answer, step. The first answer may take as long as the agent needs to
+// start; after that a silent agent for AGENT_WAIT_MS ends the run. Reports steps/s
+// and how the time split between the simulation and waiting on the agent.
+#define AGENT_WAIT_MS 10000
+
+static int run_agent(const char* path, long games, long max_ticks, unsigned seed, bool quiet, const char* record){
+    AgentLink link; char err[256];
+    if(!agent_create(&link, path, err, sizeof err)){ fprintf(stderr, "%s\n", err); return 1; }
+    fprintf(stderr, "agent: waiting for an agent on %s\n", path);
+    long won=0, lost=0, cut=0, steps=0; long long total_score=0;
+    double t_sim=0, t_wait=0, t0=0;
+    bool started=false, ok=true;
+    Game gm; InputLog log={0};
+    for(long n=0; n<games && ok; n++){
+        InputLog* rec = (n==0 && record)? &log : NULL;
+        replay_begin(rec, &gm, (uint64_t)seed + (uint64_t)n);
+        int ev=0, act;
+        for(;;){
+            bool done = gm.won || gm.over || gm.ticks>=(uint32_t)max_ticks;
+            uint32_t seq = agent_publish(&link, &gm, (uint32_t)n, ev, done);
+            double a=now_sec();
+            act = agent_wait_action(&link, seq, started? AGENT_WAIT_MS : -1);
+            if(!started){ started=true; t0=now_sec(); } else t_wait += now_sec()-a;
+            if(act==AGENT_TIMEOUT || act==AGENT_GONE){
+                fprintf(stderr, "agent: %s at game %ld tick %u\n", act==AGENT_GONE? "agent detached" : "no answer", n, gm.ticks);
+                ok=false; break;
+            }
+            if(done || act==AGENT_RESET) break;
+            if(act>=0 && act<4) replay_set_dir(rec, &gm, NAV_DIRS[act][0], NAV_DIRS[act][1]);
+            double b=now_sec();
+            ev = replay_step(rec, &gm);
+            t_sim += now_sec()-b; steps++;
+        }
+        if(!ok) break;
+        if(rec && !replay_save(rec, record)) fprintf(stderr, "record: cannot write %s\n", record);
+        const char* result = gm.won? "won" : gm.over? "over" : act==AGENT_RESET? "reset" : "timeout";
+        if(gm.won) won++; else if(gm.over) lost++; else cut++;
+        total_score += gm.score;
+        if(!quiet) printf("game %ld score %d lives %d ticks %u pellets_left %d result %s\n",
+                          n, gm.score, gm.lives, gm.ticks, gm.pellets, result);
+    }
+    double wall = started? now_sec()-t0 : 0;
+    long played = won+lost+cut;
+    printf("agent games %ld won %ld over %ld cut %ld avg_score %.1f steps %ld steps/s %.0f "
+           "(sim %.0f%%, waiting on the agent %.0f%%, round trip %.2fus)\n",
+           played, won, lost, cut, played? (double)total_score/played : 0.0, steps, wall>0? steps/wall : 0.0,
+           wall>0? 100*t_sim/wall : 0.0, wall>0? 100*t_wait/wall : 0.0, steps? t_wait*1e6/steps : 0.0);
+    agent_close(&link, path);
+    replay_free(&log);
+    return ok? 0 : 1;
+}
+
+// Training-farm shape: N games stepped in lockstep, finished ones restarted, random
+// headings standing in for a policy. Reports env-steps per second and per core.
+static int run_batch(int n, long ticks, int threads, unsigned seed){
+    BatchSim b;
+    Pool* pool = pool_create(threads);
+    int8_t* act = malloc(n>0? (size_t)n : 1);
+    if(!pool || !act || !batch_init(&b, n, seed)){ fprintf(stderr, "batch: cannot set up %d games\n", n); pool_destroy(pool); free(act); return 1; }
+    b.auto_reset = true;
+    uint64_t rng = seed ? seed : SIM_DEFAULT_SEED;
+    long episodes=0; long long ep_score=0;
+    double t0=now_sec(), t_step=0;
+    for(long t=0;t<ticks;t++){
+        for(int e=0;e<n;e++) act[e] = (t+e)%6==0 ? (int8_t)(sim_rand(&rng)%4) : -1;
+        double a=now_sec();
+        batch_step(&b, act, pool);
+        t_step += now_sec()-a;
+        for(int e=0;e<n;e++) if(b.events[e] & (EV_WON|EV_OVER)){ episodes++; ep_score+=b.score[e]; }
+    }
+    double wall=now_sec()-t0, steps=(double)n*ticks;
+    int used=pool_threads(pool);
+    printf("batch envs %d ticks %ld threads %d chunk %d seed %u episodes %ld avg_score %.1f\n",
+           n, ticks, used, BATCH_CHUNK, seed, episodes, episodes? (double)ep_score/episodes : 0.0);
+    printf("batch env-steps/s %.0f per core %.0f (step %.3fs, wall %.3fs, steals %ld)\n",
+           t_step>0? steps/t_step : 0.0, t_step>0? steps/t_step/used : 0.0, t_step, wall, pool_steals(pool));
+    batch_free(&b); pool_destroy(pool); free(act);
+    return 0;
+}
+
+// Bot or tree-search games, one after another on this thread.
+static int run_games(long games, long max_ticks, unsigned seed, bool quiet, const char* record,
+                     const char* capture, int capture_fps, MctsConfig* mcts, int threads){
+    Mcts* planner = NULL;
+    if(mcts){
+        mcts->threads = threads; mcts->seed = seed;
+        if(!(planner = mcts_create(mcts))){ fprintf(stderr, "mcts: cannot set up the search\n"); return 1; }
+    }
+    long won=0, lost=0, timeouts=0; unsigned long long total_ticks=0; long long total_score=0;
+    long decisions=0, rollouts=0; double search_ms=0, max_ms=0;
+    Game gm; InputLog log={0};
+    Video video;
+    if(capture && !video_open(&video, capture, capture_fps)){ mcts_destroy(planner); return 1; }
+    double t0=now_sec();
+    for(long n=0;n<games;n++){
+        InputLog* rec = (n==0 && record)? &log : NULL;
+        replay_begin(rec, &gm, (uint64_t)seed + (uint64_t)n);
+        if(capture) video_tick(&video, &gm);
+        while(!gm.won && !gm.over && gm.ticks<(uint32_t)max_ticks){
+            if(planner){
+                MctsResult r = mcts_decide(planner, &gm);
+                if(r.dir>=0) replay_set_dir(rec, &gm, NAV_DIRS[r.dir][0], NAV_DIRS[r.dir][1]);
+                if(r.rollouts){ decisions++; rollouts+=r.rollouts; search_ms+=r.ms; if(r.ms>max_ms) max_ms=r.ms; }
+            }else bot_steer(&gm, rec);
+            replay_step(rec, &gm);
+            if(capture) video_tick(&video, &gm);
+        }
+        if(capture) video_end_game(&video, &gm);
+        if(rec && !replay_save(rec, record)) fprintf(stderr, "record: cannot write %s\n", record);
+        const char* result = gm.won? "won" : gm.over? "over" : "timeout";
+        if(gm.won) won++; else if(gm.over) lost++; else timeouts++;
+        total_ticks += gm.ticks; total_score += gm.score;
+        if(!quiet) printf("game %ld score %d lives %d ticks %u pellets_left %d result %s\n",
+                          n, gm.score, gm.lives, gm.ticks, gm.pellets, result);
+    }
+    double dt=now_sec()-t0;
+    printf("summary games %ld won %ld over %ld timeout %ld avg_score %.1f ticks %llu seed %u "
+           "wall %.3fs games/min %.0f ticks/s %.0f\n",
+           games, won, lost, timeouts, games? (double)total_score/games : 0.0, total_ticks, seed,
+           dt, dt>0? games*60.0/dt : 0.0, dt>0? total_ticks/dt : 0.0);
+    if(planner){
+        printf("mcts threads %d %s decisions %ld rollouts/s %.0f per decision %.0f latency avg %.2fms max %.2fms\n",
+               mcts_threads(planner), mcts->rollouts>0? "fixed-rollouts" : "budget", decisions,
+               search_ms>0? rollouts*1e3/search_ms : 0.0, decisions? (double)rollouts/decisions : 0.0,
+               decisions? search_ms/decisions : 0.0, max_ms);
+        mcts_destroy(planner);
+    }
+    bool ok = !capture || video_close(&video, capture, dt);
+    replay_free(&log);
+    return ok? 0 : 1;
+}
+
+int headless_main(int argc, char** argv){
+    long games=1000, max_ticks=20000; unsigned seed=(unsigned)time(NULL); bool quiet=false;
+    bool stress=false, per_ghost=false; int size=513, nghosts=256; long stress_ticks=1000;
+    const char *record=NULL, *replay=NULL, *capture=NULL, *agent=NULL, *telemetry=NULL;
+    int capture_fps=0;
+    int batch=0, threads=0;
+    bool mcts=false; MctsConfig mcfg = MCTS_DEFAULT_CONFIG;
+    for(int i=1;i<argc;i++){
+        if(!strcmp(argv[i],"--headless")) continue;
+        else if(!strcmp(argv[i],"--games") && i+1<argc) games=atol(argv[++i]);
+        else if(!strcmp(argv[i],"--max-ticks") && i+1<argc) max_ticks=atol(argv[++i]);
+        else if(!strcmp(argv[i],"--seed") && i+1<argc) seed=(unsigned)strtoul(argv[++i],NULL,10);
+        else if(!strcmp(argv[i],"--quiet")) quiet=true;
+        else if(!strcmp(argv[i],"--record") && i+1<argc) record=argv[++i];
+        else if(!strcmp(argv[i],"--telemetry") && i+1<argc) telemetry=argv[++i];
+        else if(!strcmp(argv[i],"--replay") && i+1<argc) replay=argv[++i];
+        else if(!strcmp(argv[i],"--capture") && i+1<argc) capture=argv[++i];
+        else if(!strcmp(argv[i],"--capture-fps") && i+1<argc) capture_fps=atoi(argv[++i]);
+        else if(!strcmp(argv[i],"--agent")) agent = i+1<argc && argv[i+1][0]!='-' ? argv[++i] : AGENT_DEFAULT_PATH;
+        else if(!strcmp(argv[i],"--stress")) stress=true;
+        else if(!strcmp(argv[i],"--size") && i+1<argc) size=atoi(argv[++i]);
+        else if(!strcmp(argv[i],"--ghosts") && i+1<argc) nghosts=atoi(argv[++i]);
+        else if(!strcmp(argv[i],"--ticks") && i+1<argc) stress_ticks=atol(argv[++i]);
+        else if(!strcmp(argv[i],"--per-ghost-bfs")) per_ghost=true;
+        else if(!strcmp(argv[i],"--batch") && i+1<argc) batch=atoi(argv[++i]);
+        else if(!strcmp(argv[i],"--threads") && i+1<argc) threads=atoi(argv[++i]);
+        else if(!strcmp(argv[i],"--mcts")) mcts=true;
+        else if(!strcmp(argv[i],"--budget") && i+1<argc) mcfg.budget_ms=atof(argv[++i]);
+        else if(!strcmp(argv[i],"--rollouts") && i+1<argc) mcfg.rollouts=atoi(argv[++i]);
+        else if(!strcmp(argv[i],"--horizon") && i+1<argc) mcfg.horizon=atoi(argv[++i]);
+        else { usage(); return 2; }
+    }
+    TelemLog* telem = NULL;
+    if(telemetry){
+        char err[256];
+        if(!(telem = telem_open(telemetry, err, sizeof err))){ fprintf(stderr, "%s\n", err); return 1; }
+        if(!telem_attach(telem)) fprintf(stderr, "telemetry: out of memory, nothing is logged\n");
+    }
+    int rc = replay? run_replay(replay, capture, capture_fps)
+           : agent? run_agent(agent, games, max_ticks, seed, quiet, record)
+           : batch>0? run_batch(batch, stress_ticks, threads, seed)
+           : stress? run_stress(size, nghosts, stress_ticks, seed, per_ghost)
+           : run_games(games, max_ticks, seed, quiet, record, capture, capture_fps, mcts? &mcfg : NULL, threads);
+    if(telem){
+        TelemStats st;
+        bool ok = telem_close(telem, &st);
+        fprintf(stderr, "telemetry: %llu events, %.1f MB, %llu dropped -> %s%s\n",
+                (unsigned long long)st.events, st.bytes/1048576.0, (unsigned long long)st.dropped, telemetry, ok? "" : " (write failed)");
+        if(!ok && rc==0) rc = 1;
+    }
+    return rc;
+}
+
+#ifdef HEADLESS_MAIN
+int main(int argc, char** argv){ return headless_main(argc, argv); }
+#endif
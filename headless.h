@@ -0,0 +1,8 @@
+// headless.h — run simulated games with no window, renderer, mixer or TTF.
+#ifndef PACMAN_HEADLESS_H
+#define PACMAN_HEADLESS_H
+
+// Parses its own options (see headless.c); returns a process exit code.
+int headless_main(int argc, char** argv);
+
+#endif
@@ -0,0 +1,464 @@
+// levelpack.c — mapping, checking, writing and validating level packs (see levelpack.h).
+#include "levelpack.h"
+#include "mapfile.h"
+#include "nav.h"
+#include "graph.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(PackHeader)==32, "PackHeader layout");
+_Static_assert(sizeof(PackEntry)==48, "PackEntry layout");
+_Static_assert(sizeof(PackLevel)==972, "PackLevel layout");
+_Static_assert(sizeof(GraphEdge)==8, "GraphEdge layout");
+
+#define TILES (MAP_W*MAP_H)
+
+static size_t align8(size_t v){ return (v + 7) & ~(size_t)7; }
+
+static uint32_t fnv(const uint8_t* p, size_t n){
+    uint32_t h = 2166136261u;
+    for(size_t i=0;i<n;i++){ h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+static bool fail(char* err, size_t errlen, const char* fmt, ...){
+    if(err && errlen){ va_list ap; va_start(ap, fmt); vsnprintf(err, errlen, fmt, ap); va_end(ap); }
+    return false;
+}
+
+// Byte offsets of the graph section's parts, relative to graph_off.
+typedef struct { size_t exits, node_of, edge_of, off, nx, ny, node_edge, edge, dist, end; } GraphLayout;
+
+static GraphLayout graph_layout(size_t nodes, size_t edges){
+    GraphLayout g; size_t o = 0;
+    g.exits = o;     o = align8(o + TILES);
+    g.node_of = o;   o = align8(o + TILES*2);
+    g.edge_of = o;   o = align8(o + TILES*2);
+    g.off = o;       o = align8(o + TILES*2);
+    g.nx = o;        o = align8(o + nodes);
+    g.ny = o;        o = align8(o + nodes);
+    g.node_edge = o; o = align8(o + nodes*4*2);
+    g.edge = o;      o = align8(o + edges*sizeof(GraphEdge));
+    g.dist = o;      o = align8(o + nodes*nodes*2);
+    g.end = o;
+    return g;
+}
+
+static size_t nav_section_size(size_t n){ return align8(2*n + n*n); }
+
+// ===== Loading =====
+typedef struct {
+    Level level;
+    const char* rows[MAP_H];       // into the mapped tiles (not NUL-terminated)
+    Phase phases[LEVEL_MAX_PHASES];
+    NavTable nav;                  // next points into the mapping
+    MazeGraph graph;               // dist points into the mapping
+} LoadedLevel;
+
+struct LevelPack {
+    MappedFile file;
+    const uint8_t* data; size_t size;   // file.data / file.size
+    int count;
+    const PackEntry* entries;
+    LoadedLevel* levels;
+};
+
+// Everything the simulation will index with is range-checked here, and the graph is
+// checked against the tiles (graph_ahead() and graph_dist() follow a tile's exits into
+// its corridor), so a damaged or hostile pack is rejected instead of read out of bounds
+// later.
+static bool load_level(const uint8_t* rec, uint32_t size, LoadedLevel* out, char* err, size_t errlen){
+    if(size < sizeof(PackLevel)) return fail(err, errlen, "record too small");
+    const PackLevel* pl = (const PackLevel*)rec;
+    if(pl->pac_x>=MAP_W || pl->pac_y>=MAP_H) return fail(err, errlen, "Pac-Man spawn off the board");
+    for(int i=0;i<4;i++) if(pl->ghost_x[i]>=MAP_W || pl->ghost_y[i]>=MAP_H) return fail(err, errlen, "ghost %d spawn off the board", i);
+    if(pl->phase_count<1 || pl->phase_count>LEVEL_MAX_PHASES) return fail(err, errlen, "bad phase count %u", pl->phase_count);
+    for(int y=0;y<MAP_H;y++) out->rows[y] = (const char*)pl->tiles[y];
+    for(uint32_t i=0;i<pl->phase_count;i++)
+        if(pl->phase_mode[i]!=MODE_SCATTER && pl->phase_mode[i]!=MODE_CHASE) return fail(err, errlen, "bad mode in phase %u", i);
+
+    // Navigation table
+    size_t n = pl->nav_count;
+    if(n>TILES || pl->nav_off%8 || pl->nav_off<sizeof(PackLevel) || pl->nav_off + nav_section_size(n) > size)
+        return fail(err, errlen, "nav section out of bounds");
+    const uint8_t* tx = rec + pl->nav_off; const uint8_t* ty = tx + n; const uint8_t* next = ty + n;
+    NavTable* nt = &out->nav;
+    memset(nt, 0, sizeof *nt);
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) nt->index[y][x] = NAV_NONE;
+    for(size_t i=0;i<n;i++){
+        if(tx[i]>=MAP_W || ty[i]>=MAP_H || nt->index[ty[i]][tx[i]]!=NAV_NONE) return fail(err, errlen, "bad nav tile %zu", i);
+        nt->index[ty[i]][tx[i]] = (uint16_t)i;
+    }
+    for(size_t i=0;i<n*n;i++) if(next[i]>3 && next[i]!=NAV_STAY) return fail(err, errlen, "bad nav direction");
+    memcpy(nt->tx, tx, n); memcpy(nt->ty, ty, n);
+    nt->count = (int)n;
+    nt->next = (uint8_t*)next;     // read-only mapping; tables are never written after build
+    nt->layout = out->rows;
+
+    // Junction graph
+    size_t nodes = pl->graph_nodes, edges = pl->graph_edges;
+    if(nodes>GRAPH_MAX_NODES || edges>GRAPH_MAX_EDGES) return fail(err, errlen, "graph too large");
+    GraphLayout gl = graph_layout(nodes, edges);
+    if(pl->graph_off%8 || pl->graph_off < pl->nav_off + nav_section_size(n) || pl->graph_off + gl.end > size)
+        return fail(err, errlen, "graph section out of bounds");
+    const uint8_t* g = rec + pl->graph_off;
+    MazeGraph* mg = &out->graph;
+    memset(mg, 0, sizeof *mg);
+    memcpy(mg->exits, g + gl.exits, TILES);
+    memcpy(mg->node_of, g + gl.node_of, TILES*2);
+    memcpy(mg->edge_of, g + gl.edge_of, TILES*2);
+    memcpy(mg->off, g + gl.off, TILES*2);
+    memcpy(mg->nx, g + gl.nx, nodes); memcpy(mg->ny, g + gl.ny, nodes);
+    memcpy(mg->node_edge, g + gl.node_edge, nodes*8);
+    memcpy(mg->edge, g + gl.edge, edges*sizeof(GraphEdge));
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        if(mg->exits[y][x] & ~0xF) return fail(err, errlen, "bad graph exits");
+        if(mg->node_of[y][x]!=GRAPH_NONE && mg->node_of[y][x]>=nodes) return fail(err, errlen, "bad graph node id");
+        if(mg->edge_of[y][x]!=GRAPH_NONE && mg->edge_of[y][x]>=edges) return fail(err, errlen, "bad graph edge id");
+        // Exits join walkable tiles only, and every walkable tile is a node or on a corridor.
+        bool open = out->rows[y][x]!='#';
+        for(int d=0; d<4; d++){
+            if(!(mg->exits[y][x]>>d & 1)) continue;
+            int nx = (x + NAV_DIRS[d][0] + MAP_W) % MAP_W, ny = y + NAV_DIRS[d][1];
+            if(!open || ny<0 || ny>=MAP_H || out->rows[ny][nx]=='#') return fail(err, errlen, "graph exit into a wall at %d,%d", x, y);
+        }
+        if(open && mg->node_of[y][x]==GRAPH_NONE && mg->edge_of[y][x]==GRAPH_NONE)
+            return fail(err, errlen, "tile %d,%d is on no graph node or edge", x, y);
+    }
+    for(size_t i=0;i<nodes;i++){
+        if(mg->nx[i]>=MAP_W || mg->ny[i]>=MAP_H) return fail(err, errlen, "bad graph node %zu", i);
+        for(int d=0;d<4;d++) if(mg->node_edge[i][d]!=GRAPH_NONE && mg->node_edge[i][d]>=edges) return fail(err, errlen, "bad graph node edge");
+    }
+    for(size_t i=0;i<edges;i++){
+        const GraphEdge* e = &mg->edge[i];
+        if(e->a>=nodes || e->b>=nodes || e->dir_a>3 || e->dir_b>3) return fail(err, errlen, "bad graph edge %zu", i);
+    }
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++)
+        if(mg->node_of[y][x]==GRAPH_NONE && mg->edge_of[y][x]!=GRAPH_NONE && mg->off[y][x] > mg->edge[mg->edge_of[y][x]].len)
+            return fail(err, errlen, "corridor offset past its edge at %d,%d", x, y);
+    mg->nodes = (int)nodes; mg->edges = (int)edges;
+    mg->dist = (uint16_t*)(g + gl.dist);
+    mg->layout = out->rows; mg->ghost = true;
+
+    for(uint32_t i=0;i<pl->phase_count;i++) out->phases[i] = (Phase){ (GhostMode)pl->phase_mode[i], pl->phase_ticks[i] };
+    Level* lv = &out->level;
+    lv->layout = out->rows;
+    lv->pac_spawn = (Point){ pl->pac_x, pl->pac_y };
+    for(int i=0;i<4;i++) lv->ghost_spawn[i] = (Point){ pl->ghost_x[i], pl->ghost_y[i] };
+    lv->phases = out->phases; lv->phase_count = (int)pl->phase_count;
+    lv->nav = nt; lv->graph = mg;
+    return true;
+}
+
+LevelPack* levelpack_open(const char* path, char* err, size_t errlen){
+    LevelPack* p = calloc(1, sizeof *p);
+    if(!p){ fail(err, errlen, "out of memory"); return NULL; }
+    if(!mapfile_open(&p->file, path, err, errlen)){ free(p); return NULL; }
+    p->data = p->file.data; p->size = p->file.size;
+    const PackHeader* h = (const PackHeader*)p->data;
+    const char* why = NULL;
+    if(p->size < sizeof *h || memcmp(h->magic, PACK_MAGIC, 4)!=0) why = "not a level pack";
+    else if(h->version!=PACK_VERSION) why = "unsupported pack version";
+    else if(h->endian!=PACK_ENDIAN) why = "pack byte order does not match this machine";
+    else if(h->file_size!=p->size) why = "truncated pack";
+    else if(h->count==0 || h->count>1024 || h->entries_off%8 || (uint64_t)h->entries_off + (uint64_t)h->count*sizeof(PackEntry) > p->size)
+        why = "bad level directory";
+    if(why){ fail(err, errlen, "%s: %s", path, why); levelpack_close(p); return NULL; }
+
+    p->count = (int)h->count;
+    p->entries = (const PackEntry*)(p->data + h->entries_off);
+    p->levels = calloc((size_t)p->count, sizeof *p->levels);
+    if(!p->levels){ fail(err, errlen, "out of memory"); levelpack_close(p); return NULL; }
+    for(int i=0;i<p->count;i++){
+        const PackEntry* e = &p->entries[i];
+        char msg[128];
+        if(e->offset%8 || (uint64_t)e->offset + e->size > p->size || memchr(e->name, 0, PACK_NAME_LEN)==NULL)
+            snprintf(msg, sizeof msg, "bad directory entry");
+        else if(fnv(p->data + e->offset, e->size)!=e->checksum)
+            snprintf(msg, sizeof msg, "checksum mismatch");
+        else if(load_level(p->data + e->offset, e->size, &p->levels[i], msg, sizeof msg)) continue;
+        fail(err, errlen, "%s: level %d: %s", path, i, msg);
+        levelpack_close(p);
+        return NULL;
+    }
+    return p;
+}
+
+void levelpack_close(LevelPack* p){
+    if(!p) return;
+    mapfile_close(&p->file);
+    free(p->levels);
+    free(p);
+}
+
+int levelpack_count(const LevelPack* p){ return p ? p->count : 0; }
+const char* levelpack_name(const LevelPack* p, int i){ return p->entries[i].name; }
+const Level* levelpack_level(const LevelPack* p, int i){ return &p->levels[i].level; }
+
+// ===== Writing =====
+// Serialize one level with its freshly built tables; *out is malloc'd, size 8-aligned.
+static bool build_record(LevelSource* s, uint8_t** out, size_t* out_size, char* err, size_t errlen){
+    for(int y=0;y<MAP_H;y++) s->rows[y] = s->tiles[y];
+    NavTable nt;
+    if(!nav_build(&nt, s->rows)){ nav_release(&nt); return fail(err, errlen, "%s: out of memory building the nav table", s->name); }
+    // A private graph: graph_for_layout() would cache one per record for the life of the process.
+    MazeGraph graph, *mg = &graph;
+    if(!graph_build(mg, s->rows, true)){
+        nav_release(&nt); graph_release(mg);
+        if(mg->too_open) return fail(err, errlen, "%s: layout too open for the junction graph (more than %d junctions or %d corridors)",
+                                     s->name, GRAPH_MAX_NODES, GRAPH_MAX_EDGES);
+        return fail(err, errlen, "%s: out of memory building the graph", s->name);
+    }
+
+    size_t n = (size_t)nt.count, nav_off = align8(sizeof(PackLevel));
+    size_t graph_off = nav_off + nav_section_size(n);
+    GraphLayout gl = graph_layout((size_t)mg->nodes, (size_t)mg->edges);
+    size_t size = graph_off + gl.end;
+    uint8_t* rec = calloc(1, size);
+    if(!rec){ nav_release(&nt); graph_release(mg); return fail(err, errlen, "out of memory"); }
+
+    PackLevel* pl = (PackLevel*)rec;
+    for(int y=0;y<MAP_H;y++) memcpy(pl->tiles[y], s->tiles[y], MAP_W);
+    pl->pac_x = (uint8_t)s->pac_spawn.x; pl->pac_y = (uint8_t)s->pac_spawn.y;
+    for(int i=0;i<4;i++){ pl->ghost_x[i] = (uint8_t)s->ghost_spawn[i].x; pl->ghost_y[i] = (uint8_t)s->ghost_spawn[i].y; }
+    pl->phase_count = (uint32_t)s->phase_count;
+    for(int i=0;i<s->phase_count;i++){ pl->phase_mode[i] = (uint32_t)s->phases[i].mode; pl->phase_ticks[i] = s->phases[i].dur_ticks; }
+    pl->nav_count = (uint32_t)n; pl->nav_off = (uint32_t)nav_off;
+    memcpy(rec + nav_off, nt.tx, n); memcpy(rec + nav_off + n, nt.ty, n);
+    memcpy(rec + nav_off + 2*n, nt.next, n*n);
+    pl->graph_nodes = (uint32_t)mg->nodes; pl->graph_edges = (uint32_t)mg->edges; pl->graph_off = (uint32_t)graph_off;
+    uint8_t* g = rec + graph_off;
+    memcpy(g + gl.exits, mg->exits, TILES);
+    memcpy(g + gl.node_of, mg->node_of, TILES*2);
+    memcpy(g + gl.edge_of, mg->edge_of, TILES*2);
+    memcpy(g + gl.off, mg->off, TILES*2);
+    memcpy(g + gl.nx, mg->nx, (size_t)mg->nodes); memcpy(g + gl.ny, mg->ny, (size_t)mg->nodes);
+    memcpy(g + gl.node_edge, mg->node_edge, (size_t)mg->nodes*8);
+    memcpy(g + gl.edge, mg->edge, (size_t)mg->edges*sizeof(GraphEdge));
+    memcpy(g + gl.dist, mg->dist, (size_t)mg->nodes*mg->nodes*2);
+    nav_release(&nt); graph_release(mg);
+    *out = rec; *out_size = size;
+    return true;
+}
+
+bool levelpack_write(const char* path, LevelSource* src, int count, char* err, size_t errlen){
+    if(count<1 || count>1024) return fail(err, errlen, "need 1..1024 levels");
+    uint8_t** rec = calloc((size_t)count, sizeof *rec);
+    size_t* size = calloc((size_t)count, sizeof *size);
+    PackEntry* ent = calloc((size_t)count, sizeof *ent);
+    bool ok = rec && size && ent;
+    if(!ok) fail(err, errlen, "out of memory");
+    size_t off = align8(sizeof(PackHeader) + (size_t)count*sizeof(PackEntry));
+    for(int i=0;ok && i<count;i++){
+        ok = build_record(&src[i], &rec[i], &size[i], err, errlen);
+        if(!ok) break;
+        memcpy(ent[i].name, src[i].name, PACK_NAME_LEN-1);
+        ent[i].offset = (uint32_t)off; ent[i].size = (uint32_t)size[i];
+        ent[i].checksum = fnv(rec[i], size[i]);
+        off += size[i];
+    }
+    if(ok && off > UINT32_MAX) ok = fail(err, errlen, "pack too large");
+    if(ok){
+        PackHeader h; memset(&h, 0, sizeof h);
+        memcpy(h.magic, PACK_MAGIC, 4);
+        h.version = PACK_VERSION; h.endian = PACK_ENDIAN; h.count = (uint32_t)count;
+        h.entries_off = sizeof h; h.file_size = (uint32_t)off;
+        FILE* f = fopen(path, "wb");
+        if(!f) ok = fail(err, errlen, "cannot create %s", path);
+        else{
+            static const uint8_t zero[8];
+            size_t head = sizeof h + (size_t)count*sizeof(PackEntry);
+            ok = fwrite(&h, sizeof h, 1, f)==1 && fwrite(ent, sizeof *ent, (size_t)count, f)==(size_t)count
+                 && fwrite(zero, 1, align8(head)-head, f)==align8(head)-head;
+            for(int i=0;ok && i<count;i++) ok = fwrite(rec[i], 1, size[i], f)==size[i];
+            if(fclose(f)!=0) ok = false;
+            if(!ok) fail(err, errlen, "cannot write %s", path);
+        }
+    }
+    for(int i=0;rec && i<count;i++) free(rec[i]);
+    free(rec); free(size); free(ent);
+    return ok;
+}
+
+// ===== Text levels =====
+bool levelpack_parse_text(const char* path, LevelSource* s, char* err, size_t errlen){
+    FILE* f = fopen(path, "r");
+    if(!f) return fail(err, errlen, "%s: cannot open", path);
+    memset(s, 0, sizeof *s);
+    const char* base = strrchr(path, '/'); base = base ? base+1 : path;
+    snprintf(s->name, sizeof s->name, "%.*s", (int)strcspn(base, "."), base);
+    int rows=-1, lineno=0, nghost=0; bool have_pac=false, ok=true;
+    char line[256];
+    while(ok && fgets(line, sizeof line, f)){
+        lineno++;
+        line[strcspn(line, "\r\n")] = 0;
+        if(rows>=0){                                  // inside the map block
+            if(rows==MAP_H){ if(line[0]) ok = fail(err, errlen, "%s:%d: more than 31 map rows", path, lineno); continue; }
+            size_t len = strlen(line);
+            if(len>MAP_W){ ok = fail(err, errlen, "%s:%d: map row longer than 28 tiles", path, lineno); break; }
+            for(int x=0;x<MAP_W;x++){
+                char c = (size_t)x<len ? line[x] : ' ';
+                if(c=='P'){
+                    if(!have_pac){ s->pac_spawn = (Point){x, rows}; have_pac = true; }
+                    c = ' ';
+                }
+                if(!strchr("#H.o G", c)){ ok = fail(err, errlen, "%s:%d: unknown tile character", path, lineno); break; }
+                s->tiles[rows][x] = c;
+            }
+            rows++;
+            continue;
+        }
+        char* cmd = line + strspn(line, " \t");
+        if(!*cmd || *cmd==';') continue;
+        int x, y;
+        if(strncmp(cmd, "name ", 5)==0) snprintf(s->name, sizeof s->name, "%s", cmd+5);
+        else if(sscanf(cmd, "pac %d %d", &x, &y)==2){
+            if(!in_bounds(x,y)) ok = fail(err, errlen, "%s:%d: pac spawn off the board", path, lineno);
+            s->pac_spawn = (Point){x,y}; have_pac = true;
+        }
+        else if(sscanf(cmd, "ghost %d %d", &x, &y)==2){
+            if(nghost==4) ok = fail(err, errlen, "%s:%d: more than four ghosts", path, lineno);
+            else if(!in_bounds(x,y)) ok = fail(err, errlen, "%s:%d: ghost spawn off the board", path, lineno);
+            else s->ghost_spawn[nghost++] = (Point){x,y};
+        }
+        else if(strncmp(cmd, "phases", 6)==0){
+            s->phase_count = 0;
+            for(char* tok=strtok(cmd+6, " \t"); ok && tok; tok=strtok(NULL, " \t")){
+                char* end; long ms = strtol(tok+1, &end, 10);
+                if((tok[0]!='S' && tok[0]!='C') || *end || ms<0) ok = fail(err, errlen, "%s:%d: phase must be S<ms> or C<ms>", path, lineno);
+                else if(s->phase_count==LEVEL_MAX_PHASES) ok = fail(err, errlen, "%s:%d: more than 8 phases", path, lineno);
+                else s->phases[s->phase_count++] = (Phase){ tok[0]=='S' ? MODE_SCATTER : MODE_CHASE, (uint32_t)MS_TO_TICKS(ms) };
+            }
+        }
+        else if(strcmp(cmd, "map")==0) rows = 0;
+        else ok = fail(err, errlen, "%s:%d: unknown directive", path, lineno);
+    }
+    fclose(f);
+    if(!ok) return false;
+    if(rows!=MAP_H) return fail(err, errlen, "%s:%d: map block needs 31 rows", path, lineno);
+    if(!have_pac) return fail(err, errlen, "%s:%d: no Pac-Man spawn ('P' tile or pac directive)", path, lineno);
+    if(!nghost){
+        for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++)
+            if(s->tiles[y][x]=='G' && nghost<4) s->ghost_spawn[nghost++] = (Point){x,y};
+        if(!nghost) return fail(err, errlen, "%s:%d: no ghost spawn ('G' tile or ghost directive)", path, lineno);
+    }
+    for(int i=nghost;i<4;i++) s->ghost_spawn[i] = s->ghost_spawn[0];
+    if(!s->phase_count){                              // classic schedule
+        for(int i=0;i<PHASE_COUNT && i<LEVEL_MAX_PHASES;i++) s->phases[i] = PHASES[i];
+        s->phase_count = PHASE_COUNT < LEVEL_MAX_PHASES ? PHASE_COUNT : LEVEL_MAX_PHASES;
+    }
+    return true;
+}
+
+void levelpack_source(const LevelPack* p, int i, LevelSource* s){
+    const Level* lv = levelpack_level(p, i);
+    memset(s, 0, sizeof *s);
+    snprintf(s->name, sizeof s->name, "%s", levelpack_name(p, i));
+    for(int y=0;y<MAP_H;y++) memcpy(s->tiles[y], lv->layout[y], MAP_W);
+    s->pac_spawn = lv->pac_spawn;
+    memcpy(s->ghost_spawn, lv->ghost_spawn, sizeof s->ghost_spawn);
+    s->phase_count = lv->phase_count;
+    memcpy(s->phases, lv->phases, (size_t)lv->phase_count * sizeof *s->phases);
+}
+
+// ===== Validation =====
+static bool pac_open(const Level* lv, int x, int y){
+    return in_bounds(x,y) && lv->layout[y][x]!='#' && lv->layout[y][x]!='H';
+}
+
+// Pellets Pac-Man cannot reach from the spawn (or, if the spawn is a wall, from the
+// open tiles next to it, which is where the first step takes him).
+static int unreachable_pellets(const Level* lv){
+    static uint8_t seen[MAP_H][MAP_W];
+    static uint16_t queue[TILES];
+    memset(seen, 0, sizeof seen);
+    int head=0, tail=0;
+    Point s = lv->pac_spawn;
+    if(pac_open(lv,s.x,s.y)){ seen[s.y][s.x]=1; queue[tail++]=(uint16_t)(s.y*MAP_W+s.x); }
+    else for(int d=0;d<4;d++){
+        int x=s.x+NAV_DIRS[d][0], y=s.y+NAV_DIRS[d][1];
+        if(pac_open(lv,x,y) && !seen[y][x]){ seen[y][x]=1; queue[tail++]=(uint16_t)(y*MAP_W+x); }
+    }
+    while(head<tail){
+        int c=queue[head++], x0=c%MAP_W, y0=c/MAP_W;
+        for(int d=0;d<4;d++){
+            int x=x0+NAV_DIRS[d][0], y=y0+NAV_DIRS[d][1];
+            if(x<0) x=MAP_W-1; else if(x>=MAP_W) x=0;
+            if(!pac_open(lv,x,y) || seen[y][x]) continue;
+            seen[y][x]=1; queue[tail++]=(uint16_t)(y*MAP_W+x);
+        }
+    }
+    int lost=0;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        char c=lv->layout[y][x];
+        if((c=='.' || c=='o') && !seen[y][x]) lost++;
+    }
+    return lost;
+}
+
+static int check_tables(const Level* lv, FILE* out, int idx){
+    int errors=0;
+    NavTable nt;
+    if(!nav_build(&nt, lv->layout)){ nav_release(&nt); fprintf(out, "level %d: out of memory rebuilding nav\n", idx); return 1; }
+    const NavTable* got = lv->nav;
+    size_t n = (size_t)nt.count;
+    if(got->count!=nt.count || memcmp(got->tx, nt.tx, n) || memcmp(got->ty, nt.ty, n) || memcmp(got->next, nt.next, n*n)){
+        fprintf(out, "level %d: stored nav table differs from a rebuild\n", idx); errors++;
+    }
+    nav_release(&nt);
+    MazeGraph rebuilt;
+    const MazeGraph* want = &rebuilt;
+    const MazeGraph* mg = lv->graph;
+    if(!graph_build(&rebuilt, lv->layout, true)){
+        fprintf(out, "level %d: %s rebuilding graph\n", idx, rebuilt.too_open ? "layout too open for the junction graph" : "out of memory");
+        graph_release(&rebuilt);
+        return errors+1;
+    }
+    size_t nodes = (size_t)want->nodes;
+    if(mg->nodes!=want->nodes || mg->edges!=want->edges
+       || memcmp(mg->exits, want->exits, sizeof mg->exits) || memcmp(mg->node_of, want->node_of, sizeof mg->node_of)
+       || memcmp(mg->edge_of, want->edge_of, sizeof mg->edge_of) || memcmp(mg->off, want->off, sizeof mg->off)
+       || memcmp(mg->nx, want->nx, nodes) || memcmp(mg->ny, want->ny, nodes)
+       || memcmp(mg->node_edge, want->node_edge, nodes*8)
+       || memcmp(mg->edge, want->edge, (size_t)want->edges*sizeof(GraphEdge))
+       || memcmp(mg->dist, want->dist, nodes*nodes*2)){
+        fprintf(out, "level %d: stored graph differs from a rebuild\n", idx); errors++;
+    }
+    graph_release(&rebuilt);
+    return errors;
+}
+
+int levelpack_validate(const char* path, FILE* out){
+    char err[256];
+    LevelPack* p = levelpack_open(path, err, sizeof err);
+    if(!p){ fprintf(out, "%s\n", err); return 1; }
+    int errors=0;
+    for(int i=0;i<p->count;i++){
+        const PackEntry* e = &p->entries[i];
+        const Level* lv = &p->levels[i].level;
+        int before = errors;
+        if(fnv(p->data + e->offset, e->size)!=e->checksum){ fprintf(out, "level %d: checksum mismatch\n", i); errors++; }
+        int pellets=0, bad=0;
+        for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+            char c = lv->layout[y][x];
+            if(c=='.' || c=='o') pellets++;
+            else if(c!='#' && c!='H' && c!=' ' && c!='G') bad++;
+        }
+        if(bad){ fprintf(out, "level %d: %d tiles with unknown characters\n", i, bad); errors++; }
+        if(!pellets){ fprintf(out, "level %d: no pellets\n", i); errors++; }
+        Point ps = lv->pac_spawn;
+        if(!pac_open(lv, ps.x, ps.y)) fprintf(out, "level %d: warning: Pac-Man spawns on a closed tile (%d,%d)\n", i, ps.x, ps.y);
+        for(int g=0;g<4;g++){
+            Point q = lv->ghost_spawn[g];
+            if(lv->layout[q.y][q.x]=='#'){ fprintf(out, "level %d: ghost %d spawns inside a wall (%d,%d)\n", i, g, q.x, q.y); errors++; }
+        }
+        int lost = unreachable_pellets(lv);
+        if(lost){ fprintf(out, "level %d: %d pellets unreachable from the spawn\n", i, lost); errors++; }
+        errors += check_tables(lv, out, i);
+        fprintf(out, "level %d '%s': %s (%d pellets, %d nav tiles, %d graph nodes, %u bytes)\n",
+                i, e->name, errors==before ? "ok" : "FAILED", pellets, lv->nav->count, lv->graph->nodes, e->size);
+    }
+    levelpack_close(p);
+    return errors;
+}
@@ -0,0 +1,99 @@
+// levelpack.h — levels shipped as one versioned binary file that is memory-mapped
+// and used in place. Each level record holds its tiles, spawn points and phase
+// schedule plus the ghost navigation data the simulation would otherwise compute
+// on first use: the all-pairs next-hop table (nav.h) and the junction graph with its
+// node distance matrix (graph.h). Opening a pack checks every record's checksum,
+// structure and bounds, and that its graph agrees with its tiles; nothing is parsed
+// or searched. Packs are written by tools/levelc.c
+// from text mazes, which also validates them in depth.
+//
+// File layout, little-endian, every section 8-byte aligned:
+//   PackHeader | PackEntry[count] | level records (PackLevel + nav + graph sections)
+#ifndef PACMAN_LEVELPACK_H
+#define PACMAN_LEVELPACK_H
+
+#include "sim.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define PACK_MAGIC "PMLP"
+#define PACK_VERSION 1
+#define PACK_ENDIAN 0x01020304u      // reads back differently on a big-endian host
+#define PACK_NAME_LEN 32
+
+typedef struct {
+    char magic[4];
+    uint32_t version, endian, count;
+    uint32_t entries_off, file_size;
+    uint32_t reserved[2];
+} PackHeader;
+
+typedef struct {
+    char name[PACK_NAME_LEN];        // NUL-terminated
+    uint32_t offset, size;           // record bytes within the file
+    uint32_t checksum;               // FNV-1a of the record (checked on open)
+    uint32_t reserved;
+} PackEntry;
+
+// Fixed part of a level record. The nav section is tx[n], ty[n], next[n*n] bytes.
+// The graph section is exits (uint8 per tile), node_of, edge_of, off (uint16 per
+// tile), nx[nodes], ny[nodes], node_edge[nodes][4] (uint16), edges as GraphEdge,
+// dist[nodes*nodes] (uint16), each part starting 8-byte aligned.
+typedef struct {
+    uint8_t tiles[MAP_H][MAP_W];
+    uint8_t pac_x, pac_y, ghost_x[4], ghost_y[4];
+    uint8_t pad[2];
+    uint32_t phase_count;
+    uint32_t phase_mode[LEVEL_MAX_PHASES], phase_ticks[LEVEL_MAX_PHASES];
+    uint32_t nav_count, nav_off;     // offsets relative to the record start
+    uint32_t graph_nodes, graph_edges, graph_off;
+    uint32_t reserved;
+} PackLevel;
+
+typedef struct LevelPack LevelPack;
+
+// Map a pack and check it. NULL on failure with the reason in err.
+LevelPack* levelpack_open(const char* path, char* err, size_t errlen);
+void levelpack_close(LevelPack* pack);
+int levelpack_count(const LevelPack* pack);
+const char* levelpack_name(const LevelPack* pack, int i);
+// Ready to pass to game_new_level(); valid until levelpack_close().
+const Level* levelpack_level(const LevelPack* pack, int i);
+
+// Offline side (tools/levelc.c). A source level is a layout plus spawns and phases;
+// the writer builds the navigation tables and lays out the records.
+typedef struct {
+    char name[PACK_NAME_LEN];
+    char tiles[MAP_H][MAP_W + 1];
+    const char* rows[MAP_H];         // point into tiles
+    Point pac_spawn, ghost_spawn[4];
+    Phase phases[LEVEL_MAX_PHASES]; int phase_count;
+} LevelSource;
+
+// Build every level's tables and write the pack. false with the reason in err, which
+// includes a layout too open for the junction graph (graph.h limits its size).
+bool levelpack_write(const char* path, LevelSource* src, int count, char* err, size_t errlen);
+
+// Read a text level. false with "file:line: problem" in err. One directive per line,
+// ';' starts a comment:
+//   name Classic                    shown in menus (default: file name)
+//   pac 13 20                       Pac-Man spawn (default: the 'P' tile)
+//   ghost 13 14                     up to four, in ghost order (default: 'G' tiles
+//                                   in reading order, the first repeated if fewer)
+//   phases S7000 C20000 ... C0      scatter/chase schedule in ms, 0 = forever
+//   map                             followed by 31 rows of up to 28 tiles:
+//                                   '#' wall, 'H' gate, '.' pellet, 'o' power pellet,
+//                                   ' ' empty, 'G' ghost house, 'P' Pac-Man (empty)
+//                                   short rows are padded with empty tiles
+bool levelpack_parse_text(const char* path, LevelSource* s, char* err, size_t errlen);
+// Level i of an open pack as a source (tiles, spawns, phases; tables are not copied).
+void levelpack_source(const LevelPack* pack, int i, LevelSource* s);
+
+// Structural checks plus checksums, playability (pellets reachable, spawns on open
+// tiles) and a rebuild of every table compared against the stored one. Problems are
+// printed to out; returns the number of errors (warnings do not count).
+int levelpack_validate(const char* path, FILE* out);
+
+#endif
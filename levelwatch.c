@@ -0,0 +1,300 @@
+// levelwatch.c — live level generations, incremental reload and the file watcher (see levelwatch.h).
+#define _POSIX_C_SOURCE 200809L
+#include "levelwatch.h"
+#include "levelpack.h"
+#include "nav.h"
+#include "graph.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+static double now_ms(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1e3 + ts.tv_nsec*1e-6;
+}
+
+static bool fail(char* err, size_t errlen, const char* fmt, ...){
+    va_list ap; va_start(ap, fmt); vsnprintf(err, errlen, fmt, ap); va_end(ap);
+    return false;
+}
+
+// ===== Generations =====
+typedef struct {
+    Level level;
+    char tiles[MAP_H][MAP_W + 1];
+    const char* rows[MAP_H];
+    Phase phases[LEVEL_MAX_PHASES];
+    NavTable* nav; MazeGraph* graph;    // this generation's own copies of the table structs
+    bool own_tables;                // frees the shared next-hop and distance matrices: the newest sharer
+    LevelDiff diff;                 // from the previous generation
+} LiveGen;
+
+struct LiveLevel {
+    char path[512];
+    char name[PACK_NAME_LEN];
+    LiveGen* gen[LIVE_GENS];        // generation n lives in gen[n % LIVE_GENS]
+    unsigned count;
+};
+
+static LiveGen* newest(const LiveLevel* ll){ return ll->gen[(ll->count-1) % LIVE_GENS]; }
+
+static void gen_free(LiveGen* g){
+    if(!g) return;
+    if(g->nav){ if(g->own_tables) nav_release(g->nav); free(g->nav); }
+    if(g->graph){ if(g->own_tables) graph_release(g->graph); free(g->graph); }
+    free(g);
+}
+
+static bool gen_tables(LiveGen* g, const char* path, char* err, size_t errlen){
+    g->nav = malloc(sizeof *g->nav); g->graph = malloc(sizeof *g->graph);
+    g->own_tables = true;
+    bool too_open = false;
+    if(g->nav && !nav_build(g->nav, g->rows)){ free(g->nav); g->nav = NULL; }
+    if(g->graph && !graph_build(g->graph, g->rows, true)){ too_open = g->graph->too_open; graph_release(g->graph); free(g->graph); g->graph = NULL; }
+    g->level.nav = g->nav; g->level.graph = g->graph;
+    if(g->nav && g->graph) return true;
+    if(too_open) return fail(err, errlen, "%s: layout too open for the junction graph (more than %d junctions or %d corridors)",
+                             path, GRAPH_MAX_NODES, GRAPH_MAX_EDGES);
+    return fail(err, errlen, "%s: out of memory for the navigation tables", path);
+}
+
+// Text levels, or the first level of a pack. As in levelpack_validate(), a ghost may
+// not spawn inside a wall (Pac-Man may: his first step takes him out).
+static bool load_source(LiveLevel* ll, LevelSource* s, char* err, size_t errlen){
+    size_t n = strlen(ll->path);
+    if(n>5 && strcmp(ll->path+n-5, ".pack")==0){
+        LevelPack* p = levelpack_open(ll->path, err, errlen);
+        if(!p) return false;
+        if(levelpack_count(p)<1){ levelpack_close(p); return fail(err, errlen, "%s: no levels in the pack", ll->path); }
+        levelpack_source(p, 0, s);
+        levelpack_close(p);
+    }else if(!levelpack_parse_text(ll->path, s, err, errlen)) return false;
+    for(int i=0;i<4;i++) if(s->tiles[s->ghost_spawn[i].y][s->ghost_spawn[i].x]=='#')
+        return fail(err, errlen, "%s: ghost spawn is inside a wall", ll->path);
+    return true;
+}
+
+// Generation numbers are unique across every LiveLevel for the life of the process:
+// a generation's rows can land at a freed one's address, so caches keyed on the layout
+// (the search's exits table) check this as well.
+static _Atomic uint32_t gen_counter;
+
+static LiveGen* gen_from(const LevelSource* s){
+    LiveGen* g = calloc(1, sizeof *g);
+    if(!g) return NULL;
+    memcpy(g->tiles, s->tiles, sizeof g->tiles);
+    for(int y=0;y<MAP_H;y++){ g->tiles[y][MAP_W] = 0; g->rows[y] = g->tiles[y]; }
+    memcpy(g->phases, s->phases, sizeof g->phases);
+    g->level = (Level){ g->rows, s->pac_spawn, {s->ghost_spawn[0], s->ghost_spawn[1], s->ghost_spawn[2], s->ghost_spawn[3]},
+                        g->phases, s->phase_count, NULL, NULL, atomic_fetch_add(&gen_counter, 1)+1 };
+    return g;
+}
+
+LiveLevel* live_open(const char* path, char* err, size_t errlen){
+    LiveLevel* ll = calloc(1, sizeof *ll);
+    if(!ll){ snprintf(err, errlen, "out of memory"); return NULL; }
+    snprintf(ll->path, sizeof ll->path, "%s", path);
+    LevelSource s; LiveGen* g = NULL;
+    bool ok = load_source(ll, &s, err, errlen);
+    if(ok && !(g = gen_from(&s))) ok = fail(err, errlen, "out of memory");
+    if(ok) ok = gen_tables(g, path, err, errlen);
+    if(!ok){ gen_free(g); free(ll); return NULL; }
+    snprintf(ll->name, sizeof ll->name, "%s", s.name);
+    ll->gen[0] = g; ll->count = 1;
+    return ll;
+}
+
+void live_close(LiveLevel* ll){
+    if(!ll) return;
+    for(int i=0;i<LIVE_GENS;i++) gen_free(ll->gen[i]);
+    free(ll);
+}
+
+const Level* live_level(const LiveLevel* ll){ return &newest(ll)->level; }
+const char* live_name(const LiveLevel* ll){ return ll->name; }
+
+int live_reload(LiveLevel* ll, const LevelDiff** diff, LiveTimes* times, char* err, size_t errlen){
+    LiveTimes t = {0};
+    double t0 = now_ms();
+    LevelSource s;
+    if(!load_source(ll, &s, err, errlen)) return -1;
+    double t1 = now_ms(); t.parse_ms = t1-t0;
+
+    LiveGen* cur = newest(ll);
+    LiveGen* g = gen_from(&s);
+    if(!g){ snprintf(err, errlen, "out of memory"); return -1; }
+    LevelDiff* d = &g->diff;
+    d->from = &cur->level;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        char a = cur->tiles[y][x], b = g->tiles[y][x];
+        if(a==b) continue;
+        d->x[d->n] = (uint8_t)x; d->y[d->n] = (uint8_t)y; d->n++;
+        if((a=='#') != (b=='#')) d->walls = true;
+    }
+    d->spawns = cur->level.pac_spawn.x!=g->level.pac_spawn.x || cur->level.pac_spawn.y!=g->level.pac_spawn.y ||
+                memcmp(cur->level.ghost_spawn, g->level.ghost_spawn, sizeof g->level.ghost_spawn)!=0;
+    d->phases = cur->level.phase_count!=g->level.phase_count ||
+                memcmp(cur->phases, g->phases, (size_t)g->level.phase_count * sizeof *g->phases)!=0;
+    double t2 = now_ms(); t.diff_ms = t2-t1;
+    snprintf(ll->name, sizeof ll->name, "%s", s.name);
+    if(!d->n && !d->spawns && !d->phases){ free(g); if(times) *times = t; return 0; }
+
+    if(d->walls){
+        // A failed build is an error that keeps the current generation, rather than a
+        // fallback to the shared caches in nav.c/graph.c, which key on the layout
+        // pointer this generation frees later.
+        if(!gen_tables(g, ll->path, err, errlen)){ gen_free(g); return -1; }
+    }else{
+        // Ghost passability is unchanged: share the matrices and hand their ownership
+        // to the new generation. The table structs are copied so the copy can point at
+        // the new rows (graph_dist() reads them) while searches on other threads keep
+        // reading the previous generation's untouched tables.
+        g->nav = malloc(sizeof *g->nav); g->graph = malloc(sizeof *g->graph);
+        if(!g->nav || !g->graph){ gen_free(g); snprintf(err, errlen, "%s: out of memory for the navigation tables", ll->path); return -1; }
+        *g->nav = *cur->nav; *g->graph = *cur->graph;
+        g->nav->layout = g->rows; g->graph->layout = g->rows;
+        g->own_tables = cur->own_tables; cur->own_tables = false;
+        g->level.nav = g->nav; g->level.graph = g->graph;
+    }
+    t.tables_ms = now_ms()-t2;
+
+    unsigned slot = ll->count % LIVE_GENS;
+    gen_free(ll->gen[slot]);
+    ll->gen[slot] = g; ll->count++;
+    if(diff) *diff = d;
+    if(times) *times = t;
+    return 1;
+}
+
+static bool food(char c){ return c=='.' || c=='o'; }
+
+void live_apply(Game* gm, const Level* next, const LevelDiff* d){
+    gm->level = next;
+    gm->nav = next->nav; gm->graph = next->graph;
+    for(int i=0;i<d->n;i++){
+        int x = d->x[i], y = d->y[i];
+        uint32_t bit = 1u<<x;
+        char c = next->layout[y][x];
+        gm->pellets += (int)food(c) - (int)food(gm->board[y][x]);
+        gm->board[y][x] = c;
+        gm->bits.wall[y] &= ~bit; gm->bits.gate[y] &= ~bit; gm->bits.pellet[y] &= ~bit; gm->bits.power[y] &= ~bit;
+        if(c=='#') gm->bits.wall[y] |= bit;
+        else if(c=='H') gm->bits.gate[y] |= bit;
+        else if(c=='.') gm->bits.pellet[y] |= bit;
+        else if(c=='o') gm->bits.power[y] |= bit;
+    }
+    if(d->spawns){
+        gm->pac.startx = next->pac_spawn.x; gm->pac.starty = next->pac_spawn.y;
+        for(int i=0;i<4;i++){ gm->ghosts[i].e.startx = next->ghost_spawn[i].x; gm->ghosts[i].e.starty = next->ghost_spawn[i].y; }
+    }
+    if(gm->phase_idx >= next->phase_count) gm->phase_idx = next->phase_count-1;
+    if(d->n){
+        Entity* pac = &gm->pac;
+        if(!passable_for_pac(gm, pac->x, pac->y)){ pac->x = pac->startx; pac->y = pac->starty; }
+        for(int i=0;i<4;i++){
+            Entity* e = &gm->ghosts[i].e;
+            if(!passable_for_ghost(gm, e->x, e->y)){ e->x = e->startx; e->y = e->starty; }
+        }
+    }
+}
+
+// ===== Watcher =====
+#define WATCH_POLL_MS 250
+#define WATCH_SETTLE_MS 30          // editors write in several steps; report once they stop
+
+struct LevelWatch {
+    pthread_t thread;
+    atomic_bool quit;
+    char path[512], dir[512], file[256];
+    void (*changed)(void* ctx); void* ctx;
+#ifdef __linux__
+    int fd;
+#endif
+};
+
+#ifdef __linux__
+// Events for the watched name in the buffer just read.
+static bool names_file(const LevelWatch* w, const char* buf, ssize_t len){
+    bool hit = false;
+    for(const char* p=buf; p<buf+len; ){
+        const struct inotify_event* ev = (const struct inotify_event*)p;
+        if(ev->len && strcmp(ev->name, w->file)==0) hit = true;
+        p += sizeof *ev + ev->len;
+    }
+    return hit;
+}
+
+static void* watch_main(void* arg){
+    LevelWatch* w = arg;
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd pfd = { w->fd, POLLIN, 0 };
+    while(!atomic_load(&w->quit)){
+        if(poll(&pfd, 1, WATCH_POLL_MS) <= 0) continue;
+        ssize_t len = read(w->fd, buf, sizeof buf);
+        if(len <= 0 || !names_file(w, buf, len)) continue;
+        while(poll(&pfd, 1, WATCH_SETTLE_MS) > 0 && read(w->fd, buf, sizeof buf) > 0) {}
+        if(!atomic_load(&w->quit)) w->changed(w->ctx);
+    }
+    return NULL;
+}
+#else
+static void* watch_main(void* arg){
+    LevelWatch* w = arg;
+    struct stat last = {0}, st;
+    stat(w->path, &last);
+    while(!atomic_load(&w->quit)){
+        nanosleep(&(struct timespec){ 0, WATCH_POLL_MS*1000000L }, NULL);
+        if(stat(w->path, &st)!=0 || (st.st_mtime==last.st_mtime && st.st_size==last.st_size)) continue;
+        last = st;
+        nanosleep(&(struct timespec){ 0, WATCH_SETTLE_MS*1000000L }, NULL);
+        if(!atomic_load(&w->quit)) w->changed(w->ctx);
+    }
+    return NULL;
+}
+#endif
+
+LevelWatch* levelwatch_start(const char* path, void (*changed)(void* ctx), void* ctx){
+    LevelWatch* w = calloc(1, sizeof *w);
+    if(!w) return NULL;
+    snprintf(w->path, sizeof w->path, "%s", path);
+    const char* slash = strrchr(path, '/');
+    snprintf(w->file, sizeof w->file, "%s", slash ? slash+1 : path);
+    if(slash) snprintf(w->dir, sizeof w->dir, "%.*s", (int)(slash-path) ? (int)(slash-path) : 1, path);
+    else snprintf(w->dir, sizeof w->dir, ".");
+    w->changed = changed; w->ctx = ctx;
+#ifdef __linux__
+    // The directory rather than the file: a save by rename replaces the inode.
+    w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(w->fd < 0 || inotify_add_watch(w->fd, w->dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0){
+        if(w->fd >= 0) close(w->fd);
+        free(w); return NULL;
+    }
+#endif
+    if(pthread_create(&w->thread, NULL, watch_main, w)!=0){
+#ifdef __linux__
+        close(w->fd);
+#endif
+        free(w); return NULL;
+    }
+    return w;
+}
+
+void levelwatch_stop(LevelWatch* w){
+    if(!w) return;
+    atomic_store(&w->quit, true);
+    pthread_join(w->thread, NULL);
+#ifdef __linux__
+    close(w->fd);
+#endif
+    free(w);
+}
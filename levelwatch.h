@@ -0,0 +1,58 @@
+// levelwatch.h — levels edited while the game runs. A LiveLevel is read from a text
+// level (levelpack_parse_text) or the first level of a pack, and can be re-read at any
+// time. A reload diffs the new tiles, spawns and schedule against the current ones and
+// makes a new generation: an immutable Level with its own tiles. The ghost navigation
+// data (next-hop table, junction graph) is rebuilt only when a wall appeared or went,
+// since gate, pellet and spawn edits do not change ghost passability; otherwise the new
+// generation shares the previous tables' matrices (each has its own table structs, so a
+// reload never writes to tables a search may be reading). A layout the junction graph
+// cannot hold fails the reload and keeps the current generation. live_apply() then
+// moves a running game across by patching just the tiles that differ, keeping what was
+// eaten elsewhere.
+//
+// Generations stay valid for LIVE_GENS reloads, so a game, a frame in flight or a
+// search on another thread can still be on the previous ones. A LevelWatch reports
+// changes to the file: inotify on Linux (the directory is watched, so editors that
+// save by rename are seen), a modification-time poll elsewhere.
+#ifndef PACMAN_LEVELWATCH_H
+#define PACMAN_LEVELWATCH_H
+
+#include "sim.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LIVE_GENS 4
+
+typedef struct {
+    const Level* from;                      // generation the diff applies to
+    int n;                                  // tiles that differ
+    uint8_t x[MAP_W*MAP_H], y[MAP_W*MAP_H];
+    bool walls;                             // ghost passability changed: new tables
+    bool spawns, phases;
+} LevelDiff;
+
+typedef struct { double parse_ms, diff_ms, tables_ms; } LiveTimes;
+
+typedef struct LiveLevel LiveLevel;
+
+// NULL on failure with the reason in err.
+LiveLevel* live_open(const char* path, char* err, size_t errlen);
+void live_close(LiveLevel* ll);
+const Level* live_level(const LiveLevel* ll);      // newest generation
+const char* live_name(const LiveLevel* ll);
+// Re-read the file. 1: a new generation, *diff (valid as long as it) says what changed;
+// 0: nothing changed; -1: the file did not load (err), the current generation stays.
+int live_reload(LiveLevel* ll, const LevelDiff** diff, LiveTimes* times, char* err, size_t errlen);
+
+// Move a game on diff->from over to next: the differing tiles take their new contents
+// (the pellet count follows), spawn points apply from the next respawn, and anyone left
+// standing in a new wall goes back to their spawn.
+void live_apply(Game* gm, const Level* next, const LevelDiff* diff);
+
+// Calls changed(ctx) from its own thread after the file is written (debounced).
+typedef struct LevelWatch LevelWatch;
+LevelWatch* levelwatch_start(const char* path, void (*changed)(void* ctx), void* ctx);
+void levelwatch_stop(LevelWatch* w);
+
+#endif
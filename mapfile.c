@@ -0,0 +1,51 @@
+// mapfile.c — see mapfile.h.
+#define _POSIX_C_SOURCE 200809L
+#include "mapfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool fail(char* err, size_t errlen, const char* what, const char* path){
+    if(err && errlen) snprintf(err, errlen, "%s %s", what, path);
+    return false;
+}
+
+bool mapfile_open(MappedFile* mf, const char* path, char* err, size_t errlen){
+    mf->data = NULL; mf->size = 0; mf->mapped = false;
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if(fd<0) return fail(err, errlen, "cannot open", path);
+    struct stat st;
+    if(fstat(fd, &st)!=0 || st.st_size<=0){ close(fd); return fail(err, errlen, "cannot stat", path); }
+    void* m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(m==MAP_FAILED) return fail(err, errlen, "cannot map", path);
+    mf->data = m; mf->size = (size_t)st.st_size; mf->mapped = true;
+    return true;
+#else
+    FILE* f = fopen(path, "rb");
+    if(!f) return fail(err, errlen, "cannot open", path);
+    fseek(f, 0, SEEK_END); long n = ftell(f); fseek(f, 0, SEEK_SET);
+    uint8_t* buf = n>0 ? malloc((size_t)n) : NULL;
+    if(!buf || fread(buf, 1, (size_t)n, f)!=(size_t)n){ free(buf); fclose(f); return fail(err, errlen, "cannot read", path); }
+    fclose(f);
+    mf->data = buf; mf->size = (size_t)n;
+    return true;
+#endif
+}
+
+void mapfile_close(MappedFile* mf){
+    if(!mf->data) return;
+#ifndef _WIN32
+    if(mf->mapped) munmap((void*)mf->data, mf->size);
+    else free((void*)mf->data);
+#else
+    free((void*)mf->data);
+#endif
+    mf->data = NULL; mf->size = 0;
+}
@@ -0,0 +1,21 @@
+// mapfile.h — read-only whole-file mappings shared by the level pack and the asset
+// archive. POSIX maps the file; Windows builds read it into one buffer instead, so
+// callers see the same thing either way: a stable, read-only block of bytes.
+#ifndef PACMAN_MAPFILE_H
+#define PACMAN_MAPFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    bool mapped;            // false: data is a malloc'd copy
+} MappedFile;
+
+// false with the reason in err (may be NULL) if the file is missing, empty or unreadable.
+bool mapfile_open(MappedFile* mf, const char* path, char* err, size_t errlen);
+void mapfile_close(MappedFile* mf);
+
+#endif
@@ -0,0 +1,268 @@
+// mcts.c — root-parallel UCT search over macro actions (see mcts.h).
+#define _POSIX_C_SOURCE 199309L
+#include "mcts.h"
+#include "nav.h"
+#include "pool.h"
+#include "telemetry.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_DEPTH 64
+#define UCT_C 0.7f
+
+typedef struct {
+    int32_t child;              // first child; a node's children are contiguous
+    uint8_t nchild, dir;
+    uint32_t visits;
+    float value;                // sum of rollout values through this node
+} Node;
+
+typedef struct {
+    Node* nodes; int used;
+    uint64_t rng;
+    long rollouts;
+    Game g;                     // scratch state for the current iteration
+} Tree;
+
+struct Mcts {
+    MctsConfig cfg;
+    Pool* pool;
+    int trees;
+    Tree* tree;
+    const Game* root;           // during mcts_decide()
+    uint64_t deadline;
+    const char* const* exits_for;    // layout and generation the exits table was built for
+    uint32_t exits_gen;
+    uint8_t exits[MAP_H][MAP_W];     // bit d set: Pac-Man can step toward NAV_DIRS[d]
+};
+
+static uint64_t mono_ns(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// UCT needs ln and sqrt; these stay clear of libm. ln to ~1e-6 for x >= 1 via the
+// exponent bits and an atanh series on the mantissa; sqrt by Newton from a bit guess.
+static float ln_approx(float x){
+    uint32_t b; memcpy(&b, &x, 4);
+    int e = (int)(b>>23 & 0xFF) - 127;
+    b = (b & 0x7FFFFFu) | 0x3F800000u;
+    float m; memcpy(&m, &b, 4);
+    float t = (m-1)/(m+1), t2 = t*t;
+    return (float)e*0.69314718f + 2*t*(1 + t2*(1.0f/3 + t2*(0.2f + t2*(1.0f/7))));
+}
+static float sqrt_approx(float x){
+    if(x <= 0) return 0;
+    uint32_t b; memcpy(&b, &x, 4);
+    b = (b>>1) + 0x1FC00000u;
+    float r; memcpy(&r, &b, 4);
+    for(int i=0;i<3;i++) r = 0.5f*(r + x/r);
+    return r;
+}
+
+static int dir_index(int dx, int dy){
+    for(int d=0;d<4;d++) if(NAV_DIRS[d][0]==dx && NAV_DIRS[d][1]==dy) return d;
+    return -1;
+}
+static int reverse_dir(int d){ return d ^ 1; }   // R<->L, D<->U
+
+static void build_exits(Mcts* m, const Game* gm){
+    if(m->exits_for == gm->level->layout && m->exits_gen == gm->level->gen) return;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        uint8_t e = 0;
+        if(passable_for_pac(gm, x, y))
+            for(int d=0;d<4;d++) if(passable_for_pac(gm, x+NAV_DIRS[d][0], y+NAV_DIRS[d][1])) e |= (uint8_t)(1u<<d);
+        m->exits[y][x] = e;
+    }
+    m->exits_for = gm->level->layout; m->exits_gen = gm->level->gen;
+}
+
+static bool alive(const Game* g, int lives){ return !g->won && !g->over && g->lives==lives; }
+
+// Hold heading d until a junction, a wall, a death or the end of the game.
+static void macro_step(const Mcts* m, Game* g, int d){
+    game_set_dir(g, NAV_DIRS[d][0], NAV_DIRS[d][1]);
+    int lives = g->lives;
+    for(int t=1;;t++){
+        game_step(g);
+        if(!alive(g, lives) || t>=MCTS_MACRO_TICKS) return;
+        uint8_t e = m->exits[g->pac.y][g->pac.x];
+        if(popcount32(e) >= 3 || !(e>>d & 1)) return;
+    }
+}
+
+// Random headings at junctions and dead ends, never straight back unless forced.
+static void rollout(const Mcts* m, Tree* t, Game* g){
+    int lives = g->lives;
+    int d = dir_index(g->pac.dx, g->pac.dy);
+    for(int tick=0; tick<m->cfg.horizon && alive(g, lives); tick++){
+        uint8_t e = m->exits[g->pac.y][g->pac.x];
+        if(d<0 || popcount32(e) >= 3 || !(e>>d & 1)){
+            uint8_t opts = d>=0 && (e & ~(1u<<reverse_dir(d))) ? (uint8_t)(e & ~(1u<<reverse_dir(d))) : e;
+            if(!opts) break;
+            int k = (int)(sim_rand(&t->rng) % (uint32_t)popcount32(opts));
+            for(d=0;;d++) if((opts>>d & 1) && k-- == 0) break;
+            game_set_dir(g, NAV_DIRS[d][0], NAV_DIRS[d][1]);
+        }
+        game_step(g);
+    }
+}
+
+// Maze distance from Pac-Man to the nearest food, by flooding row masks outward one
+// step at a time (wrapping through the side tunnels); 0 when the board is clear.
+static int food_distance(const Game* g){
+    if(!g->pellets) return 0;
+    uint32_t open[MAP_H], seen[MAP_H] = {0}, front[MAP_H] = {0};
+    for(int y=0;y<MAP_H;y++) open[y] = ~(g->bits.wall[y] | g->bits.gate[y]) & ROW_MASK;
+    front[g->pac.y] = seen[g->pac.y] = 1u << g->pac.x;
+    for(int dist=0; dist<MAP_W*MAP_H; dist++){
+        bool any = false;
+        for(int y=0;y<MAP_H;y++) if(front[y] & (g->bits.pellet[y] | g->bits.power[y])) return dist;
+        uint32_t next[MAP_H];
+        for(int y=0;y<MAP_H;y++){
+            uint32_t f = front[y], n = f<<1 | f>>1 | (f & 1u)<<(MAP_W-1) | f>>(MAP_W-1);
+            if(y>0) n |= front[y-1];
+            if(y<MAP_H-1) n |= front[y+1];
+            next[y] = n & open[y] & ~seen[y];
+            seen[y] |= next[y]; any |= next[y]!=0;
+        }
+        if(!any) break;
+        memcpy(front, next, sizeof front);
+    }
+    return MAP_W + MAP_H;
+}
+
+// Pellets dominate the distance pull, so eating one never looks worse than keeping it
+// for the sake of being near the next.
+static float evaluate(const Game* root, const Game* g){
+    float v = (float)(g->score - root->score) / 500.0f + (float)(root->pellets - g->pellets) * 0.2f;
+    if(g->lives < root->lives) v -= 3.0f;
+    if(g->won) v += 3.0f;
+    return v - (float)food_distance(g) / 100.0f;
+}
+
+// Children for every heading Pac-Man can take here; false if the tree is full.
+static bool expand(const Mcts* m, Tree* t, int node, const Game* g){
+    uint8_t e = m->exits[g->pac.y][g->pac.x];
+    int n = popcount32(e);
+    if(!n || t->used + n > MCTS_NODES) return false;
+    Node* p = &t->nodes[node];
+    p->child = t->used; p->nchild = (uint8_t)n;
+    for(int d=0; d<4; d++) if(e>>d & 1){
+        Node* c = &t->nodes[t->used++];
+        memset(c, 0, sizeof *c);
+        c->dir = (uint8_t)d;
+    }
+    return true;
+}
+
+static int select_child(Tree* t, int node){
+    const Node* p = &t->nodes[node];
+    float explore = UCT_C * sqrt_approx(ln_approx((float)p->visits));
+    int best = p->child; float best_score = -1e30f;
+    for(int i=0;i<p->nchild;i++){
+        const Node* c = &t->nodes[p->child + i];
+        if(!c->visits) return p->child + i;
+        float s = c->value / (float)c->visits + explore / sqrt_approx((float)c->visits);
+        if(s > best_score){ best_score = s; best = p->child + i; }
+    }
+    return best;
+}
+
+static void iterate(const Mcts* m, Tree* t){
+    Game* g = &t->g;
+    *g = *m->root;
+    int lives = g->lives;
+    int path[MAX_DEPTH], depth = 0, node = 0;
+    path[depth++] = 0;
+    while(t->nodes[node].nchild && alive(g, lives) && depth < MAX_DEPTH){
+        node = select_child(t, node);
+        path[depth++] = node;
+        macro_step(m, g, t->nodes[node].dir);
+    }
+    if(alive(g, lives) && depth < MAX_DEPTH && t->nodes[node].visits && expand(m, t, node, g)){
+        node = t->nodes[node].child + (int)(sim_rand(&t->rng) % t->nodes[node].nchild);
+        path[depth++] = node;
+        macro_step(m, g, t->nodes[node].dir);
+    }
+    if(alive(g, lives)) rollout(m, t, g);
+    float v = evaluate(m->root, g);
+    for(int i=0;i<depth;i++){ t->nodes[path[i]].visits++; t->nodes[path[i]].value += v; }
+    t->rollouts++;
+}
+
+static void search(void* ctx, int chunk, int worker){
+    (void)worker;
+    Mcts* m = ctx;
+    Tree* t = &m->tree[chunk];
+    // Seeded from the position, so fixed-rollout decisions repeat exactly.
+    t->rng = (m->cfg.seed ^ ((uint64_t)m->root->ticks << 20) ^ (uint64_t)(chunk+1)*0x9E3779B97F4A7C15ULL) | 1;
+    t->used = 1; t->rollouts = 0;
+    memset(&t->nodes[0], 0, sizeof t->nodes[0]);
+    t->nodes[0].visits = 1;
+    if(!expand(m, t, 0, m->root)) return;
+    if(m->cfg.rollouts > 0) for(int i=0;i<m->cfg.rollouts;i++) iterate(m, t);
+    else while(mono_ns() < m->deadline) iterate(m, t);
+}
+
+Mcts* mcts_create(const MctsConfig* cfg){
+    Mcts* m = calloc(1, sizeof *m);
+    if(!m) return NULL;
+    m->cfg = *cfg;
+    if(m->cfg.horizon < 1) m->cfg.horizon = 1;
+    m->pool = pool_create(cfg->threads);
+    m->trees = m->pool ? pool_threads(m->pool) : 0;
+    m->tree = m->trees ? calloc((size_t)m->trees, sizeof *m->tree) : NULL;
+    bool ok = m->tree != NULL;
+    for(int i=0; ok && i<m->trees; i++) ok = (m->tree[i].nodes = malloc(MCTS_NODES * sizeof(Node))) != NULL;
+    if(!ok){ mcts_destroy(m); return NULL; }
+    return m;
+}
+
+void mcts_destroy(Mcts* m){
+    if(!m) return;
+    for(int i=0; m->tree && i<m->trees; i++) free(m->tree[i].nodes);
+    free(m->tree);
+    pool_destroy(m->pool);
+    free(m);
+}
+
+int mcts_threads(const Mcts* m){ return m->trees; }
+
+MctsResult mcts_decide(Mcts* m, const Game* gm){
+    MctsResult r = { -1, 0, 0, 0 };
+    uint64_t t0 = mono_ns();
+    if(gm->won || gm->over) return r;
+    build_exits(m, gm);
+    uint8_t e = m->exits[gm->pac.y][gm->pac.x];
+    if(popcount32(e) <= 1){                        // nothing to decide
+        for(int d=0; d<4; d++) if(e>>d & 1) r.dir = d;
+        r.ms = (double)(mono_ns()-t0) / 1e6;
+        return r;
+    }
+    m->root = gm;
+    m->deadline = t0 + (uint64_t)(m->cfg.budget_ms * 1e6);
+    // The calling thread searches too: its simulated futures are not gameplay.
+    TelemRing* logging = telem_ring; telem_ring = NULL;
+    pool_run(m->pool, m->trees, search, m);
+    telem_ring = logging;
+
+    uint32_t visits[4] = {0}; float value[4] = {0};
+    for(int i=0;i<m->trees;i++){
+        const Tree* t = &m->tree[i];
+        const Node* root = &t->nodes[0];
+        for(int c=0; c<root->nchild && t->used>1; c++){
+            const Node* n = &t->nodes[root->child + c];
+            visits[n->dir] += n->visits; value[n->dir] += n->value;
+        }
+        r.rollouts += t->rollouts; r.nodes += t->used;
+    }
+    for(int d=0; d<4; d++){
+        if(!(e>>d & 1)) continue;
+        if(r.dir < 0 || visits[d] > visits[r.dir] ||
+           (visits[d]==visits[r.dir] && visits[d] && value[d]/(float)visits[d] > value[r.dir]/(float)visits[r.dir])) r.dir = d;
+    }
+    r.ms = (double)(mono_ns()-t0) / 1e6;
+    return r;
+}
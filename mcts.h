@@ -0,0 +1,50 @@
+// mcts.h — Monte-Carlo tree search autopilot for Pac-Man. Each decision searches
+// from the current Game with the real rules: rollouts copy the Game by value and call
+// game_step(), so ghost targeting, the scatter/chase schedule, frightened ghosts and
+// collisions are exactly what the player faces. No allocation after mcts_create() and
+// no shared mutable state between searches, so trees run on every core at once.
+//
+// Root parallel: each pool worker grows its own tree with its own PRNG and the root
+// visit counts are summed. Tree moves are macro actions — hold a heading until
+// Pac-Man reaches a junction, is blocked, dies or MCTS_MACRO_TICKS pass — and
+// rollouts pick random headings at junctions for up to `horizon` ticks, stopping at
+// the first death. The value is the score and pellets gained, a penalty for dying, a
+// bonus for clearing the board and a small pull toward the nearest pellet by maze
+// distance.
+#ifndef PACMAN_MCTS_H
+#define PACMAN_MCTS_H
+
+#include "sim.h"
+#include <stdint.h>
+
+#define MCTS_NODES 16384        // per tree; expansion stops when full
+#define MCTS_MACRO_TICKS 8
+
+typedef struct {
+    int threads;                // search trees, one per pool worker; <=0: one per CPU
+    double budget_ms;           // wall-clock time per decision
+    int rollouts;               // >0: exactly this many per tree instead of the budget,
+                                // so decisions are reproducible whatever the timing
+    int horizon;                // rollout length in ticks
+    uint64_t seed;
+} MctsConfig;
+
+// Fits inside one STEP_MS tick with room for rendering.
+#define MCTS_DEFAULT_CONFIG ((MctsConfig){ 0, STEP_MS*0.5, 0, 40, 1 })
+
+typedef struct {
+    int dir;                    // NAV_DIRS index to steer, -1 when there is no move
+    long rollouts;              // over all trees
+    int nodes;                  // tree nodes over all trees
+    double ms;                  // decision latency
+} MctsResult;
+
+typedef struct Mcts Mcts;
+
+Mcts* mcts_create(const MctsConfig* cfg);   // NULL if out of memory or no threads
+void mcts_destroy(Mcts* m);
+int mcts_threads(const Mcts* m);
+// Search from gm (not modified). Not reentrant: one decision at a time per Mcts.
+MctsResult mcts_decide(Mcts* m, const Game* gm);
+
+#endif
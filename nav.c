@@ -0,0 +1,64 @@
+// nav.c — all-pairs next-hop table: one BFS per walkable tile, done once per layout.
+
+#include "nav.h"
+#include <stdlib.h>
+#include <string.h>
+
+const int NAV_DIRS[4][2]={{1,0},{-1,0},{0,1},{0,-1}};
+
+static NavTable* nav_cache;
+
+static bool layout_walkable(const char* const* layout, int x, int y){ return in_bounds(x,y) && layout[y][x]!='#'; }
+
+// BFS from every source in the same neighbour order as next_step_bfs(), carrying the
+// first step taken out of the source. Following parent pointers back from dst (what
+// next_step_bfs does) lands on that same first step, so results match tile for tile.
+bool nav_build(NavTable* nt, const char* const* layout){
+    nt->layout = layout;
+    nt->count = 0;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        if(layout_walkable(layout,x,y)){ nt->index[y][x]=(uint16_t)nt->count; nt->tx[nt->count]=(uint8_t)x; nt->ty[nt->count]=(uint8_t)y; nt->count++; }
+        else nt->index[y][x]=NAV_NONE;
+    }
+    int n = nt->count;
+    nt->next = malloc((size_t)n*n);
+    if(!nt->next) return false;
+    memset(nt->next, NAV_STAY, (size_t)n*n);
+
+    uint16_t queue[MAP_W*MAP_H];
+    uint8_t first[MAP_W*MAP_H];
+    unsigned char vis[MAP_W*MAP_H];
+    for(int s=0;s<n;s++){
+        uint8_t* row = nt->next + (size_t)s*n;
+        memset(vis, 0, (size_t)n);
+        int head=0, tail=0;
+        queue[tail++]=(uint16_t)s; vis[s]=1;
+        while(head<tail){
+            int c=queue[head++];
+            int x=nt->tx[c], y=nt->ty[c];
+            for(int i=0;i<4;i++){
+                int nx=x+NAV_DIRS[i][0], ny=y+NAV_DIRS[i][1];
+                if(nx<0) nx=MAP_W-1; else if(nx>=MAP_W) nx=0;   // tunnel wrap
+                if(!layout_walkable(layout,nx,ny)) continue;
+                int k=nt->index[ny][nx];
+                if(vis[k]) continue;
+                vis[k]=1; first[k] = (c==s)? (uint8_t)i : first[c];
+                row[k]=first[k]; queue[tail++]=(uint16_t)k;
+            }
+        }
+    }
+    return true;
+}
+
+void nav_release(NavTable* nt){ free(nt->next); nt->next=NULL; nt->count=0; }
+
+const NavTable* nav_for_layout(const char* const* layout){
+    for(NavTable* nt=nav_cache; nt; nt=nt->link) if(nt->layout==layout) return nt;
+    NavTable* nt = malloc(sizeof *nt);
+    if(!nt) return NULL;
+    if(!nav_build(nt, layout)){ free(nt); return NULL; }
+    nt->link = nav_cache; nav_cache = nt;
+    return nt;
+}
+
+size_t nav_footprint(const NavTable* nt){ return sizeof *nt + (size_t)nt->count*nt->count; }
@@ -0,0 +1,46 @@
+// nav.h — precomputed all-pairs next-hop table for ghost pathfinding.
+// Built once per maze layout; each ghost decision becomes an O(1) lookup that
+// returns exactly what next_step_bfs() would have returned.
+#ifndef PACMAN_NAV_H
+#define PACMAN_NAV_H
+
+#include "sim.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define NAV_NONE 0xFFFF      // tile is not walkable
+#define NAV_STAY 0xFF        // src==dst or dst unreachable: no step
+
+typedef struct NavTable {
+    const char* const* layout;          // level the table was built for
+    int count;                          // walkable tiles
+    uint16_t index[MAP_H][MAP_W];       // tile -> compact index, NAV_NONE for walls
+    uint8_t  tx[MAP_W*MAP_H], ty[MAP_W*MAP_H]; // compact index -> tile
+    uint8_t* next;                      // count*count: next[src*count+dst] = dir 0..3 or NAV_STAY
+    struct NavTable* link;              // cache chain
+} NavTable;
+
+// Direction order matches next_step_bfs(): R, L, D, U.
+extern const int NAV_DIRS[4][2];
+
+// Shared table for a level layout (ghost passability: everything but '#').
+// Built on first use and cached for the life of the process; the table is immutable.
+// Returns NULL if out of memory (callers fall back to next_step_bfs()).
+const NavTable* nav_for_layout(const char* const* layout);
+
+// Build a private table into caller storage / free its matrix. false if out of memory.
+bool nav_build(NavTable* nt, const char* const* layout);
+void nav_release(NavTable* nt);
+
+// Next direction (index into NAV_DIRS) from src toward dst, or -1 for no step.
+static inline int nav_next_dir(const NavTable* nt, Point src, Point dst){
+    uint16_t s = nt->index[src.y][src.x], d = nt->index[dst.y][dst.x];
+    if(s==NAV_NONE || d==NAV_NONE) return -1;
+    uint8_t dir = nt->next[(size_t)s*nt->count + d];
+    return dir==NAV_STAY ? -1 : dir;
+}
+
+// Bytes owned by the table (struct plus next-hop matrix).
+size_t nav_footprint(const NavTable* nt);
+
+#endif
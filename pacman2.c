@@ -1,7 +1,36 @@
 // pacman2.c — Pac-Man with classic scatter/chase schedule, ESC pause menu, SDL_ttf text,
-// main menu (Play, Level 2 [Locked], Controls, Credits, Quit), and SDL_mixer music/SFX.
-// Build: clang pacman2.c $(pkg-config --cflags --libs sdl2 sdl2_ttf sdl2_mixer) -o pacman2
-
+// main menu (Play, Level 2 from the level pack, Controls, Credits, Quit), and SDL_mixer music/SFX.
+// Build: clang pacman2.c text.c sim.c nav.c graph.c trace.c telemetry.c levelpack.c assetpack.c mapfile.c channel.c stress.c replay.c snapshot.c batch.c pool.c mcts.c swrender.c capture.c agent.c levelwatch.c headless.c -pthread $(pkg-config --cflags --libs sdl2 sdl2_ttf sdl2_mixer) -o pacman2
+// Headless: ./pacman2 --headless [--games N] [--max-ticks T] [--seed S] [--quiet]
+// Record/replay: ./pacman2 --record game.pml, then ./pacman2 --headless --replay game.pml
+// Render benchmark: ./pacman2 --bench-render [--frames N] (software renderer, offscreen)
+// Sprites: --flat-sprites draws entities as the old flat rects, to compare draw calls (F3)
+// Audio: --audio-buffer N sets the device buffer (sample frames, default 512);
+//        SDL_AUDIODRIVER=dummy ./pacman2 --audio-test [--triggers N] measures effect latency
+// Frame pacing: vsync by default; --no-vsync renders uncapped, --fps N caps at N
+// Idle: static screens redraw only what changed and sleep between events; --always-redraw to compare
+// Assets: ./assetc build assets/assets.pak assets assets/DejaVuSans.ttf assets/audio/* (optional;
+//         loose files otherwise); --sync-assets loads audio before the first frame, to compare
+// Live level: --level FILE plays a text level (or a pack's first) and reloads it whenever it is saved
+// Save-states: F5 save, F9 load, hold Backspace to rewind (in game)
+// Autopilot: F6 toggles tree-search steering (in game); --autopilot starts with it on
+// Tracing: F3 perf overlay, F4 writes the trace ring to --trace FILE (default pacman_trace.json)
+
+#include "sim.h"
+#include "headless.h"
+#include "assetpack.h"
+#include "channel.h"
+#include "graph.h"
+#include "levelpack.h"
+#include "levelwatch.h"
+#include "mcts.h"
+#include "nav.h"
+#include "pool.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "text.h"
+#include "telemetry.h"
+#include "trace.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_mixer.h>
@@ -11,258 +40,327 @@
 #include <string.h>
 
 #define TILE 20
-#define MAP_W 28
-#define MAP_H 31
 #define SCREEN_W (MAP_W*TILE)
 #define SCREEN_H (MAP_H*TILE)
 
-#define FPS 60
-#define STEP_MS 110          // Pac-Man step timing
-#define GHOST_MS 110         // Ghost step timing
-#define FRIGHT_MS 6000       // frightened mode duration
-
-typedef enum { MODE_SCATTER, MODE_CHASE, MODE_FRIGHT } GhostMode;
-typedef enum { RED=0, PINK=1, BLUE=2, ORANGE=3 } GhostId;
+#define FALLBACK_HZ 60    // frame cap when vsync is off and the display rate is unknown
 
 // New: simple scene management
 typedef enum { STATE_MAIN_MENU, STATE_CONTROLS, STATE_CREDITS, STATE_PLAYING } GameState;
 
-typedef struct { int x,y; int dx,dy; int startx,starty; } Entity;
-typedef struct { Entity e; GhostMode mode; Uint32 fright_timer; } Ghost;
+// ===== Assets =====
+// Everything under assets/ is packed into assets/assets.pak (tools/assetc.c), mapped
+// once and handed to SDL as read-only memory streams, so decoders read straight from
+// the mapping. Without an archive the loose files are opened instead.
+#define ASSET_DIR "assets/"
+#define ASSET_PACK_PATH ASSET_DIR "assets.pak"
+#define FONT_ASSET "DejaVuSans.ttf"
+static AssetPack* asset_pack = NULL;
+static Uint64 start_counter;            // process start, for time-to-first-frame
+
+static double ms_since_start(void){
+    return (double)(SDL_GetPerformanceCounter() - start_counter) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void assets_open(void){
+    char err[256];
+    asset_pack = assetpack_open(ASSET_PACK_PATH, err, sizeof err);
+    if(!asset_pack) SDL_Log("No asset archive, loading loose files: %s", err);
+}
+
+// Stream over the named asset; the caller's loader frees it (freesrc). NULL if absent.
+static SDL_RWops* asset_rw(const char* name){
+    size_t size;
+    const void* data = assetpack_find(asset_pack, name, &size);
+    if(data) return SDL_RWFromConstMem(data, (int)size);
+    char path[256];
+    SDL_snprintf(path, sizeof path, ASSET_DIR "%s", name);
+    return SDL_RWFromFile(path, "rb");
+}
 
 // ===== Audio state =====
-typedef enum { MS_NONE, MS_MENU, MS_GAME, MS_PAUSE, MS_VICTORY } MusicState;
-static MusicState mus_state = MS_NONE;
-
-static Mix_Music* mus_menu = NULL;     // Juhani Junkala — "Title Screen"
-static Mix_Music* mus_game = NULL;     // FREE Action Chiptune Music Pack (choose one)
-static Mix_Music* mus_pause = NULL;    // JRPG Pack 4 Calm — "Innocence"
-static Mix_Music* mus_victory = NULL;  // Juhani Junkala — "Ending"
-static Mix_Chunk* sfx_death = NULL;    // Short blip
-
-static void audio_play(Mix_Music* m, int loops){
-    if(!m) return;
-    Mix_HaltMusic();
-    Mix_PlayMusic(m, loops);
-}
-static void play_menu_music(void){ if(mus_state!=MS_MENU){ audio_play(mus_menu, -1); mus_state=MS_MENU; } }
-static void play_game_music(void){ if(mus_state!=MS_GAME){ audio_play(mus_game, -1); mus_state=MS_GAME; } }
-static void play_pause_music(void){ if(mus_state!=MS_PAUSE){ audio_play(mus_pause, -1); mus_state=MS_PAUSE; } }
-static void play_victory_music(void){ if(mus_state!=MS_VICTORY){ audio_play(mus_victory, -1); mus_state=MS_VICTORY; } }
-static void audio_stop(void){ Mix_HaltMusic(); mus_state = MS_NONE; }
-
-// Asset paths (place files under assets/audio/)
-#define PATH_MENU    "assets/audio/menu_title.wav"
-#define PATH_GAME    "assets/audio/gameplay_action.mp3"   // pick one: e.g., "leaving home"
-#define PATH_PAUSE   "assets/audio/pause_innocence.ogg"
-#define PATH_VICTORY "assets/audio/victory_ending.wav"
-#define PATH_DEATH   "assets/audio/sfx_death.ogg"
-
-static bool audio_init(void){
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) != 0){
+// Music streams one track at a time. Switching stops the current track where it is
+// and fades the next one in from where it last stopped, so toggling the pause menu
+// resumes both instead of restarting them (victory always starts from the top).
+// Effects are Mix_Chunks: SDL_mixer decodes and converts them to the device format
+// once at load, so a trigger only queues PCM already in memory and waits for the next
+// mixer pass. The device buffer (--audio-buffer N sample frames) bounds that wait.
+#define AUDIO_BUFFER 512        // sample frames; 11.6 ms at 44.1 kHz (was 1024)
+#define AUDIO_CHANNELS 16
+#define MUSIC_FADE_MS 30        // fade-in on a switch, so a resumed track does not click
+
+typedef enum { MS_NONE, MS_MENU, MS_GAME, MS_PAUSE, MS_VICTORY, MS_COUNT } MusicState;
+static MusicState mus_state = MS_NONE;  // wanted track; kept while audio is still loading
+static MusicState mus_playing = MS_NONE;
+static int audio_buffer = AUDIO_BUFFER;
+static bool audio_open = false;        // device open and the assets below adopted
+
+typedef struct {
+    Mix_Music* mus;
+    bool resume;                // continue where it stopped rather than from the top
+    double pos;                 // seconds into the track when it last stopped or started
+    Uint64 started;             // performance counter when it last started from pos
+} Track;
+static Track tracks[MS_COUNT] = { [MS_MENU]={.resume=true}, [MS_GAME]={.resume=true}, [MS_PAUSE]={.resume=true} };
+
+// Asset names (below assets/)
+static const char* const MUSIC_PATHS[MS_COUNT] = {
+    [MS_MENU]    = "audio/menu_title.wav",          // Juhani Junkala — "Title Screen"
+    [MS_GAME]    = "audio/gameplay_action.mp3",     // FREE Action Chiptune Music Pack (pick one, e.g. "leaving home")
+    [MS_PAUSE]   = "audio/pause_innocence.ogg",     // JRPG Pack 4 Calm — "Innocence"
+    [MS_VICTORY] = "audio/victory_ending.wav",      // Juhani Junkala — "Ending"
+};
+static const char* const MUSIC_NAMES[MS_COUNT] = { "", "menu", "game", "pause", "victory" };
+
+typedef enum { SFX_DEATH, SFX_CHOMP, SFX_GHOST_EATEN, SFX_COUNT } Sfx;
+static const char* const SFX_PATHS[SFX_COUNT] = { "audio/sfx_death.ogg", "audio/sfx_chomp.ogg", "audio/sfx_ghost_eaten.ogg" };
+static const char* const SFX_NAMES[SFX_COUNT] = { "death", "chomp", "ghost eaten" };
+static Mix_Chunk* sfx[SFX_COUNT];
+
+// Track positions: SDL_mixer 2.6 reports them (and the length, to wrap a looping
+// track); older versions get the time since the track started.
+#if defined(SDL_MIXER_VERSION_ATLEAST)
+#if SDL_MIXER_VERSION_ATLEAST(2,6,0)
+#define HAVE_MUSIC_POSITION 1
+#endif
+#endif
+
+static double music_position(const Track* t){
+    double pos = t->pos + (double)(SDL_GetPerformanceCounter() - t->started) / (double)SDL_GetPerformanceFrequency();
+#ifdef HAVE_MUSIC_POSITION
+    double at = Mix_GetMusicPosition(t->mus), len = Mix_MusicDuration(t->mus);
+    if(at >= 0) pos = at;
+    if(len > 0) pos -= len * (double)(long)(pos / len);
+#endif
+    return pos;
+}
+
+// Music switches, for the exit log: time spent in audio_play() on the main thread.
+static long mus_switches = 0;
+static double mus_switch_ms = 0, mus_switch_max_ms = 0;
+
+static void audio_play(MusicState s){
+    Track* next = &tracks[s];
+    if(!next->mus) return;              // missing track: whatever plays keeps playing
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    if(mus_playing != MS_NONE){
+        Track* cur = &tracks[mus_playing];
+        cur->pos = cur->resume ? music_position(cur) : 0;
+        Mix_HaltMusic();
+    }
+    double from = next->resume ? next->pos : 0;
+    if(Mix_FadeInMusicPos(next->mus, -1, MUSIC_FADE_MS, from) != 0 && from > 0){
+        from = 0;                       // no seeking in this format
+        Mix_FadeInMusicPos(next->mus, -1, MUSIC_FADE_MS, 0);
+    }
+    next->pos = from; next->started = SDL_GetPerformanceCounter();
+    mus_playing = s;
+    double ms = (double)(next->started - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    mus_switches++; mus_switch_ms += ms;
+    if(ms > mus_switch_max_ms) mus_switch_max_ms = ms;
+}
+static void play_music(MusicState s){ if(mus_state!=s){ audio_play(s); mus_state=s; } }
+static void play_menu_music(void){ play_music(MS_MENU); }
+static void play_game_music(void){ play_music(MS_GAME); }
+static void play_pause_music(void){ play_music(MS_PAUSE); }
+static void play_victory_music(void){ play_music(MS_VICTORY); }
+static void audio_stop(void){ if(audio_open) Mix_HaltMusic(); mus_state = mus_playing = MS_NONE; }
+
+// Trigger-to-output latency of effects. sfx_play() stamps the channel it starts and
+// registers a mixer effect on it (SDL_mixer drops a channel's effects when it stops);
+// the audio thread runs that when the channel is first mixed, turns the stamp into
+// milliseconds and queues them. That is trigger-to-mix;
+// the mixed buffer then plays out through the device buffer, which is added to each
+// sample. audio_poll() drains the queue into lat_sfx.
+static _Atomic uint64_t sfx_armed[AUDIO_CHANNELS];
+static SpscQueue sfx_lat_queue;
+static bool sfx_measure = false;
+static Uint32 audio_buffer_ms = 0;      // one device buffer at the opened rate
+static TraceLatency lat_sfx;
+static long sfx_played = 0, sfx_dropped = 0;
+
+static void sfx_mixed(int chan, void* stream, int len, void* udata){
+    (void)stream; (void)len; (void)udata;
+    // Stamped before Mix_PlayChannel(), which takes the audio lock this runs under.
+    uint64_t t = atomic_exchange_explicit(&sfx_armed[chan], 0, memory_order_relaxed);
+    if(!t) return;
+    Uint32 ms = (Uint32)((SDL_GetPerformanceCounter() - t) * 1000 / SDL_GetPerformanceFrequency()) + audio_buffer_ms;
+    spsc_push(&sfx_lat_queue, &ms);     // dropped if the main thread is that far behind
+}
+
+static void sfx_play(Sfx id){
+    if(!audio_open || !sfx[id]) return;
+    int ch = Mix_GroupAvailable(-1);
+    if(ch < 0 || ch >= AUDIO_CHANNELS){ sfx_dropped++; return; }
+    bool measure = sfx_measure && Mix_RegisterEffect(ch, sfx_mixed, NULL, NULL);
+    if(measure) atomic_store_explicit(&sfx_armed[ch], SDL_GetPerformanceCounter(), memory_order_relaxed);
+    if(Mix_PlayChannel(ch, sfx[id], 0) < 0){
+        if(measure){ atomic_store(&sfx_armed[ch], 0); Mix_UnregisterEffect(ch, sfx_mixed); }
+        sfx_dropped++; return;
+    }
+    sfx_played++;
+}
+
+static void sfx_drain(void){
+    Uint32 ms;
+    while(sfx_measure && spsc_pop(&sfx_lat_queue, &ms)) trace_latency_add(&lat_sfx, ms);
+}
+
+// ===== Idle wake-ups =====
+// While a static screen is up the main loop sleeps in SDL_WaitEvent (see Idle
+// rendering); threads that produce something for it to show push wake_event then.
+static atomic_bool idle_waiting;
+static Uint32 wake_event = (Uint32)-1;
+
+static void wake_main(void){
+    atomic_thread_fence(memory_order_seq_cst);      // pairs with the fence in idle_wait()
+    if(!atomic_load_explicit(&idle_waiting, memory_order_relaxed) || wake_event==(Uint32)-1) return;
+    SDL_Event e; SDL_zero(e); e.type = wake_event;
+    SDL_PushEvent(&e);
+}
+
+// Opening the device and decoding the effects take long enough to hold up the first
+// frame, so they run on a loader thread. It fills `loaded` only; the main thread
+// picks the results up in audio_poll() once `ready` is set and owns them from then on.
+typedef struct { bool opened; Mix_Music* music[MS_COUNT]; Mix_Chunk* sfx[SFX_COUNT]; } AudioAssets;
+static AudioAssets audio_loaded;
+static SDL_atomic_t audio_ready;
+static SDL_Thread* audio_thread = NULL;
+
+static int audio_load(void* unused){
+    (void)unused;
+    AudioAssets* a = &audio_loaded;
+    if(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, audio_buffer) != 0){
         SDL_Log("Mix_OpenAudio failed: %s", Mix_GetError());
-        return false;
+        SDL_AtomicSet(&audio_ready, 1);
+        wake_main();
+        return 0;
     }
-    Mix_AllocateChannels(16);
+    Mix_AllocateChannels(AUDIO_CHANNELS);
+    a->opened = true;
 
-    mus_menu   = Mix_LoadMUS(PATH_MENU);
-    mus_game   = Mix_LoadMUS(PATH_GAME);
-    mus_pause  = Mix_LoadMUS(PATH_PAUSE);
-    mus_victory= Mix_LoadMUS(PATH_VICTORY);
-    sfx_death  = Mix_LoadWAV(PATH_DEATH);
+    for(int s=MS_MENU;s<MS_COUNT;s++){
+        a->music[s] = Mix_LoadMUS_RW(asset_rw(MUSIC_PATHS[s]), 1);
+        if(!a->music[s]) SDL_Log("Load music (%s) failed: %s", MUSIC_NAMES[s], Mix_GetError());
+    }
+    for(int i=0;i<SFX_COUNT;i++){
+        a->sfx[i] = Mix_LoadWAV_RW(asset_rw(SFX_PATHS[i]), 1);     // decoded to device-format PCM here
+        if(!a->sfx[i]) SDL_Log("Load sfx (%s) failed: %s", SFX_NAMES[i], Mix_GetError());
+    }
+    SDL_AtomicSet(&audio_ready, 1);
+    wake_main();
+    return 0;
+}
 
-    if(!mus_menu)   SDL_Log("Load music (menu) failed: %s", Mix_GetError());
-    if(!mus_game)   SDL_Log("Load music (game) failed: %s", Mix_GetError());
-    if(!mus_pause)  SDL_Log("Load music (pause) failed: %s", Mix_GetError());
-    if(!mus_victory)SDL_Log("Load music (victory) failed: %s", Mix_GetError());
-    if(!sfx_death)  SDL_Log("Load sfx (death) failed: %s", Mix_GetError());
+// Start loading; with async false it finishes before returning (the old startup order).
+static void audio_init(bool async){
+    if(audio_buffer < 64 || audio_buffer > 8192) audio_buffer = AUDIO_BUFFER;
+    if(async) audio_thread = SDL_CreateThread(audio_load, "audio_load", NULL);
+    if(!audio_thread){
+        if(async) SDL_Log("Audio loader thread failed, loading inline: %s", SDL_GetError());
+        audio_load(NULL);
+    }
+}
 
-    // Start on menu track by default
-    if(mus_menu) play_menu_music();
-    return true;
+// Adopt the loader's results once it is done and start whatever track is wanted by
+// now; afterwards collect effect latency samples.
+static void audio_poll(void){
+    if(audio_open){ sfx_drain(); return; }
+    if(!SDL_AtomicGet(&audio_ready)) return;
+    if(audio_thread){ SDL_WaitThread(audio_thread, NULL); audio_thread = NULL; }
+    SDL_AtomicSet(&audio_ready, 0);
+    AudioAssets* a = &audio_loaded;
+    if(!a->opened) return;
+    for(int s=MS_MENU;s<MS_COUNT;s++) tracks[s].mus = a->music[s];
+    for(int i=0;i<SFX_COUNT;i++) sfx[i] = a->sfx[i];
+    audio_open = true;
+
+    int freq = 0, chans = 0; Uint16 fmt = 0;
+    if(Mix_QuerySpec(&freq, &fmt, &chans) && freq > 0) audio_buffer_ms = (Uint32)((audio_buffer*1000 + freq/2) / freq);
+    sfx_measure = spsc_init(&sfx_lat_queue, 256, sizeof(Uint32));
+    SDL_Log("Audio ready %.1f ms after start (%d Hz, %d-frame buffer = %u ms)", ms_since_start(), freq, audio_buffer, audio_buffer_ms);
+    MusicState want = mus_state;
+    mus_state = MS_NONE;
+    if(want != MS_NONE) play_music(want);
 }
 
 static void audio_quit(void){
+    if(audio_thread){ SDL_WaitThread(audio_thread, NULL); audio_thread = NULL; }
+    mus_state = MS_NONE;                // adopt a late loader's tracks only to free them
+    audio_poll();
     audio_stop();
-    if(mus_menu){ Mix_FreeMusic(mus_menu); mus_menu=NULL; }
-    if(mus_game){ Mix_FreeMusic(mus_game); mus_game=NULL; }
-    if(mus_pause){ Mix_FreeMusic(mus_pause); mus_pause=NULL; }
-    if(mus_victory){ Mix_FreeMusic(mus_victory); mus_victory=NULL; }
-    if(sfx_death){ Mix_FreeChunk(sfx_death); sfx_death=NULL; }
-    Mix_CloseAudio();
-}
-
-// ===== Level map =====
-static const char* LEVEL0[MAP_H] = {
-    "############################",
-    "#............##............#",
-    "#.####.#####.##.#####.####.#",
-    "#o####.#####.##.#####.####o#",
-    "#.####.#####.##.#####.####.#",
-    "#..........................#",
-    "#.####.##.########.##.####.#",
-    "#.####.##.########.##.####.#",
-    "#......##....##....##......#",
-    "######.##### ## #####.######",
-    "     #.##### ## #####.#     ",
-    "     #.##          ##.#     ",
-    "     #.## ###HH### ##.#     ",
-    "######.## #      # ##.######",
-    "      .   #  GG  #   .      ",
-    "######.## #      # ##.######",
-    "     #.## ######## ##.#     ",
-    "     #.##          ##.#     ",
-    "     #.## ######## ##.#     ",
-    "######.## ######## ##.######",
-    "#............##............#",
-    "#.####.#####.##.#####.####.#",
-    "#o..##................##..o#",
-    "###.##.##.########.##.##.###",
-    "#......##....##....##......#",
-    "#.##########.##.##########.#",
-    "#..........................#",
-    "############################",
-    "############################",
-    "############################",
-    "############################"
-};
+    if(audio_open){ Mix_HaltChannel(-1); Mix_CloseAudio(); }   // stops the mixer and its effects
+    for(int s=MS_MENU;s<MS_COUNT;s++) if(tracks[s].mus){ Mix_FreeMusic(tracks[s].mus); tracks[s].mus=NULL; }
+    for(int i=0;i<SFX_COUNT;i++) if(sfx[i]){ Mix_FreeChunk(sfx[i]); sfx[i]=NULL; }
+    if(sfx_measure){ spsc_free(&sfx_lat_queue); sfx_measure = false; }
+    audio_open = false;
+}
 
-static char board[MAP_H][MAP_W];
-
-// ===== Helpers =====
-static inline bool in_bounds(int x,int y){ return x>=0 && x<MAP_W && y>=0 && y<MAP_H; }
-static inline bool is_wall_at(int x,int y){ if(!in_bounds(x,y)) return true; return board[y][x]=='#'; }
-static inline bool is_gate_at(int x,int y){ return in_bounds(x,y) && board[y][x]=='H'; }
-
-static void reset_board(void){ for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) board[y][x]=LEVEL0[y][x]; }
-
-static void wrap(Entity* e){ if(e->x<0) e->x=MAP_W-1; else if(e->x>=MAP_W) e->x=0; }
-
-static bool passable_for_ghost(int x,int y){ if(!in_bounds(x,y)) return true; return board[y][x] != '#'; }
-static bool passable_for_pac(int x,int y){ if(!in_bounds(x,y)) return true; char c=board[y][x]; if(c=='#'||c=='H') return false; return true; }
-
-typedef struct { int x,y; } Point;
-
-static Point next_step_bfs(Point src, Point dst, bool (*passable)(int,int)){
-    static int qx[MAP_W*MAP_H], qy[MAP_W*MAP_H];
-    static short px[MAP_W][MAP_H], py[MAP_W][MAP_H];
-    static unsigned char vis[MAP_W][MAP_H];
-    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){ vis[x][y]=0; px[x][y]=-1; py[x][y]=-1; }
-    int head=0, tail=0;
-    qx[tail]=src.x; qy[tail]=src.y; tail++; vis[src.x][src.y]=1;
-    const int dirs[4][2]={{1,0},{-1,0},{0,1},{0,-1}};
-    while(head<tail){
-        int x=qx[head], y=qy[head]; head++;
-        if(x==dst.x && y==dst.y) break;
-        for(int i=0;i<4;i++){
-            int nx=x+dirs[i][0], ny=y+dirs[i][1];
-            if(!in_bounds(nx,ny) && !(nx<0||nx>=MAP_W)) continue;
-            if(nx<0||nx>=MAP_W){
-                int wx=(nx<0)?MAP_W-1:0;
-                if(!passable(wx,ny) || vis[wx][ny]) continue;
-                vis[wx][ny]=1; px[wx][ny]=x; py[wx][ny]=y; qx[tail]=wx; qy[tail]=ny; tail++;
-            }else{
-                if(!passable(nx,ny) || vis[nx][ny]) continue;
-                vis[nx][ny]=1; px[nx][ny]=x; py[nx][ny]=y; qx[tail]=nx; qy[tail]=ny; tail++;
-            }
-        }
-    }
-    int tx=dst.x, ty=dst.y;
-    if(tx<0||tx>=MAP_W||ty<0||ty>=MAP_H) return src;
-    if(!vis[tx][ty]) return src;
-    while(!(px[tx][ty]==src.x && py[tx][ty]==src.y)){ int ntx=px[tx][ty], nty=py[tx][ty]; if(ntx==-1) break; tx=ntx; ty=nty; }
-    Point step={tx,ty}; return step;
-}
-
-// Deterministic steering toward a target with tie-break U,L,D,R and anti-reverse
-static void choose_dir_toward(Entity* e, Point tgt, bool (*pass)(int,int)) {
-    const int DIRS[4][2] = { {0,-1}, {-1,0}, {0,1}, {1,0} }; // U, L, D, R
-    int revx = -e->dx, revy = -e->dy;
-
-    int viable = 0;
-    for (int i = 0; i < 4; i++) {
-        int ndx = DIRS[i][0], ndy = DIRS[i][1];
-        if (ndx == revx && ndy == revy) continue;
-        int nx = e->x + ndx, ny = e->y + ndy;
-        if (pass(nx, ny)) viable++;
-    }
-    if (viable == 0) {
-        int nx = e->x + revx, ny = e->y + revy;
-        if (pass(nx, ny)) { e->dx = revx; e->dy = revy; }
-        return;
-    }
-    int best_i = -1, best_d = 1<<30;
-    for (int i = 0; i < 4; i++) {
-        int ndx = DIRS[i][0], ndy = DIRS[i][1];
-        if (ndx == revx && ndy == revy) continue;
-        int nx = e->x + ndx, ny = e->y + ndy;
-        if (!pass(nx, ny)) continue;
-        int d = abs(nx - tgt.x) + abs(ny - tgt.y);
-        if (d < best_d) { best_d = d; best_i = i; }
-    }
-    if (best_i >= 0) { e->dx = DIRS[best_i][0]; e->dy = DIRS[best_i][1]; }
-}
-
-static Point pac_ahead(Entity pac, int tiles){
-    Point p={pac.x+pac.dx*tiles, pac.y+pac.dy*tiles};
-    if(p.x<0)p.x=MAP_W-1; if(p.x>=MAP_W)p.x=0; return p;
-}
-
-// Classic targets: all ghosts scatter/chase per schedule; frightened ignores target.
-static Point ghost_target(GhostId id, Entity pac, Ghost ghosts[4]){
-    Ghost* g = &ghosts[id];
-    if (g->mode == MODE_FRIGHT) return (Point){ g->e.x, g->e.y };
-    Point corners[4]={{MAP_W-2,0},{1,0},{MAP_W-2,MAP_H-2},{1,MAP_H-2}};
-    if (g->mode == MODE_SCATTER) return corners[id];
-
-    // MODE_CHASE
-    if (id == RED) { // Blinky
-        return (Point){ pac.x, pac.y };
-    } else if (id == PINK) { // Pinky
-        Point a = pac_ahead(pac, 4); return a;
-    } else if (id == BLUE) { // Inky
-        Point p2 = pac_ahead(pac, 2);
-        int vx = p2.x - ghosts[RED].e.x, vy = p2.y - ghosts[RED].e.y;
-        return (Point){ p2.x + vx, p2.y + vy };
-    } else { // ORANGE (Clyde)
-        int dx = pac.x - g->e.x, dy = pac.y - g->e.y;
-        int dist2 = dx*dx + dy*dy;
-        if (dist2 >= 64) return (Point){ pac.x, pac.y };
-        return corners[ORANGE];
+// Main thread, at exit.
+static void audio_log(void){
+    if(lat_sfx.n){
+        char line[128];
+        trace_latency_line(&lat_sfx, line, sizeof line);
+        SDL_Log("Effect trigger to output (%u ms device buffer included): %s", audio_buffer_ms, line);
     }
+    if(sfx_dropped) SDL_Log("Effects: %ld played, %ld dropped with every channel busy", sfx_played, sfx_dropped);
+    if(mus_switches) SDL_Log("Music switches: %ld, mean %.2f ms, max %.2f ms on the main thread",
+                             mus_switches, mus_switch_ms/mus_switches, mus_switch_max_ms);
 }
 
 // ===== Text helpers =====
+// Text goes through the glyph atlas (text.c) once it exists; the direct TTF path is
+// only used before the renderer is up or with --legacy-text, for comparison.
+static TextSys* text_sys = NULL;
+static int tex_allocs_frame = 0;    // textures created this frame (perf stats overlay)
+
 static void draw_text(SDL_Renderer* r, TTF_Font* font, const char* msg, int x, int y, SDL_Color color){
+    TRACE_COUNT(TC_DRAW, 1);
+    if (text_sys){ text_draw(text_sys, msg, x, y, color); return; }
     if (!font || !msg) return;
     SDL_Surface* surf = TTF_RenderUTF8_Blended(font, msg, color);
     if(!surf) return;
     SDL_Texture* tex = SDL_CreateTextureFromSurface(r, surf);
+    tex_allocs_frame++;
     SDL_Rect dst = { x, y, surf->w, surf->h };
     SDL_FreeSurface(surf);
     if(tex){ SDL_RenderCopy(r, tex, NULL, &dst); SDL_DestroyTexture(tex); }
 }
 
 static void draw_text_center(SDL_Renderer* r, TTF_Font* font, const char* msg, int cx, int y, SDL_Color color){
-    if(!font || !msg) return;
-    int w=0,h=0; TTF_SizeUTF8(font, msg, &w, &h);
+    if(!msg || (!font && !text_sys)) return;
+    int w=0,h=0;
+    if(text_sys) w = text_width(text_sys, msg);
+    else TTF_SizeUTF8(font, msg, &w, &h);
     draw_text(r, font, msg, cx - w/2, y, color);
 }
 
 static void draw_rect(SDL_Renderer*r,int x,int y,int w,int h, SDL_Color c){
     SDL_SetRenderDrawColor(r,c.r,c.g,c.b,c.a);
     SDL_Rect rc={x,y,w,h}; SDL_RenderFillRect(r,&rc);
+    TRACE_COUNT(TC_DRAW, 1);
+}
+
+// Black background. Unlike SDL_RenderClear this keeps to the clip rect, so a damaged
+// region can be redrawn on its own.
+static void clear_frame(SDL_Renderer* r){
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(r, 0, 0, 0, 255);
+    SDL_RenderFillRect(r, NULL);
 }
 
 // ===== ESC pause menu state =====
 static bool esc_menu = false;
 static int esc_sel = 0; // 0=Resume, 1=Retry, 2=Main Menu
 
+// Panel and item rows, shared with the idle redraw (which repaints single rows).
+static SDL_Rect esc_panel(void){ return (SDL_Rect){ SCREEN_W/2-180, SCREEN_H/2-130, 360, 260 }; }
+static SDL_Rect esc_row(int i){ SDL_Rect p = esc_panel(); return (SDL_Rect){ p.x, p.y+66+i*40, p.w, 40 }; }
+
 static void render_esc_menu(SDL_Renderer* r, TTF_Font* font){
     SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
-    int panel_w = 360, panel_h = 260;
-    int px = SCREEN_W/2 - panel_w/2;
-    int py = SCREEN_H/2 - panel_h/2;
+    SDL_Rect p = esc_panel();
+    int panel_w = p.w, panel_h = p.h, px = p.x, py = p.y;
     draw_rect(r, px, py, panel_w, panel_h, (SDL_Color){0,0,0,180});
 
     draw_text(r, font, "Paused", px + 130, py + 20, (SDL_Color){255,255,255,255});
@@ -288,19 +386,21 @@ static const char* MAIN_ITEMS[] = {
 static const int MAIN_COUNT = 5;
 static Uint32 locked_msg_until = 0; // toast timer for locked level
 
+static SDL_Rect main_panel(void){ return (SDL_Rect){ SCREEN_W/2-210, SCREEN_H/2-160, 420, 320 }; }
+static SDL_Rect main_row(int i){ SDL_Rect p = main_panel(); return (SDL_Rect){ p.x, p.y+66+i*40, p.w, 40 }; }
+static SDL_Rect main_locked_rect(void){ return (SDL_Rect){ SCREEN_W/2-170, main_panel().y-50, 340, 36 }; }
+
 static void render_main_menu(SDL_Renderer* r, TTF_Font* font){
-    SDL_SetRenderDrawColor(r, 0, 0, 0, 255);
-    SDL_RenderClear(r);
+    clear_frame(r);
 
     // Title
     draw_text_center(r, font, "PAC-MAN", SCREEN_W/2, 60, (SDL_Color){255,255,0,255});
 
     // Menu panel
     SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
-    int panel_w = 420, panel_h = 320;
-    int px = SCREEN_W/2 - panel_w/2;
-    int py = SCREEN_H/2 - panel_h/2;
-    draw_rect(r, px, py, panel_w, panel_h, (SDL_Color){0,0,0,160});
+    SDL_Rect p = main_panel();
+    int panel_h = p.h, px = p.x, py = p.y;
+    draw_rect(r, px, py, p.w, panel_h, (SDL_Color){0,0,0,160});
 
     // Items
     for(int i=0;i<MAIN_COUNT;i++){
@@ -314,17 +414,16 @@ static void render_main_menu(SDL_Renderer* r, TTF_Font* font){
     // Locked toast
     Uint32 now = SDL_GetTicks();
     if(locked_msg_until && now < locked_msg_until){
-        draw_rect(r, SCREEN_W/2-170, py-50, 340, 36, (SDL_Color){0,0,0,180});
-        draw_text_center(r, font, "Locked — Coming Soon", SCREEN_W/2, py-44, (SDL_Color){255,100,100,255});
+        SDL_Rect t = main_locked_rect();
+        draw_rect(r, t.x, t.y, t.w, t.h, (SDL_Color){0,0,0,180});
+        draw_text_center(r, font, "Locked — no level pack", SCREEN_W/2, py-44, (SDL_Color){255,100,100,255});
     }
 
     SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
-    SDL_RenderPresent(r);
 }
 
 static void render_controls_screen(SDL_Renderer* r, TTF_Font* font){
-    SDL_SetRenderDrawColor(r, 0, 0, 0, 255);
-    SDL_RenderClear(r);
+    clear_frame(r);
 
     draw_text_center(r, font, "Controls", SCREEN_W/2, 60, (SDL_Color){255,255,255,255});
     int y = 130;
@@ -335,15 +434,16 @@ static void render_controls_screen(SDL_Renderer* r, TTF_Font* font){
     draw_text_center(r, font, "Select/Confirm: Enter or Space", SCREEN_W/2, y, (SDL_Color){200,200,200,255});
     y += 40;
     draw_text_center(r, font, "Retry: R (from pause/end)", SCREEN_W/2, y, (SDL_Color){200,200,200,255});
+    y += 40;
+    draw_text_center(r, font, "Save/Load state: F5 / F9 • Rewind: hold Backspace", SCREEN_W/2, y, (SDL_Color){200,200,200,255});
+    y += 40;
+    draw_text_center(r, font, "Autopilot: F6", SCREEN_W/2, y, (SDL_Color){200,200,200,255});
     y += 60;
     draw_text_center(r, font, "Press ESC to go back", SCREEN_W/2, y, (SDL_Color){255,215,0,255});
-
-    SDL_RenderPresent(r);
 }
 
 static void render_credits_screen(SDL_Renderer* r, TTF_Font* font){
-    SDL_SetRenderDrawColor(r, 0, 0, 0, 255);
-    SDL_RenderClear(r);
+    clear_frame(r);
 
     // Make "Made by pradnesh" pop
     draw_text_center(r, font, "Credits", SCREEN_W/2, 60, (SDL_Color){255,255,255,255});
@@ -361,28 +461,343 @@ static void render_credits_screen(SDL_Renderer* r, TTF_Font* font){
     draw_text_center(r, font, "Victory: \"Ending\" — Juhani Junkala (Retro Game Music Pack)", SCREEN_W/2, y, (SDL_Color){200,200,200,255}); y += 40;
 
     draw_text_center(r, font, "Press ESC to go back", SCREEN_W/2, y, (SDL_Color){255,215,0,255});
+}
+
+// ===== Board layers =====
+// Walls and gate change only when a level is swapped or reloaded, and pellets only
+// disappear one tile at a time, so both are kept in render-target textures: each layer
+// is patched on the tiles whose contents changed, and baked again only for a new maze.
+// Each frame is then two texture copies instead of ~900 fill calls.
+static SDL_Texture* maze_layer = NULL;     // walls + gate, opaque
+static SDL_Texture* pellet_layer = NULL;   // pellets on a transparent background
+static char layer_board[MAP_H][MAP_W];     // board contents the layers currently show
+static bool layers_valid = false;
+static bool layers_off = false;            // could not be created (until a device reset)
+
+static bool is_static_tile(char c){ return c=='#' || c=='H'; }
+
+static void draw_static_tile(SDL_Renderer* r, int x, int y, char c){
+    if(c=='#') draw_rect(r,x*TILE,y*TILE,TILE,TILE,(SDL_Color){0,0,160,255});
+    else if(c=='H') draw_rect(r,x*TILE,y*TILE,TILE,4,(SDL_Color){80,80,80,255});
+}
 
-    SDL_RenderPresent(r);
+static void draw_pellet_tile(SDL_Renderer* r, int x, int y, char c){
+    if(c=='.') draw_rect(r,x*TILE+TILE/2-2,y*TILE+TILE/2-2,4,4,(SDL_Color){255,215,0,255});
+    else if(c=='o') draw_rect(r,x*TILE+TILE/2-5,y*TILE+TILE/2-5,10,10,(SDL_Color){255,255,255,255});
 }
 
-// ===== Game rendering (unchanged visuals) =====
-static void render_game(SDL_Renderer*r, Entity pac, Ghost ghosts[4], int score, int lives, bool game_won, bool over, bool paused, TTF_Font* font){
+static void layers_destroy(void){
+    if(maze_layer){ SDL_DestroyTexture(maze_layer); maze_layer=NULL; }
+    if(pellet_layer){ SDL_DestroyTexture(pellet_layer); pellet_layer=NULL; }
+    layers_valid = false;
+}
+
+static bool layers_bake(SDL_Renderer* r, const Game* gm){
+    if(!maze_layer){
+        maze_layer = SDL_CreateTexture(r, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, SCREEN_W, SCREEN_H);
+        pellet_layer = SDL_CreateTexture(r, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, SCREEN_W, SCREEN_H);
+        tex_allocs_frame += 2;
+        if(!maze_layer || !pellet_layer){
+            SDL_Log("Board layers unavailable, drawing tiles directly: %s", SDL_GetError());
+            layers_destroy(); layers_off = true;
+            return false;
+        }
+        SDL_SetTextureBlendMode(maze_layer, SDL_BLENDMODE_NONE);
+        SDL_SetTextureBlendMode(pellet_layer, SDL_BLENDMODE_BLEND);
+    }
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+    SDL_SetRenderTarget(r, maze_layer);
     SDL_SetRenderDrawColor(r,0,0,0,255); SDL_RenderClear(r);
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) draw_static_tile(r,x,y,gm->board[y][x]);
+    SDL_SetRenderTarget(r, pellet_layer);
+    SDL_SetRenderDrawColor(r,0,0,0,0); SDL_RenderClear(r);
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) draw_pellet_tile(r,x,y,gm->board[y][x]);
+    SDL_SetRenderTarget(r, NULL);
+    memcpy(layer_board, gm->board, sizeof layer_board);
+    layers_valid = true;
+    return true;
+}
+
+// Bring the layers up to date with the board; false means draw tiles directly instead.
+static bool layers_sync(SDL_Renderer* r, const Game* gm){
+    if(layers_off) return false;
+    if(!layers_valid) return layers_bake(r, gm);
+    if(memcmp(layer_board, gm->board, sizeof layer_board)==0) return true;
+    int changed = 0, walls = 0;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        char was=layer_board[y][x], now=gm->board[y][x];
+        if(was!=now){ changed++; walls += is_static_tile(was) || is_static_tile(now); }
+    }
+    if(changed > MAP_W*MAP_H/4) return layers_bake(r, gm);     // a new maze
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+    if(walls){                                                  // an edited one
+        SDL_SetRenderTarget(r, maze_layer);
+        for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+            char was=layer_board[y][x], now=gm->board[y][x];
+            if(was==now || !(is_static_tile(was) || is_static_tile(now))) continue;
+            draw_rect(r,x*TILE,y*TILE,TILE,TILE,(SDL_Color){0,0,0,255});
+            draw_static_tile(r,x,y,now);
+        }
+    }
+    SDL_SetRenderTarget(r, pellet_layer);
     for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
-        char c=board[y][x];
-        if(c=='#') draw_rect(r,x*TILE,y*TILE,TILE,TILE,(SDL_Color){0,0,160,255});
-        else if(c=='.') draw_rect(r,x*TILE+TILE/2-2,y*TILE+TILE/2-2,4,4,(SDL_Color){255,215,0,255});
-        else if(c=='o') draw_rect(r,x*TILE+TILE/2-5,y*TILE+TILE/2-5,10,10,(SDL_Color){255,255,255,255});
-        else if(c=='H') draw_rect(r,x*TILE,y*TILE,TILE,4,(SDL_Color){80,80,80,255});
+        char was=layer_board[y][x], now=gm->board[y][x];
+        if(was==now) continue;
+        draw_rect(r,x*TILE,y*TILE,TILE,TILE,(SDL_Color){0,0,0,0});
+        draw_pellet_tile(r,x,y,now);
+        layer_board[y][x]=now;
     }
-    draw_rect(r,pac.x*TILE,pac.y*TILE,TILE,TILE,(SDL_Color){255,255,0,255});
+    SDL_SetRenderTarget(r, NULL);
+    return true;
+}
+
+// ===== Sprites =====
+// Pac-Man, the ghosts and the HUD bars come from one small atlas drawn on the CPU at
+// startup: Pac-Man facing the four NAV_DIRS ways with three mouth openings, a ghost
+// body with two skirt frames, eyes looking four ways, the frightened face, and a white
+// cell for solid rects. Bodies and faces are white and take their colour from the
+// vertex, so one body serves every ghost and the frightened/flashing variants. All the
+// moving parts of a frame are gathered into one vertex batch and submitted with a
+// single SDL_RenderGeometry call (the fallback board too, when the layers are
+// unavailable), where every rect used to be its own fill. --flat-sprites keeps the old
+// rects to compare; so does an SDL older than 2.0.18 or an atlas that failed to load.
+#define SPR_COLS 8
+enum {
+    SPR_PAC = 0,                // + dir*3 + mouth (0 closed .. 2 wide)
+    SPR_GHOST = 12,             // + skirt frame
+    SPR_EYES = 14,              // + dir
+    SPR_FRIGHT_FACE = 18,
+    SPR_WHITE = 19,
+    SPR_COUNT
+};
+#define SPR_ROWS ((SPR_COUNT + SPR_COLS - 1) / SPR_COLS)
+#define SPRITE_BATCH 2048       // quads per submission; a full fallback board is about 1100
+#define FLASH_TICKS MS_TO_TICKS(2000)   // frightened ghosts flash for the last 2 s
+
+static SDL_Texture* sprite_atlas = NULL;
+static bool sprites_failed = false, flat_sprites = false;
+static SDL_Vertex sprite_verts[SPRITE_BATCH*4];
+static int sprite_indices[SPRITE_BATCH*6];
+static int sprite_quads = 0;
+
+// Coverage of one texel, 4x4 samples, for smooth edges at a 20-pixel cell.
+static float spr_cover(bool (*inside)(float x, float y, int arg), int px, int py, int arg){
+    int hit = 0;
+    for(int sy=0;sy<4;sy++) for(int sx=0;sx<4;sx++) hit += inside(px + (sx+0.5f)/4, py + (sy+0.5f)/4, arg);
+    return hit/16.0f;
+}
+
+static const float SPR_C = TILE/2.0f, SPR_R = TILE/2.0f - 1;
+
+// arg: dir*3 + mouth. The mouth is a wedge around the heading.
+static bool in_pac(float x, float y, int arg){
+    float dx = x-SPR_C, dy = y-SPR_C;
+    if(dx*dx + dy*dy > SPR_R*SPR_R) return false;
+    static const float half[3] = { 0.0f, 0.42f, 0.85f };       // tan of the half-angle
+    const int* d = NAV_DIRS[arg/3];
+    float along = dx*d[0] + dy*d[1], across = dx*d[1] - dy*d[0];
+    return !(along > 0 && (across < 0 ? -across : across) < along*half[arg%3]);
+}
+
+// arg: skirt frame. Dome on top, three points along the bottom that shift per frame.
+static bool in_ghost(float x, float y, int arg){
+    float dx = x-SPR_C, dy = y-SPR_C;
+    if(y < SPR_C) return dx*dx + dy*dy <= SPR_R*SPR_R;
+    if(x < 1 || x > TILE-1) return false;
+    float period = (TILE-2)/3.0f, t = (x - 1 + (arg ? period/2 : 0))/period;
+    float tooth = t - (int)t;
+    float edge = TILE-1 - 3.0f*(tooth < 0.5f ? 1-2*tooth : 2*tooth-1);
+    return y <= edge;
+}
+
+static bool in_disc(float x, float y, float cx, float cy, float r){ return (x-cx)*(x-cx) + (y-cy)*(y-cy) <= r*r; }
+
+// arg: -1 for the white of the eyes, else the pupils for dir arg.
+static bool in_eyes(float x, float y, int arg){
+    float ox = arg<0 ? 0 : NAV_DIRS[arg][0]*1.6f, oy = arg<0 ? 0 : NAV_DIRS[arg][1]*1.6f;
+    float r = arg<0 ? 3.2f : 1.7f;
+    return in_disc(x, y, 6.5f+ox, 8.5f+oy, r) || in_disc(x, y, 13.5f+ox, 8.5f+oy, r);
+}
+
+// Two square eyes and a zigzag mouth.
+static bool in_fright_face(float x, float y, int arg){
+    (void)arg;
+    if(y>=6 && y<9 && ((x>=5 && x<8) || (x>=12 && x<15))) return true;
+    if(x<3 || x>17) return false;
+    float t = (x-3)/2.33f, tooth = t - (int)t;
+    float mid = 14 + (tooth < 0.5f ? 2*tooth : 2-2*tooth)*2 - 1;
+    return y >= mid-0.8f && y <= mid+0.8f;
+}
+
+static Uint32 spr_px(Uint8 r, Uint8 g, Uint8 b, float a){ return (Uint32)r<<24 | (Uint32)g<<16 | (Uint32)b<<8 | (Uint32)(a*255 + 0.5f); }
+
+static void sprites_destroy(void){
+    if(sprite_atlas){ SDL_DestroyTexture(sprite_atlas); sprite_atlas = NULL; }
+    sprites_failed = false;
+}
+
+// Create the atlas on first use; false means draw flat rects.
+static bool sprites_ready(SDL_Renderer* r){
+    if(flat_sprites) return false;
+    if(sprite_atlas) return true;
+#if SDL_VERSION_ATLEAST(2,0,18)
+    if(sprites_failed) return false;
+    enum { W = SPR_COLS*TILE, H = SPR_ROWS*TILE };
+    static Uint32 px[H][W];
+    memset(px, 0, sizeof px);
+    for(int cell=0; cell<SPR_COUNT; cell++){
+        Uint32 (*c)[W] = (Uint32 (*)[W])&px[cell/SPR_COLS*TILE][cell%SPR_COLS*TILE];
+        for(int y=0;y<TILE;y++) for(int x=0;x<TILE;x++){
+            if(cell < SPR_GHOST) c[y][x] = spr_px(255,255,255, spr_cover(in_pac, x, y, cell));
+            else if(cell < SPR_EYES) c[y][x] = spr_px(255,255,255, spr_cover(in_ghost, x, y, cell-SPR_GHOST));
+            else if(cell < SPR_FRIGHT_FACE){
+                float white = spr_cover(in_eyes, x, y, -1), pupil = spr_cover(in_eyes, x, y, cell-SPR_EYES);
+                c[y][x] = pupil > 0 ? spr_px(33,33,222, pupil > white ? pupil : white) : spr_px(255,255,255, white);
+            }
+            else if(cell == SPR_FRIGHT_FACE) c[y][x] = spr_px(255,255,255, spr_cover(in_fright_face, x, y, 0));
+            else c[y][x] = spr_px(255,255,255, 1);
+        }
+    }
+    sprite_atlas = SDL_CreateTexture(r, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, W, H);
+    tex_allocs_frame++;
+    if(!sprite_atlas || SDL_UpdateTexture(sprite_atlas, NULL, px, W*4)!=0){
+        SDL_Log("Sprite atlas unavailable, drawing flat rects: %s", SDL_GetError());
+        sprites_destroy(); sprites_failed = true;
+        return false;
+    }
+    SDL_SetTextureBlendMode(sprite_atlas, SDL_BLENDMODE_BLEND);
+    for(int q=0;q<SPRITE_BATCH;q++){
+        int* i = &sprite_indices[q*6];
+        i[0]=q*4; i[1]=q*4+1; i[2]=q*4+2; i[3]=q*4; i[4]=q*4+2; i[5]=q*4+3;
+    }
+    return true;
+#else
+    (void)r;
+    return false;
+#endif
+}
+
+static void sprites_flush(SDL_Renderer* r){
+    if(!sprite_quads) return;
+#if SDL_VERSION_ATLEAST(2,0,18)
+    SDL_RenderGeometry(r, sprite_atlas, sprite_verts, sprite_quads*4, sprite_indices, sprite_quads*6);
+    TRACE_COUNT(TC_DRAW, 1);
+#endif
+    sprite_quads = 0;
+}
+
+// Queue atlas cell `cell` stretched over (x,y,w,h) and tinted c.
+static void sprite_quad(SDL_Renderer* r, float x, float y, float w, float h, int cell, SDL_Color c){
+    if(sprite_quads==SPRITE_BATCH) sprites_flush(r);
+    float u0 = (float)(cell%SPR_COLS)/SPR_COLS, v0 = (float)(cell/SPR_COLS)/SPR_ROWS;
+    float u1 = u0 + 1.0f/SPR_COLS, v1 = v0 + 1.0f/SPR_ROWS;
+    if(cell==SPR_WHITE){ u0 = u1 = (u0+u1)/2; v0 = v1 = (v0+v1)/2; }     // one texel: no edge bleed
+    SDL_Vertex* v = &sprite_verts[sprite_quads++*4];
+    v[0] = (SDL_Vertex){{x,y},c,{u0,v0}};     v[1] = (SDL_Vertex){{x+w,y},c,{u1,v0}};
+    v[2] = (SDL_Vertex){{x+w,y+h},c,{u1,v1}}; v[3] = (SDL_Vertex){{x,y+h},c,{u0,v1}};
+}
+
+static void sprite_rect(SDL_Renderer* r, int x, int y, int w, int h, SDL_Color c){
+    if(w>0 && h>0) sprite_quad(r, (float)x, (float)y, (float)w, (float)h, SPR_WHITE, c);
+}
+
+// Mouth opening for a frame alpha of the way through a step: wide, half, closed, half.
+static int pac_mouth(bool moving, float alpha){
+    static const int CYCLE[4] = { 2, 1, 0, 1 };
+    if(!moving) return 1;
+    int i = (int)(alpha*4);
+    return CYCLE[i>3 ? 3 : i];
+}
+
+static void sprite_ghost(SDL_Renderer* r, const Game* gm, int i, int x, int y, float alpha, SDL_Color col){
+    const Ghost* g = &gm->ghosts[i];
+    int skirt = (int)((gm->ticks + (alpha>=0.5f)) & 1);
+    int dir = graph_dir_index(g->e.dx, g->e.dy);
+    if(g->mode==MODE_FRIGHT){
+        uint32_t left = g->fright_timer > gm->ticks ? g->fright_timer - gm->ticks : 0;
+        bool flash = left <= FLASH_TICKS && (left/2) % 2 == 0;
+        sprite_quad(r, (float)x, (float)y, TILE, TILE, SPR_GHOST+skirt, flash ? (SDL_Color){255,255,255,255} : (SDL_Color){33,33,222,255});
+        sprite_quad(r, (float)x, (float)y, TILE, TILE, SPR_FRIGHT_FACE, flash ? (SDL_Color){255,0,0,255} : (SDL_Color){255,184,174,255});
+    }else{
+        sprite_quad(r, (float)x, (float)y, TILE, TILE, SPR_GHOST+skirt, col);
+        sprite_quad(r, (float)x, (float)y, TILE, TILE, SPR_EYES+(dir<0 ? 0 : dir), (SDL_Color){255,255,255,255});
+    }
+}
+
+// ===== Entity interpolation =====
+// The simulation moves entities a whole tile per tick; frames in between draw them
+// part of the way from the tile they left (prev_pos, taken before each tick on the
+// simulation thread and published with the frame) to the one they are on, so motion
+// is smooth at any refresh rate. The picture runs at most one tick behind the
+// simulation. Index 0 is Pac-Man, 1..4 the ghosts.
+static Point prev_pos[5];
+
+static void snapshot_positions(const Game* gm){
+    prev_pos[0] = (Point){gm->pac.x, gm->pac.y};
+    for(int i=0;i<4;i++) prev_pos[i+1] = (Point){gm->ghosts[i].e.x, gm->ghosts[i].e.y};
+}
+
+// Pixel coordinate between two tiles; a jump of more than one tile (tunnel wrap,
+// respawn after a death or being eaten) snaps instead of sliding across the board.
+static int lerp_px(int from, int to, float alpha){
+    if(from-to>1 || to-from>1) return to*TILE;
+    return (int)((float)(from*TILE) + (float)((to-from)*TILE)*alpha + 0.5f);
+}
+
+// ===== Game rendering =====
+// prev may be NULL to draw entities exactly on their tiles; alpha is the fraction of
+// the current tick elapsed (0..1). With the sprite atlas the board is two layer copies
+// and everything else one geometry batch; flat rects otherwise.
+static void render_game(SDL_Renderer*r, const Game* gm, const Point* prev, float alpha, bool paused, TTF_Font* font){
+    const Entity pac = gm->pac; const Ghost* ghosts = gm->ghosts;
+    int score = gm->score, lives = gm->lives; bool game_won = gm->won, over = gm->over;
+    bool sprites = sprites_ready(r);
+    if(layers_sync(r, gm)){
+        SDL_RenderCopy(r, maze_layer, NULL, NULL);   // opaque: also clears the frame
+        SDL_RenderCopy(r, pellet_layer, NULL, NULL);
+        TRACE_COUNT(TC_DRAW, 2);
+    }else if(sprites){
+        sprite_rect(r, 0, 0, SCREEN_W, SCREEN_H, (SDL_Color){0,0,0,255});
+        for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+            char c=gm->board[y][x];
+            if(c=='#') sprite_rect(r,x*TILE,y*TILE,TILE,TILE,(SDL_Color){0,0,160,255});
+            else if(c=='H') sprite_rect(r,x*TILE,y*TILE,TILE,4,(SDL_Color){80,80,80,255});
+            else if(c=='.') sprite_rect(r,x*TILE+TILE/2-2,y*TILE+TILE/2-2,4,4,(SDL_Color){255,215,0,255});
+            else if(c=='o') sprite_rect(r,x*TILE+TILE/2-5,y*TILE+TILE/2-5,10,10,(SDL_Color){255,255,255,255});
+        }
+    }else{
+        clear_frame(r);
+        for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+            char c=gm->board[y][x];
+            draw_static_tile(r,x,y,c);
+            draw_pellet_tile(r,x,y,c);
+        }
+    }
+    if(!prev) alpha = 1.0f;
+    Point from = prev? prev[0] : (Point){pac.x,pac.y};
+    int px = lerp_px(from.x,pac.x,alpha), py = lerp_px(from.y,pac.y,alpha);
+    SDL_Color yellow = {255,255,0,255};
+    if(sprites){
+        int dir = graph_dir_index(pac.dx, pac.dy);
+        int mouth = pac_mouth(from.x!=pac.x || from.y!=pac.y, alpha);
+        sprite_quad(r, (float)px, (float)py, TILE, TILE, SPR_PAC + (dir<0 ? 0 : dir)*3 + mouth, yellow);
+    }else draw_rect(r,px,py,TILE,TILE,yellow);
     SDL_Color ghost_color[4]={{255,0,0,255},{255,105,180,255},{0,255,255,255},{255,165,0,255}};
     for(int i=0;i<4;i++){
-        SDL_Color col = (ghosts[i].mode==MODE_FRIGHT)? (SDL_Color){0,0,255,255} : ghost_color[i];
-        draw_rect(r,ghosts[i].e.x*TILE,ghosts[i].e.y*TILE,TILE,TILE,col);
+        from = prev? prev[i+1] : (Point){ghosts[i].e.x,ghosts[i].e.y};
+        int gx = lerp_px(from.x,ghosts[i].e.x,alpha), gy = lerp_px(from.y,ghosts[i].e.y,alpha);
+        if(sprites) sprite_ghost(r, gm, i, gx, gy, alpha, ghost_color[i]);
+        else draw_rect(r,gx,gy,TILE,TILE,(ghosts[i].mode==MODE_FRIGHT)? (SDL_Color){0,0,255,255} : ghost_color[i]);
+    }
+    int barw=(score%2000)*SCREEN_W/2000;
+    if(sprites){
+        sprite_rect(r,0,SCREEN_H-6,barw,6,(SDL_Color){50,200,50,255});
+        for(int i=0;i<lives;i++) sprite_quad(r, (float)(i*14), 0, 12, 12, SPR_PAC + 3 + 1, yellow);   // facing left
+        sprites_flush(r);
+    }else{
+        draw_rect(r,0,SCREEN_H-6,barw,6,(SDL_Color){50,200,50,255});
+        for(int i=0;i<lives;i++) draw_rect(r,i*14,0,12,6,yellow);
     }
-    int barw=(score%2000)*SCREEN_W/2000; draw_rect(r,0,SCREEN_H-6,barw,6,(SDL_Color){50,200,50,255});
-    for(int i=0;i<lives;i++) draw_rect(r,i*14,0,12,6,(SDL_Color){255,255,0,255});
 
     // Overlay
     if(esc_menu){
@@ -395,81 +810,219 @@ static void render_game(SDL_Renderer*r, Entity pac, Ghost ghosts[4], int score,
         draw_text(r, font, "Press Enter to retry", SCREEN_W/2-120, SCREEN_H/2+10, (SDL_Color){255,255,255,255});
         SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
     }
-    SDL_RenderPresent(r);
 }
 
-/* Classic global phase schedule (level 1 timing approximation):
-   S7, C20, S7, C20, S5, C20, S5, C∞
-   0 duration means "infinite" (stay in that mode). */
-typedef struct { GhostMode mode; Uint32 dur_ms; } Phase;
-static const Phase PHASES[] = {
-    {MODE_SCATTER, 7000}, {MODE_CHASE, 20000},
-    {MODE_SCATTER, 7000}, {MODE_CHASE, 20000},
-    {MODE_SCATTER, 5000}, {MODE_CHASE, 20000},
-    {MODE_SCATTER, 5000}, {MODE_CHASE, 0}
-};
-static int phase_idx = 0;
-static Uint32 phase_start = 0;
-static bool phase_inited = false;
-
-static GhostMode current_phase_mode(void){ return PHASES[phase_idx].mode; }
-
-// Pause/resume the schedule while any ghost is frightened
-static void maybe_switch_modes(Ghost ghosts[4], Uint32 now){
-    if(!phase_inited){ phase_inited=true; phase_start=now; phase_idx=0; }
-    bool any_fright=false;
-    for(int i=0;i<4;i++) if(ghosts[i].mode==MODE_FRIGHT) { any_fright=true; break; }
-    if(any_fright) { return; }
-
-    Uint32 dur = PHASES[phase_idx].dur_ms;
-    if(dur==0) return;
-
-    if(now - phase_start >= dur){
-        if(phase_idx < (int)(sizeof(PHASES)/sizeof(PHASES[0])) - 1){
-            phase_idx++;
-            phase_start = now;
-            GhostMode nm = PHASES[phase_idx].mode;
-            for(int i=0;i<4;i++){
-                if(ghosts[i].mode != MODE_FRIGHT) ghosts[i].mode = nm;
-            }
-        }
-    }
+// ===== Frame pacing =====
+// Simulation time advances in fixed STEP_MS ticks on its own thread; the render
+// rate is independent of it. With vsync, SDL_RenderPresent blocks until the flip and
+// nothing else throttles the loop. Without it (driver refused, --no-vsync, --fps N)
+// frames are spaced by sleeping until about a millisecond before the deadline and
+// yielding for the rest; frame_ms 0 renders uncapped.
+typedef struct { double frame_ms, next; } Pacer;
+static char pacing_desc[48] = "vsync";
+
+static double clock_ms(void){
+    return (double)SDL_GetPerformanceCounter()*1000.0/(double)SDL_GetPerformanceFrequency();
 }
 
-static void set_frightened(Ghost ghosts[4]){
-    Uint32 now=SDL_GetTicks();
-    for(int i=0;i<4;i++){
-        ghosts[i].mode = MODE_FRIGHT;
-        ghosts[i].fright_timer = now + FRIGHT_MS;
+static void pacer_wait(Pacer* p){
+    if(p->frame_ms<=0) return;
+    double now = clock_ms();
+    if(p->next<=0 || now > p->next + p->frame_ms) p->next = now;   // first frame or a stall: no burst
+    while(now < p->next){
+        double left = p->next - now;
+        SDL_Delay(left > 2.0 ? (Uint32)(left - 1.0) : 0);
+        now = clock_ms();
     }
+    p->next += p->frame_ms;
 }
 
-static void place_starts(Entity* pac, Ghost g[4]){
-    pac->x=13; pac->y=20; pac->dx=-1; pac->dy=0; pac->startx=pac->x; pac->starty=pac->y;
-    int found=0;
-    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
-        if(LEVEL0[y][x]=='G' && found<4){
-            g[found].e.x=x; g[found].e.y=y; g[found].e.startx=x; g[found].e.starty=y;
-            g[found].e.dx=1; g[found].e.dy=0; g[found].mode=MODE_SCATTER; g[found].fright_timer=0; found++;
-        }
+// ===== Autopilot (F6, --autopilot) =====
+// The tree search (mcts.h) steers Pac-Man. Right after each tick the simulation thread
+// hands the new state to a search thread, which decides within half a tick while the
+// simulation sleeps until the next one; that tick collects the answer. A search from a state that was
+// replaced in the meantime (rewind, save-state, new game) is thrown away. Pressing a
+// direction takes control back.
+static Mcts* autopilot = NULL;
+static bool autopilot_on = false;
+static SDL_Thread* ap_thread = NULL;
+static SDL_sem *ap_go = NULL, *ap_done = NULL;
+static SDL_atomic_t ap_quit;
+static Game ap_state;               // owned by the search thread between ap_go and ap_done
+static MctsResult ap_result;
+static bool ap_busy = false;        // a search was posted and not yet collected
+static uint32_t ap_gen = 0, ap_search_gen = 0;
+static long ap_decisions = 0, ap_rollouts = 0;
+static double ap_ms = 0, ap_max_ms = 0;
+
+static int autopilot_thread(void* unused){
+    (void)unused;
+    for(;;){
+        SDL_SemWait(ap_go);
+        if(SDL_AtomicGet(&ap_quit)) return 0;
+        ap_result = mcts_decide(autopilot, &ap_state);
+        SDL_SemPost(ap_done);
     }
-    while(found<4){
-        g[found].e.x=13; g[found].e.y=14; g[found].e.startx=g[found].e.x; g[found].e.starty=g[found].e.y;
-        g[found].e.dx=1; g[found].e.dy=0; g[found].mode=MODE_SCATTER; g[found].fright_timer=0; found++;
-    }
-    // Reset schedule to start at first SCATTER
-    phase_inited=false;
 }
 
-static void reset_positions(Entity* pac, Ghost g[4]){
-    pac->x=pac->startx; pac->y=pac->starty; pac->dx=-1; pac->dy=0;
-    for(int i=0;i<4;i++){
-        g[i].e.x=g[i].e.startx; g[i].e.y=g[i].e.starty; g[i].e.dx=1; g[i].e.dy=0;
+static void autopilot_quit(void){
+    if(ap_thread){
+        if(ap_busy) SDL_SemWait(ap_done);
+        SDL_AtomicSet(&ap_quit, 1);
+        SDL_SemPost(ap_go);
+        SDL_WaitThread(ap_thread, NULL);
+        ap_thread = NULL;
     }
+    if(ap_go) SDL_DestroySemaphore(ap_go);
+    if(ap_done) SDL_DestroySemaphore(ap_done);
+    ap_go = ap_done = NULL; ap_busy = false;
+    mcts_destroy(autopilot); autopilot = NULL;
+}
+
+// Set up on first use; false (and logged) if the search cannot run.
+static bool autopilot_start(void){
+    if(autopilot) return true;
+    MctsConfig cfg = MCTS_DEFAULT_CONFIG;
+    int cpus = pool_cpu_count();
+    cfg.threads = cpus > 1 ? cpus-1 : 1;      // leave the frame loop a core
+    cfg.seed = SDL_GetPerformanceCounter();
+    autopilot = mcts_create(&cfg);
+    ap_go = SDL_CreateSemaphore(0); ap_done = SDL_CreateSemaphore(0);
+    if(autopilot && ap_go && ap_done) ap_thread = SDL_CreateThread(autopilot_thread, "autopilot", NULL);
+    if(!ap_thread){ SDL_Log("Autopilot unavailable: %s", autopilot? SDL_GetError() : "cannot set up the search"); autopilot_quit(); return false; }
+    SDL_Log("Autopilot: %d search threads, %.0f ms per decision", mcts_threads(autopilot), cfg.budget_ms);
+    return true;
+}
+
+// The game state was replaced: a running search no longer applies.
+static void autopilot_invalidate(void){ ap_gen++; }
+
+static void autopilot_post(const Game* gm){
+    if(!autopilot_on || ap_busy || gm->won || gm->over) return;
+    ap_state = *gm; ap_search_gen = ap_gen; ap_busy = true;
+    SDL_SemPost(ap_go);
+}
+
+// Before a tick: wait for the search from this state (normally done already) and steer.
+static void autopilot_steer(Game* gm, InputLog* rec){
+    if(!autopilot_on) return;
+    if(!ap_busy) autopilot_post(gm);          // just switched on: search now
+    if(!ap_busy) return;
+    SDL_SemWait(ap_done); ap_busy = false;
+    if(ap_search_gen != ap_gen || ap_state.ticks != gm->ticks) return;
+    MctsResult r = ap_result;
+    if(r.rollouts){ ap_decisions++; ap_rollouts += r.rollouts; ap_ms += r.ms; if(r.ms > ap_max_ms) ap_max_ms = r.ms; }
+    if(r.dir >= 0) replay_set_dir(rec, gm, NAV_DIRS[r.dir][0], NAV_DIRS[r.dir][1]);
+}
+
+static void autopilot_log(void){
+    if(ap_decisions) SDL_Log("Autopilot: %ld decisions, %.0f rollouts/s, latency avg %.2f ms, max %.2f ms",
+                             ap_decisions, ap_ms>0? ap_rollouts*1000.0/ap_ms : 0.0, ap_ms/ap_decisions, ap_max_ms);
+}
+
+// ===== Simulation thread =====
+// The game runs on its own thread at the fixed tick rate and owns everything that
+// changes it: the Game, the input log, the rewind history, the save-state and the
+// autopilot. The main thread keeps events, audio and rendering, and the two meet only
+// in lock-free channels (channel.h): commands go in over an SPSC queue, notes for
+// sounds and toasts come back over another, and after every change the simulation
+// publishes an immutable SimFrame into a triple buffer from which each rendered frame
+// takes the newest. A slow present no longer delays a tick, nor a busy tick a frame.
+typedef enum { CMD_START, CMD_RUN, CMD_DIR, CMD_SAVE, CMD_LOAD, CMD_REWIND, CMD_AUTOPILOT, CMD_RELOAD, CMD_QUIT } SimCmdType;
+typedef struct {
+    SimCmdType type;
+    bool on;                    // CMD_RUN, CMD_REWIND, CMD_AUTOPILOT
+    int dx, dy;                 // CMD_DIR
+    bool repeat;                // CMD_DIR: key auto-repeat, so no latency sample
+    Uint32 stamp;               // CMD_DIR: the key event's timestamp
+    const Level* level;         // CMD_START; NULL restarts the current level. CMD_RELOAD: the new generation
+    const LevelDiff* diff;      // CMD_RELOAD: what changed from the one before
+} SimCmd;
+typedef enum { NOTE_DEATH, NOTE_CHOMP, NOTE_GHOST_EATEN, NOTE_WON, NOTE_OVER, NOTE_SAVED, NOTE_LOADED, NOTE_NO_SAVE, NOTE_RESUMED, NOTE_AUTOPILOT_OFF } SimNote;
+
+typedef struct {
+    Game game;
+    Point prev[5];              // tiles before the last tick, for interpolation
+    double tick_at, tick_ms;    // clock_ms() when the shown tick began, and the tick length
+    bool running;               // ticks are due: playing, not paused, not over
+    bool rewinding, autopilot;
+    long ap_decisions, ap_rollouts;
+    double ap_ms, ap_max_ms;
+    uint32_t turn_seq;          // turns shown so far; a new value is a new latency sample
+    Uint32 turn_stamp, turn_state_ms;   // the latest: key timestamp, input-to-state ms
+    long turns_buffered, turns_lapsed;
+} SimFrame;
+
+static TripleBuf sim_frames;
+static SpscQueue sim_cmds, sim_notes;
+static SDL_sem* sim_wake = NULL;        // posted with every command, so a waiting tick loop reacts at once
+static SDL_Thread* sim_thread = NULL;
+static long frames_duplicated = 0;      // frames that showed a finished tick again because the next was late
+
+// ===== Perf stats overlay (F3) =====
+static bool show_stats = false;
+
+// Input latency from a key's SDL timestamp to the end of the tick that moved Pac-Man
+// on it (input-to-state, measured by the simulation) and to the return of
+// SDL_RenderPresent for the first frame drawn from that tick (input-to-present).
+// The clock counts whole milliseconds; a frame dropped unseen loses its sample.
+static TraceLatency lat_state, lat_present;
+static uint32_t turns_seen = 0;
+
+// Counters shown are those of the previous finished frame (trace_frame_end()).
+static void render_stats(SDL_Renderer* r, TTF_Font* font, int tex_allocs, const SimFrame* fr){
+    TextStats ts = text_stats(text_sys);
+    TraceFrameStats fs = trace_frame_stats();
+    char line[6][160];
+    int lines = 4;
+    SDL_snprintf(line[0], sizeof line[0], "tex allocs/frame %d | text draws %d | cache %d/%d | quads %d%s",
+                 tex_allocs, ts.draws, ts.cache_hits, ts.cache_misses, ts.quads, text_sys? "" : " | legacy text");
+    SDL_snprintf(line[1], sizeof line[1], "frame ms p50 %.2f p95 %.2f p99 %.2f max %.2f | jitter %.2f | %s",
+                 fs.p50_ms, fs.p95_ms, fs.p99_ms, fs.max_ms, fs.jitter_ms, pacing_desc);
+#ifndef PACMAN_NO_TRACE
+    uint32_t ticks = fs.last[TC_TICKS];
+    SDL_snprintf(line[2], sizeof line[2], "ticks %u | path queries/tick %.1f | bfs/tick %.1f | draw calls %u",
+                 ticks, ticks? (double)fs.last[TC_PATH]/ticks : 0.0, ticks? (double)fs.last[TC_BFS]/ticks : 0.0, fs.last[TC_DRAW]);
+#else
+    SDL_snprintf(line[2], sizeof line[2], "counters compiled out (PACMAN_NO_TRACE)");
+#endif
+    SDL_snprintf(line[3], sizeof line[3], "sim frames published %u | dropped %u | duplicated %ld",
+                 (unsigned)atomic_load(&sim_frames.published), (unsigned)atomic_load(&sim_frames.overwritten), frames_duplicated);
+    if(lat_state.n)
+        SDL_snprintf(line[lines++], sizeof line[0], "input ms: state p50 %u p95 %u | present p50 %u p95 %u | buffered %ld lapsed %ld",
+                     trace_latency_pct(&lat_state, 50), trace_latency_pct(&lat_state, 95),
+                     trace_latency_pct(&lat_present, 50), trace_latency_pct(&lat_present, 95), fr->turns_buffered, fr->turns_lapsed);
+    if(fr->ap_decisions)
+        SDL_snprintf(line[lines++], sizeof line[0], "autopilot %d threads | rollouts/s %.0f | decision ms avg %.2f max %.2f",
+                     mcts_threads(autopilot), fr->ap_ms>0? fr->ap_rollouts*1000.0/fr->ap_ms : 0.0, fr->ap_ms/fr->ap_decisions, fr->ap_max_ms);
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+    draw_rect(r, 0, SCREEN_H-6-lines*28, SCREEN_W, lines*28, (SDL_Color){0,0,0,200});
+    for(int i=0;i<lines;i++) draw_text(r, font, line[i], 6, SCREEN_H-4-lines*28+i*27, (SDL_Color){120,255,120,255});
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+}
+
+static Uint64 perf_counter(void){ return SDL_GetPerformanceCounter(); }
+
+static const char* trace_path = "pacman_trace.json";
+static bool trace_requested = false;   // --trace given: also write the ring on exit
+
+static void trace_write(void){
+    if(trace_dump(trace_path)) SDL_Log("Trace written to %s", trace_path);
+    else SDL_Log("Could not write trace %s", trace_path);
 }
 
-static int count_pellets(void){
-    int c=0; for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) if(board[y][x]=='.'||board[y][x]=='o') c++; return c;
+// --telemetry FILE: the simulation thread logs gameplay events (telemetry.h) for
+// tools/telemstat. Opened before the thread starts, closed after it has stopped.
+static TelemLog* telem_log = NULL;
+static const char* telem_path = NULL;
+
+static void telem_finish(void){
+    if(!telem_log) return;
+    TelemStats st;
+    bool ok = telem_close(telem_log, &st);
+    telem_log = NULL;
+    SDL_Log("Telemetry: %llu events, %.1f MB, %llu dropped %s %s", (unsigned long long)st.events, st.bytes/1048576.0,
+            (unsigned long long)st.dropped, ok? "appended to" : "- could not write", telem_path);
 }
 
 // Now implemented: switch to main menu scene
@@ -480,44 +1033,834 @@ static void go_to_main_menu(void){
     play_menu_music();
 }
 
+// ===== Input recording =====
+// With --record FILE each game's seed and heading changes are logged, and the log of
+// the previous game is written out when a new one starts or the program exits.
+static InputLog input_log;
+static const char* record_path = NULL;
+
+// ===== Levels =====
+// Play is the built-in maze, or the --level FILE (see Live level); Level 2 is the
+// second level of levels/levels.pack (built by tools/levelc.c) and stays locked if
+// the pack is missing or damaged.
+#define LEVEL_PACK_PATH "levels/levels.pack"
+static LevelPack* level_pack = NULL;
+static const Level* cur_level = &LEVEL_CLASSIC;
+
+static void load_level_pack(void){
+    char err[256];
+    level_pack = levelpack_open(LEVEL_PACK_PATH, err, sizeof err);
+    if(!level_pack){ SDL_Log("Level pack not loaded, Level 2 stays locked: %s", err); return; }
+    if(levelpack_count(level_pack)>=2) MAIN_ITEMS[1] = levelpack_name(level_pack, 1);
+}
+
+static const Level* pack_level(int i){
+    return level_pack && i<levelpack_count(level_pack) ? levelpack_level(level_pack, i) : NULL;
+}
+
+// Input logs hold only a seed, so they replay the built-in level; other levels are not recorded.
+static InputLog* recorder(void){ return record_path && cur_level==&LEVEL_CLASSIC ? &input_log : NULL; }
+
+static void record_flush(void){
+    if(record_path && input_log.ticks && !replay_save(&input_log, record_path))
+        SDL_Log("Could not write input log %s", record_path);
+}
+
+// ===== Buffered turns =====
+// A direction key that cannot be taken yet (wall beside Pac-Man) is queued instead of
+// turning him into the wall, and taken on the first tick it is passable. A queued turn
+// lapses once Pac-Man has reached the next junction ahead (pac_ahead) without it
+// fitting, so pressing early means "at the next turning" rather than "some time". A
+// press that fits at once replaces the queue, and a held key's auto-repeat queues it
+// again after it lapsed, so holding a direction takes the first opening. Turns go
+// through replay_set_dir() between ticks like any key, so recordings replay.
+// Simulation thread only.
+#define TURN_QUEUE 2                // a second press waits behind the first: a corner, then a junction
+typedef struct {
+    int dx, dy;
+    bool sample;                    // a fresh press, not auto-repeat: time it
+    Uint32 stamp;                   // SDL event timestamp of the key
+    uint32_t until;                 // last tick it may be taken on; set when it reaches the head
+} Turn;
+static Turn turn_q[TURN_QUEUE];
+static int turn_n = 0;
+static long turns_buffered = 0, turns_lapsed = 0;   // taken on a later tick / never taken
+static bool turn_taken = false;     // a turn was taken and the tick showing it has not run yet
+static Uint32 turn_stamp = 0;       // its key's timestamp
+static uint32_t turn_seq = 0;       // turns the simulation has shown so far
+static Uint32 turn_state_ms = 0;    // input-to-state latency of the latest of them
+
+static bool turn_fits(const Game* gm, const Turn* t){ return passable_for_pac(gm, gm->pac.x+t->dx, gm->pac.y+t->dy); }
+
+// Steps to the next junction or dead end on Pac-Man's heading, following corridor bends
+// as graph_ahead() does but with his passability: gm->graph is the ghosts' (gate open),
+// whose nodes beside the ghost house are not junctions he can turn at. -1 if he is
+// standing still or facing a wall.
+static int pac_ahead(const Game* gm){
+    int dir = graph_dir_index(gm->pac.dx, gm->pac.dy), x = gm->pac.x, y = gm->pac.y;
+    if(dir<0 || !passable_for_pac(gm, x+NAV_DIRS[dir][0], y+NAV_DIRS[dir][1])) return -1;
+    int steps = 0;
+    while(steps < MAP_W*MAP_H){                 // a loop with no junction ends here
+        x += NAV_DIRS[dir][0]; y += NAV_DIRS[dir][1]; steps++;
+        if(x<0) x = MAP_W-1; else if(x>=MAP_W) x = 0;
+        if(!in_bounds(x,y)) break;
+        int next = -1, exits = 0;
+        for(int d=0;d<4;d++) if(d!=(dir^1) && passable_for_pac(gm, x+NAV_DIRS[d][0], y+NAV_DIRS[d][1])){ next = d; exits++; }
+        if(exits!=1) break;
+        dir = next;
+    }
+    return steps;
+}
+
+// The head may wait until Pac-Man reaches the next junction on his heading; forever if
+// he is standing still, since then nothing changes until a key that fits replaces it.
+static void turn_deadline(const Game* gm){
+    int steps = pac_ahead(gm);
+    turn_q[0].until = steps>0 ? gm->ticks + (uint32_t)steps : UINT32_MAX;
+}
+
+static void turn_clear(void){ turn_n = 0; turn_taken = false; }
+
+static void turn_take(Game* gm, const Turn* t){
+    replay_set_dir(recorder(), gm, t->dx, t->dy);
+    if(t->sample){ turn_taken = true; turn_stamp = t->stamp; }
+}
+
+// Before each tick: take the head if it fits now, drop it if its junction has passed.
+static void turn_update(Game* gm){
+    while(turn_n){
+        bool fits = turn_fits(gm, &turn_q[0]);
+        if(fits){ turn_take(gm, &turn_q[0]); turns_buffered++; }
+        else if(gm->ticks < turn_q[0].until) return;
+        else turns_lapsed++;
+        memmove(turn_q, turn_q+1, (size_t)--turn_n * sizeof *turn_q);
+        if(turn_n) turn_deadline(gm);
+        if(fits) return;
+    }
+}
+
+static void turn_press(Game* gm, int dx, int dy, bool repeat, Uint32 stamp){
+    Turn t = { dx, dy, !repeat, stamp, 0 };
+    if(turn_fits(gm, &t)){ turn_n = 0; turn_take(gm, &t); return; }
+    if(repeat && turn_n && turn_q[turn_n-1].dx==dx && turn_q[turn_n-1].dy==dy) return;   // still queued
+    if(turn_n == TURN_QUEUE){ memmove(turn_q, turn_q+1, (TURN_QUEUE-1) * sizeof *turn_q); turn_n--; turns_lapsed++; turn_deadline(gm); }
+    turn_q[turn_n++] = t;
+    if(turn_n == 1) turn_deadline(gm);
+}
+
+// After each tick: the tick that moved Pac-Man on a taken turn closes its input-to-state time.
+static void turn_shown(void){
+    if(!turn_taken) return;
+    turn_taken = false;
+    turn_state_ms = SDL_GetTicks() - turn_stamp;
+    turn_seq++;
+}
+
+// Main thread, once the simulation has stopped.
+static void log_row(void* ctx, const char* row){ (void)ctx; SDL_Log("  %s", row); }
+
+static void latency_log(void){
+    if(!lat_state.n) return;
+    char line[128];
+    trace_latency_line(&lat_state, line, sizeof line);
+    SDL_Log("Input to state: %s", line);
+    trace_latency_line(&lat_present, line, sizeof line);
+    SDL_Log("Input to present: %s", line);
+    trace_latency_chart(&lat_present, 10, log_row, NULL);
+    SDL_Log("Turns: %ld buffered until they fit, %ld lapsed at their junction", turns_buffered, turns_lapsed);
+}
+
+// ===== Save-states and rewind =====
+// F5 saves the running game and F9 returns to it; holding Backspace rewinds through
+// the last REWIND_TICKS ticks at REWIND_SPEED times game speed. Either way the input
+// log is cut back to the restored tick so a recording still replays, and a save-state
+// from a stretch that was rewound away is dropped with it.
+#define REWIND_TICKS 512            // about a minute of play
+#define REWIND_SPEED 3
+static SnapRing history;
+static Snapshot quick_save;
+static bool have_quick_save = false;
+static bool rewinding = false;
+static const char* toast_msg = NULL;
+static Uint32 toast_until = 0;
+
+static void toast(const char* msg){ toast_msg = msg; toast_until = SDL_GetTicks() + 1200; }
+
+static SDL_Rect toast_rect(void){ return (SDL_Rect){ SCREEN_W/2-110, 14, 220, 34 }; }
+
+static void render_toast(SDL_Renderer* r, TTF_Font* font, bool rewound){
+    const char* msg = rewound ? "<< Rewind" : toast_msg && SDL_GetTicks() < toast_until ? toast_msg : NULL;
+    if(!msg) return;
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+    SDL_Rect t = toast_rect();
+    draw_rect(r, t.x, t.y, t.w, t.h, (SDL_Color){0,0,0,180});
+    draw_text_center(r, font, msg, SCREEN_W/2, 18, (SDL_Color){255,215,0,255});
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+}
+
+// One tick back through the history; false at the oldest kept tick.
+static bool rewind_tick(Game* gm){
+    if(snapring_count(&history) < 2) return false;
+    snapshot_positions(gm);
+    snapring_drop(&history, 1);
+    snapshot_load(gm, &history.last);
+    autopilot_invalidate();
+    return true;
+}
+
+static void load_quick_save(Game* gm){
+    snapshot_load(gm, &quick_save);
+    autopilot_invalidate();
+    int back = (int)(history.last.ticks - quick_save.ticks);
+    snapring_drop(&history, back);
+    if(history.last.ticks != quick_save.ticks) snapring_reset(&history, gm);   // older than the history
+    snapshot_positions(gm);
+    turn_clear();
+}
+
+// Play continues from gm after its state was replaced.
+static void resume_from(const Game* gm){
+    if(have_quick_save && quick_save.ticks > gm->ticks) have_quick_save = false;
+    replay_rewind(recorder(), gm);
+}
+
+static void start_game(Game* gm){
+    record_flush();
+    uint64_t seed = ((uint64_t)time(NULL) << 32) ^ SDL_GetPerformanceCounter();
+    if(cur_level==&LEVEL_CLASSIC) replay_begin(recorder(), gm, seed);
+    else game_new_level(gm, cur_level, seed);
+    snapshot_positions(gm);
+    snapring_reset(&history, gm);
+    have_quick_save = rewinding = false;
+    autopilot_invalidate();
+    turn_clear();
+}
+
+// ----- Simulation thread body -----
+static void sim_note(SimNote n){ spsc_push(&sim_notes, &n); wake_main(); }   // dropped if the main thread is that far behind
+
+static void sim_publish(const Game* gm, bool running, double tick_at, double tick_ms){
+    SimFrame* f = tbuf_back(&sim_frames);
+    f->game = *gm;
+    memcpy(f->prev, prev_pos, sizeof f->prev);
+    f->tick_at = tick_at; f->tick_ms = tick_ms;
+    f->running = running; f->rewinding = rewinding; f->autopilot = autopilot_on;
+    f->ap_decisions = ap_decisions; f->ap_rollouts = ap_rollouts;
+    f->ap_ms = ap_ms; f->ap_max_ms = ap_max_ms;
+    f->turn_seq = turn_seq; f->turn_stamp = turn_stamp; f->turn_state_ms = turn_state_ms;
+    f->turns_buffered = turns_buffered; f->turns_lapsed = turns_lapsed;
+    tbuf_publish(&sim_frames);
+    wake_main();
+}
+
+// Apply one command; true if the published state changed.
+static bool sim_command(Game* gm, const SimCmd* c, bool* run, double* last_step){
+    switch(c->type){
+    case CMD_START:
+        if(c->level) cur_level = c->level;
+        start_game(gm); *last_step = clock_ms();
+        return true;
+    case CMD_RUN:
+        if(c->on && !*run){ *last_step = clock_ms(); snapshot_positions(gm); }
+        if(!c->on) turn_clear();
+        *run = c->on;
+        return true;
+    case CMD_DIR: {
+        bool took_over = autopilot_on;         // a direction key takes control back
+        if(took_over){ autopilot_on = false; sim_note(NOTE_AUTOPILOT_OFF); }
+        turn_press(gm, c->dx, c->dy, c->repeat, c->stamp);
+        return took_over;
+    }
+    case CMD_SAVE:
+        if(rewinding || gm->won || gm->over) return false;
+        snapshot_save(gm, &quick_save); have_quick_save = true;
+        sim_note(NOTE_SAVED);
+        return false;
+    case CMD_LOAD:
+        if(rewinding) return false;
+        if(!have_quick_save){ sim_note(NOTE_NO_SAVE); return false; }
+        load_quick_save(gm); resume_from(gm);
+        *last_step = clock_ms();
+        sim_note(NOTE_LOADED);
+        return true;
+    case CMD_REWIND:
+        if(c->on == rewinding) return false;
+        rewinding = c->on; *last_step = clock_ms();
+        turn_clear();
+        if(!rewinding){
+            snapshot_positions(gm); resume_from(gm);
+            if(!gm->won && !gm->over) sim_note(NOTE_RESUMED);
+        }
+        return true;
+    case CMD_AUTOPILOT:
+        autopilot_on = c->on;
+        return true;
+    case CMD_RELOAD:
+        if(cur_level==c->diff->from) cur_level = c->level;
+        if(gm->level!=c->diff->from) return false;
+        live_apply(gm, c->level, c->diff);
+        // Saved states and the history hold pellets and positions for the old maze.
+        have_quick_save = false;
+        snapring_reset(&history, gm);
+        snapshot_positions(gm);
+        autopilot_invalidate();
+        return true;
+    case CMD_QUIT:
+        return false;
+    }
+    return false;
+}
+
+static int sim_main(void* unused){
+    (void)unused;
+    trace_thread(2);
+    if(telem_log && !telem_attach(telem_log)) SDL_Log("Out of memory for telemetry; nothing is logged");
+    Game game; game_new(&game, 0);
+    bool run = false;
+    double last_step = clock_ms();      // start of the current tick
+    sim_publish(&game, false, last_step, STEP_MS);
+    for(;;){
+        bool changed = false;
+        SimCmd c;
+        while(spsc_pop(&sim_cmds, &c)){
+            if(c.type==CMD_QUIT){ telem_detach(); return 0; }
+            changed |= sim_command(&game, &c, &run, &last_step);
+        }
+
+        double now = clock_ms();
+        double tick_ms = rewinding? (double)STEP_MS/REWIND_SPEED : STEP_MS;
+        bool running = run && !rewinding && !game.won && !game.over;
+        if(rewinding){
+            // Backwards through the history; entities interpolate the same way in reverse.
+            if(now - last_step > 4*tick_ms) last_step = now - tick_ms;
+            while(now - last_step >= tick_ms){
+                last_step += tick_ms; changed = true;
+                if(!rewind_tick(&game)){ last_step = now; break; }
+            }
+        }else if(running){
+            // Fixed ticks; wall-clock only decides how many are due. Catch up after a
+            // slow tick, but drop a long stall (debugger, suspend) instead of
+            // fast-forwarding through it. Either way the outcome depends only on the
+            // inputs and the ticks they land on.
+            if(now - last_step > 4*STEP_MS) last_step = now - STEP_MS;
+            while(!game.won && !game.over && now - last_step >= STEP_MS){
+                last_step += STEP_MS; changed = true;
+                snapshot_positions(&game);
+                TRACE_BEGIN(t_tick);
+                turn_update(&game);
+                autopilot_steer(&game, recorder());
+                int ev = replay_step(recorder(), &game);
+                TRACE_END(t_tick, "tick");
+                turn_shown();
+                snapring_push(&history, &game);
+                autopilot_post(&game);
+                if(ev & (EV_PELLET|EV_POWER)) sim_note(NOTE_CHOMP);
+                if(ev & EV_GHOST_EATEN) sim_note(NOTE_GHOST_EATEN);
+                if(ev & EV_DEATH) sim_note(NOTE_DEATH);
+                if(ev & EV_WON) sim_note(NOTE_WON);
+                else if(ev & EV_OVER) sim_note(NOTE_OVER);
+            }
+            running = !game.won && !game.over;
+        }
+        if(changed) sim_publish(&game, running, last_step, tick_ms);
+
+        // Sleep until the next tick is due or a command arrives; with no ticks due (menus,
+        // pause, end screens) only a command can change anything.
+        if(!running && !rewinding){ SDL_SemWait(sim_wake); continue; }
+        double wait = last_step + tick_ms - clock_ms();
+        if(wait > 0) SDL_SemWaitTimeout(sim_wake, (Uint32)(wait + 0.999));
+    }
+}
+
+// Main thread side.
+static void sim_send(SimCmd c){
+    while(!spsc_push(&sim_cmds, &c)) SDL_Delay(1);
+    SDL_SemPost(sim_wake);
+}
+
+static bool sim_start(void){
+    if(!tbuf_init(&sim_frames, sizeof(SimFrame)) || !spsc_init(&sim_cmds, 256, sizeof(SimCmd)) ||
+       !spsc_init(&sim_notes, 256, sizeof(SimNote)) || !(sim_wake = SDL_CreateSemaphore(0))){
+        SDL_Log("Out of memory for the simulation thread");
+        return false;
+    }
+    sim_thread = SDL_CreateThread(sim_main, "simulation", NULL);
+    if(!sim_thread){ SDL_Log("Could not start the simulation thread: %s", SDL_GetError()); return false; }
+    return true;
+}
+
+static void sim_stop(void){
+    if(sim_thread){ sim_send((SimCmd){ .type = CMD_QUIT }); SDL_WaitThread(sim_thread, NULL); sim_thread = NULL; }
+    if(sim_wake) SDL_DestroySemaphore(sim_wake);
+    sim_wake = NULL;
+    tbuf_free(&sim_frames); spsc_free(&sim_cmds); spsc_free(&sim_notes);
+}
+
+// ===== Live level (--level FILE) =====
+// Play starts the given level instead of the built-in maze, and saving the file puts
+// the edit into the running game. The watcher thread only raises live_changed and
+// wakes the frame loop, which re-reads the file (levelwatch.h) and hands the new
+// generation and its diff to the simulation; only the tiles that changed are patched
+// there and in the board layers, and the ghost tables are rebuilt only for new walls.
+static LiveLevel* live = NULL;
+static LevelWatch* live_watch = NULL;
+static atomic_bool live_changed;
+
+static void live_notify(void* unused){ (void)unused; atomic_store(&live_changed, true); wake_main(); }
+
+static void live_start(const char* path){
+    char err[256];
+    live = live_open(path, err, sizeof err);
+    if(!live){ SDL_Log("Level not loaded, Play uses the built-in maze: %s", err); return; }
+    live_watch = levelwatch_start(path, live_notify, NULL);
+    SDL_Log("Playing %s (\"%s\")%s", path, live_name(live), live_watch ? ", reloaded on save" : "; cannot watch it for changes");
+}
+
+static void live_stop(void){
+    levelwatch_stop(live_watch); live_watch = NULL;
+    live_close(live); live = NULL;
+}
+
+static void live_poll(void){
+    if(!live || !atomic_exchange(&live_changed, false)) return;
+    const LevelDiff* d; LiveTimes t; char err[256];
+    int r = live_reload(live, &d, &t, err, sizeof err);
+    if(r<0){ SDL_Log("Level not reloaded: %s", err); toast("Level has errors (see log)"); return; }
+    if(r==0) return;
+    sim_send((SimCmd){ .type = CMD_RELOAD, .level = live_level(live), .diff = d });
+    SDL_Log("Level reloaded: %d tiles%s%s%s | parse %.2f ms, diff %.3f ms, ghost tables %.2f ms (%s)",
+            d->n, d->walls ? ", walls" : "", d->spawns ? ", spawns" : "", d->phases ? ", schedule" : "",
+            t.parse_ms, t.diff_ms, t.tables_ms, d->walls ? "rebuilt" : "kept");
+    toast("Level reloaded");
+}
+
+// One frame of whatever screen is up.
+static void render_scene(SDL_Renderer* r, TTF_Font* font, const SimFrame* fr, float alpha, bool paused){
+    if(g_state == STATE_PLAYING){
+        TRACE_BEGIN(t_render);
+        render_game(r, &fr->game, fr->prev, alpha, paused && !fr->rewinding, font);
+        render_toast(r, font, fr->rewinding);
+        TRACE_END(t_render, "render_game");
+    }else if(g_state == STATE_MAIN_MENU) render_main_menu(r, font);
+    else if(g_state == STATE_CONTROLS) render_controls_screen(r, font);
+    else if(g_state == STATE_CREDITS) render_credits_screen(r, font);
+}
+
+// ===== Idle rendering =====
+// Menus, the pause menu and the end screens change only when a key is pressed, a toast
+// expires or the simulation answers a command, yet were drawn and presented at the
+// display rate. While one is up the loop now redraws only what changed (menu rows whose
+// highlight moved, a toast appearing or going) into scene_layer under a clip rect,
+// presents once, and blocks in SDL_WaitEvent until the next input, the next deadline
+// (a toast's expiry) or a wake_event from the simulation or audio loader. Anything
+// that moves by itself (play, rewind, the F3 overlay) is drawn every frame as before.
+// --always-redraw draws static screens every frame too, for comparison; the exit log
+// reports the process CPU time spent on static screens either way.
+typedef struct {
+    GameState state;
+    int main_sel, esc_sel;
+    bool esc_menu, locked_msg;
+    const char* toast;              // toast on screen, NULL if none
+} SceneKey;
+
+static SDL_Texture* scene_layer = NULL;     // the static screen last drawn
+static bool scene_valid = false;            // scene_layer matches scene_shown
+static SceneKey scene_shown;
+static bool always_redraw = false;
+static double idle_wall_ms = 0;             // time on static screens, and the CPU it took
+static clock_t idle_cpu = 0;
+static long idle_draws = 0, idle_waits = 0;
+static double idle_area = 0;                // sum of redrawn fractions of the screen
+
+static SceneKey scene_key(void){
+    Uint32 now = SDL_GetTicks();
+    SceneKey k = { g_state, main_sel, esc_sel, esc_menu, locked_msg_until && now < locked_msg_until, NULL };
+    if(g_state==STATE_PLAYING && toast_msg && now < toast_until) k.toast = toast_msg;
+    return k;
+}
+
+static void damage_add(SDL_Rect* d, bool* any, SDL_Rect r){
+    if(*any) SDL_UnionRect(d, &r, d); else *d = r;
+    *any = true;
+}
+
+// The part of the screen that differs from scene_layer; false if none does. A fresh
+// simulation frame or another screen is a full redraw.
+static bool scene_damage(const SceneKey* k, bool fresh, SDL_Rect* d){
+    const SceneKey* o = &scene_shown;
+    if(!scene_valid || fresh || k->state!=o->state || k->esc_menu!=o->esc_menu){
+        *d = (SDL_Rect){ 0, 0, SCREEN_W, SCREEN_H };
+        return true;
+    }
+    bool any = false;
+    if(k->state==STATE_MAIN_MENU){
+        if(k->main_sel!=o->main_sel){ damage_add(d, &any, main_row(o->main_sel)); damage_add(d, &any, main_row(k->main_sel)); }
+        if(k->locked_msg!=o->locked_msg) damage_add(d, &any, main_locked_rect());
+    }
+    if(k->state==STATE_PLAYING){
+        if(k->esc_menu && k->esc_sel!=o->esc_sel){ damage_add(d, &any, esc_row(o->esc_sel)); damage_add(d, &any, esc_row(k->esc_sel)); }
+        if(k->toast!=o->toast) damage_add(d, &any, toast_rect());
+    }
+    return any;
+}
+
+static void scene_destroy(void){
+    if(scene_layer){ SDL_DestroyTexture(scene_layer); scene_layer = NULL; }
+    scene_valid = false;
+}
+
+// Draw the damaged part of a static screen into scene_layer and copy the layer to the
+// back buffer; false if there is no layer (then draw every frame instead).
+static bool scene_draw(SDL_Renderer* r, TTF_Font* font, const SimFrame* fr, bool paused, SDL_Rect d, const SceneKey* k){
+    if(!scene_layer){
+        scene_layer = SDL_CreateTexture(r, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, SCREEN_W, SCREEN_H);
+        tex_allocs_frame++;
+        if(!scene_layer){ SDL_Log("No scene layer, static screens redraw every frame: %s", SDL_GetError()); return false; }
+        SDL_SetTextureBlendMode(scene_layer, SDL_BLENDMODE_NONE);
+    }
+    // The board layers switch render targets to update, which drops the clip rect: bring
+    // them up to date first so render_game() leaves them alone.
+    if(g_state==STATE_PLAYING) layers_sync(r, &fr->game);
+    SDL_SetRenderTarget(r, scene_layer);
+    SDL_RenderSetClipRect(r, &d);
+    render_scene(r, font, fr, 1.0f, paused);
+    SDL_RenderSetClipRect(r, NULL);
+    SDL_SetRenderTarget(r, NULL);
+    SDL_RenderCopy(r, scene_layer, NULL, NULL);
+    TRACE_COUNT(TC_DRAW, 1);
+    scene_shown = *k; scene_valid = true;
+    idle_draws++; idle_area += (double)d.w*d.h/(SCREEN_W*SCREEN_H);
+    return true;
+}
+
+// Sleep until an event arrives or the next deadline passes. Threads push wake_event
+// only while idle_waiting is set, so look for their output once more after setting it.
+static void idle_wait(void){
+    Uint32 now = SDL_GetTicks(), until = 0;
+    if(locked_msg_until > now) until = locked_msg_until;
+    if(g_state==STATE_PLAYING && toast_msg && toast_until > now && (!until || toast_until < until)) until = toast_until;
+    atomic_store_explicit(&idle_waiting, true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);      // pairs with the fence in wake_main()
+    bool pending = tbuf_pending(&sim_frames) || !spsc_empty(&sim_notes) || (!audio_open && SDL_AtomicGet(&audio_ready)) ||
+                   atomic_load(&live_changed);
+    if(!pending){
+        if(until) SDL_WaitEventTimeout(NULL, (int)(until - now));
+        else SDL_WaitEvent(NULL);
+        idle_waits++;
+    }
+    atomic_store_explicit(&idle_waiting, false, memory_order_relaxed);
+}
+
+static void idle_log(void){
+    if(idle_wall_ms <= 0) return;
+    double cpu_ms = (double)idle_cpu*1000.0/CLOCKS_PER_SEC;
+    SDL_Log("Static screens: %.1f s, process CPU %.1f%% of a core (%s); %ld redraws averaging %.0f%% of the screen, %ld waits",
+            idle_wall_ms/1000.0, 100.0*cpu_ms/idle_wall_ms, always_redraw? "--always-redraw" : "idle redraw",
+            idle_draws, idle_draws? 100.0*idle_area/idle_draws : 0.0, idle_waits);
+}
+
+// ===== Render benchmark (--bench-render) =====
+// SDL's software renderer drawing into an offscreen surface, so numbers do not depend
+// on the GPU driver or vsync. The played games are the first 20 of bench_suite's
+// games_x1000 case (same seeds and heading policy); their folded game_hash() must
+// equal RENDER_BENCH_GOLDEN, so a rendering change cannot quietly alter the game.
+#define RENDER_BENCH_GAMES 20
+#define RENDER_BENCH_GOLDEN 0xC36B79A3u
+
+static double bench_ns(Uint64 t0, long ops){
+    return (double)(SDL_GetPerformanceCounter()-t0)*1e9/(double)SDL_GetPerformanceFrequency()/(double)ops;
+}
+
+static int bench_render(int argc, char** argv){
+    int frames=2000;
+    for(int i=2;i<argc;i++) if(strcmp(argv[i],"--frames")==0 && i+1<argc) frames=atoi(argv[++i]);
+    if(frames<1) frames=1;
+    trace_enable(true);                       // for the draw-call counts
+    if(TTF_Init()!=0){ SDL_Log("TTF_Init failed: %s", TTF_GetError()); return 1; }
+    TTF_Font* font = TTF_OpenFontRW(asset_rw(FONT_ASSET), 1, 22);
+    if(!font) SDL_Log("TTF_OpenFont failed, text cases skipped: %s", TTF_GetError());
+    SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_W, SCREEN_H, 32, SDL_PIXELFORMAT_RGBA8888);
+    SDL_Renderer* ren = surf? SDL_CreateSoftwareRenderer(surf) : NULL;
+    if(!ren){ SDL_Log("Software renderer unavailable: %s", SDL_GetError()); if(surf) SDL_FreeSurface(surf); if(font) TTF_CloseFont(font); TTF_Quit(); return 1; }
+    text_sys = text_create(ren, font);
+
+    if(font){
+        // One HUD-like frame: fixed strings (cache hits) plus a score that changes every frame.
+        const char* fixed[] = { "Paused", "Resume", "Retry", "Main Menu", "made by pradnesh", "Press Enter to retry" };
+        const int nfixed = (int)(sizeof fixed / sizeof fixed[0]);
+        TextSys* atlas = text_sys;
+        for(int pass=0;pass<2;pass++){
+            text_sys = pass==0? atlas : NULL;     // glyph atlas, then direct TTF
+            Uint64 t0=SDL_GetPerformanceCounter();
+            for(int f=0;f<frames;f++){
+                char score[32]; SDL_snprintf(score, sizeof score, "SCORE %d", f*10);
+                for(int i=0;i<nfixed;i++) draw_text(ren, font, fixed[i], 20, 20+i*30, (SDL_Color){255,255,255,255});
+                draw_text(ren, font, score, 300, 20, (SDL_Color){255,215,0,255});
+                SDL_RenderFlush(ren);
+                if(text_sys) text_frame_reset(text_sys);
+            }
+            SDL_Log("draw_text %-13s %10.0f ns/call", pass==0? "(atlas)" : "(TTF)", bench_ns(t0, (long)frames*(nfixed+1)));
+        }
+        text_sys = atlas;
+    }
+
+    // Static frame: layers already baked, only copies and the entities, as sprites in
+    // one batch and as flat rects; then without layers, the board batched with them.
+    Game game; game_new(&game, 1);
+    Uint64 t0;
+    for(int pass=0;pass<3;pass++){
+        bool saved = flat_sprites;
+        flat_sprites = pass==1;
+        layers_off = pass==2;
+        render_game(ren, &game, NULL, 1.0f, false, font);
+        SDL_RenderFlush(ren);
+        atomic_store(&trace_counts[TC_DRAW], 0);
+        t0=SDL_GetPerformanceCounter();
+        for(int f=0;f<frames;f++){ render_game(ren, &game, NULL, 1.0f, false, font); SDL_RenderFlush(ren); }
+        SDL_Log("render_game %-18s %10.0f ns/frame  %5.1f draw calls/frame", pass==0 ? (sprite_atlas ? "(sprites)" : "(no atlas)") : pass==1 ? "(flat rects)" : "(no layers)",
+                bench_ns(t0, frames), (double)atomic_load(&trace_counts[TC_DRAW])/frames);
+        flat_sprites = saved;
+    }
+    layers_off = false;
+
+    // Whole games, a tick and a frame at a time; layers are patched as pellets go.
+    uint32_t sum=2166136261u; long ticks=0;
+    t0=SDL_GetPerformanceCounter();
+    for(uint64_t seed=1;seed<=RENDER_BENCH_GAMES;seed++){
+        game_new(&game, seed); uint64_t prng=1000+seed;
+        while(!game.won && !game.over && game.ticks<20000){
+            if(game.ticks%6==0){ int d=(int)(sim_rand(&prng)%4); game_set_dir(&game, NAV_DIRS[d][0], NAV_DIRS[d][1]); }
+            game_step(&game);
+            render_game(ren, &game, NULL, 1.0f, game.won || game.over, font);
+            SDL_RenderFlush(ren);
+            ticks++;
+        }
+        sum=(sum ^ game_hash(&game))*16777619u;
+    }
+    bool ok = sum==RENDER_BENCH_GOLDEN;
+    SDL_Log("games x%d (rendered) %10.0f ns/frame  checksum %08X  %s",
+            RENDER_BENCH_GAMES, bench_ns(t0, ticks), (unsigned)sum, ok? "ok" : "FAIL");
+    if(!ok) SDL_Log("Expected checksum %08X: game behaviour changed", RENDER_BENCH_GOLDEN);
+
+    text_destroy(text_sys); text_sys=NULL;
+    layers_destroy();
+    sprites_destroy();
+    SDL_DestroyRenderer(ren);
+    SDL_FreeSurface(surf);
+    if(font) TTF_CloseFont(font);
+    TTF_Quit();
+    SDL_Quit();
+    return ok? 0 : 1;
+}
+
+// ===== Audio latency test (--audio-test) =====
+// Audio only, no window: opens the device as the game does, fires an effect at
+// irregular intervals and reports trigger-to-output latency, then checks that a music
+// track resumes after a switch. Runs without a sound card under SDL's stand-in drivers:
+//   SDL_AUDIODRIVER=dummy ./pacman2 --audio-test [--audio-buffer N] [--triggers N]
+// (or disk, which writes the mix to sdlaudio.raw). Without the death effect a short
+// tone is made instead, converted to the device format once like a loaded chunk.
+static int audio_test(int argc, char** argv){
+    int triggers = 200;
+    for(int i=2;i<argc;i++){
+        if(strcmp(argv[i],"--audio-buffer")==0 && i+1<argc) audio_buffer = atoi(argv[++i]);
+        else if(strcmp(argv[i],"--triggers")==0 && i+1<argc) triggers = atoi(argv[++i]);
+    }
+    if(triggers < 1) triggers = 1;
+    if(SDL_Init(SDL_INIT_AUDIO|SDL_INIT_TIMER)!=0){ SDL_Log("SDL_Init failed: %s", SDL_GetError()); return 1; }
+    SDL_Log("Audio driver: %s", SDL_GetCurrentAudioDriver() ? SDL_GetCurrentAudioDriver() : "none");
+    assets_open();
+    audio_init(false);
+    audio_poll();
+    if(!audio_open){ assetpack_close(asset_pack); SDL_Quit(); return 1; }
+
+    Uint8* tone = NULL;
+    if(!sfx[SFX_DEATH]){
+        int freq, chans; Uint16 fmt;
+        Mix_QuerySpec(&freq, &fmt, &chans);
+        int n = freq/20;                                // 50 ms, mono S16 at the device rate
+        SDL_AudioCVT cvt;
+        if(SDL_BuildAudioCVT(&cvt, AUDIO_S16SYS, 1, freq, fmt, (Uint8)chans, freq) >= 0 &&
+           (tone = SDL_calloc((size_t)n*2, (size_t)(cvt.len_mult > 0 ? cvt.len_mult : 1)))){
+            Sint16* p = (Sint16*)tone;
+            for(int i=0;i<n;i++) p[i] = (Sint16)((i/(freq/880)) & 1 ? 6000 : -6000);   // 440 Hz square
+            cvt.buf = tone; cvt.len = n*2;
+            if(SDL_ConvertAudio(&cvt)==0) sfx[SFX_DEATH] = Mix_QuickLoad_RAW(tone, (Uint32)cvt.len_cvt);
+        }
+        if(!sfx[SFX_DEATH]){ SDL_Log("No effect to play: %s", SDL_GetError()); audio_quit(); SDL_free(tone); assetpack_close(asset_pack); SDL_Quit(); return 1; }
+    }
+
+    // Each trigger cuts the previous one so a long effect never runs out of channels.
+    uint64_t prng = 7;
+    for(int i=0;i<triggers;i++){
+        Mix_HaltChannel(-1);
+        sfx_play(SFX_DEATH);
+        SDL_Delay(20 + (Uint32)(sim_rand(&prng) % 41));
+        audio_poll();
+    }
+    SDL_Delay(100 + 2*audio_buffer_ms);
+    audio_poll();
+    Mix_HaltChannel(-1);
+    char line[128];
+    trace_latency_line(&lat_sfx, line, sizeof line);
+    SDL_Log("Effect trigger to output, %d-frame buffer (%u ms included), %d triggers: %s", audio_buffer, audio_buffer_ms, triggers, line);
+    trace_latency_chart(&lat_sfx, 2, log_row, NULL);
+    bool ok = lat_sfx.n > 0;
+
+    // Resume: the menu track picks up about where it was stopped, not at zero.
+    if(tracks[MS_MENU].mus && tracks[MS_PAUSE].mus){
+        play_menu_music(); SDL_Delay(1500);
+        play_pause_music(); SDL_Delay(500);
+        play_menu_music();
+        SDL_Log("Menu track resumed at %.2f s after 1.5 s played (pause track stopped at %.2f s)",
+                tracks[MS_MENU].pos, tracks[MS_PAUSE].pos);
+        SDL_Delay(200);
+    }else SDL_Log("Music resume check skipped: menu or pause track missing");
+    audio_log();
+
+    audio_quit();                                       // frees the chunk, not the tone buffer
+    SDL_free(tone);
+    assetpack_close(asset_pack);
+    SDL_Quit();
+    return ok ? 0 : 1;
+}
+
 // ===== main =====
 int main(int argc, char** argv){
-    (void)argc; (void)argv; srand((unsigned int)time(NULL));
+    start_counter = SDL_GetPerformanceCounter();
+    if(argc>1 && strcmp(argv[1],"--headless")==0) return headless_main(argc, argv);
+    if(argc>1 && strcmp(argv[1],"--bench-render")==0) return bench_render(argc, argv);
+    if(argc>1 && strcmp(argv[1],"--audio-test")==0) return audio_test(argc, argv);
+    bool legacy_text=false, vsync=true, sync_assets=false;
+    const char* level_path=NULL;
+    int fps_cap=-1;                       // -1: display-locked; 0: uncapped
+    for(int i=1;i<argc;i++){
+        if(strcmp(argv[i],"--legacy-text")==0) legacy_text=true;
+        else if(strcmp(argv[i],"--no-vsync")==0) vsync=false;
+        else if(strcmp(argv[i],"--sync-assets")==0) sync_assets=true;
+        else if(strcmp(argv[i],"--always-redraw")==0) always_redraw=true;
+        else if(strcmp(argv[i],"--autopilot")==0) autopilot_on=true;
+        else if(strcmp(argv[i],"--fps")==0 && i+1<argc){ fps_cap=atoi(argv[++i]); if(fps_cap<0) fps_cap=0; vsync=false; }
+        else if(strcmp(argv[i],"--record")==0 && i+1<argc) record_path=argv[++i];
+        else if(strcmp(argv[i],"--audio-buffer")==0 && i+1<argc) audio_buffer=atoi(argv[++i]);
+        else if(strcmp(argv[i],"--trace")==0 && i+1<argc){ trace_path=argv[++i]; trace_requested=true; }
+        else if(strcmp(argv[i],"--level")==0 && i+1<argc) level_path=argv[++i];
+        else if(strcmp(argv[i],"--telemetry")==0 && i+1<argc) telem_path=argv[++i];
+        else if(strcmp(argv[i],"--flat-sprites")==0) flat_sprites=true;
+    }
     if(SDL_Init(SDL_INIT_VIDEO|SDL_INIT_TIMER|SDL_INIT_AUDIO)!=0){ SDL_Log("SDL_Init failed: %s", SDL_GetError()); return 1; }
     if(TTF_Init()!=0){ SDL_Log("TTF_Init failed: %s", TTF_GetError()); SDL_Quit(); return 1; }
 
-    // Audio
-    audio_init();
+    // Assets: audio loads in the background (--sync-assets: before the window, as it
+    // used to); the font is needed for the first frame and opens from memory quickly.
+    assets_open();
+    if(autopilot_on) autopilot_on = autopilot_start();
+    wake_event = SDL_RegisterEvents(1);
+    audio_init(!sync_assets);
+    audio_poll();
 
-    TTF_Font* font = TTF_OpenFont("assets/DejaVuSans.ttf", 22);
+    TTF_Font* font = TTF_OpenFontRW(asset_rw(FONT_ASSET), 1, 22);
     if(!font){ SDL_Log("TTF_OpenFont failed: %s", TTF_GetError()); }
 
     SDL_Window* win = SDL_CreateWindow("Pac-Man (C + SDL2)",
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_W, SCREEN_H, 0);
     if(!win){ SDL_Log("CreateWindow failed: %s", SDL_GetError()); if(font) TTF_CloseFont(font); TTF_Quit(); SDL_Quit(); return 1; }
-    SDL_Renderer* ren = SDL_CreateRenderer(win,-1,SDL_RENDERER_ACCELERATED|SDL_RENDERER_PRESENTVSYNC);
+    SDL_Renderer* ren = SDL_CreateRenderer(win,-1,SDL_RENDERER_ACCELERATED|(vsync? SDL_RENDERER_PRESENTVSYNC : 0));
     if(!ren){ SDL_Log("CreateRenderer failed: %s", SDL_GetError()); SDL_DestroyWindow(win); if(font) TTF_CloseFont(font); TTF_Quit(); SDL_Quit(); return 1; }
 
+    // Pacing: trust vsync when the renderer has it, else cap at the display rate
+    // (or --fps N; --fps 0 or --no-vsync alone is uncapped).
+    Pacer pacer = {0, 0};
+    SDL_RendererInfo rinfo;
+    if(vsync && SDL_GetRendererInfo(ren, &rinfo)==0 && (rinfo.flags & SDL_RENDERER_PRESENTVSYNC)){
+        SDL_snprintf(pacing_desc, sizeof pacing_desc, "vsync");
+    }else{
+        if(vsync){
+            SDL_DisplayMode mode;
+            int hz = SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(win), &mode)==0 && mode.refresh_rate>0 ? mode.refresh_rate : FALLBACK_HZ;
+            fps_cap = hz;
+            SDL_Log("No vsync from the renderer; capping at %d fps", hz);
+        }else if(fps_cap<0) fps_cap = 0;
+        pacer.frame_ms = fps_cap>0 ? 1000.0/fps_cap : 0;
+        if(fps_cap>0) SDL_snprintf(pacing_desc, sizeof pacing_desc, "cap %d fps", fps_cap);
+        else SDL_snprintf(pacing_desc, sizeof pacing_desc, "uncapped");
+    }
+    if(!legacy_text) text_sys = text_create(ren, font);
+    load_level_pack();
+    if(level_path) live_start(level_path);
+
     // Start on main menu instead of gameplay
     g_state = STATE_MAIN_MENU;
     play_menu_music();
 
-    // Prepare gameplay state (will be reset on Play)
-    reset_board();
-    Entity pac; Ghost ghosts[4]; place_starts(&pac, ghosts);
+    // The game itself lives on the simulation thread (reset on Play).
+    if(!snapring_init(&history, REWIND_TICKS)) SDL_Log("No memory for rewind history; rewind disabled");
+    trace_set_clock(perf_counter, SDL_GetPerformanceFrequency());
+    trace_enable(true);
+    if(telem_path){
+        char err[256];
+        if(!(telem_log = telem_open(telem_path, err, sizeof err))) SDL_Log("%s", err);
+    }
+    if(!sim_start()){
+        sim_stop(); telem_finish(); snapring_free(&history); autopilot_quit();
+        text_destroy(text_sys); layers_destroy(); sprites_destroy(); levelpack_close(level_pack); live_stop();
+        if(font) TTF_CloseFont(font);
+        audio_quit(); assetpack_close(asset_pack);
+        TTF_Quit(); SDL_DestroyRenderer(ren); SDL_DestroyWindow(win); SDL_Quit();
+        return 1;
+    }
 
-    int lives=3, score=0, pellets=count_pellets();
-    bool running=true, game_won=false, over=false, paused=false;
-    Uint32 last_step=SDL_GetTicks(), last_ghost=last_step;
-    int eat_streak=0;
+    bool running=true, sim_run=false, rewind_held=false;
+    bool shown_final=false;                 // the last frame drew its tick at alpha 1
+
+    int text_textures = text_stats(text_sys).textures_created;
+    bool first_frame=true;
 
     while(running){
+        double loop_ms = clock_ms();
+        clock_t loop_cpu = clock();
+        audio_poll();
+        // Newest published state; this frame's input is judged against it.
+        bool fresh;
+        const SimFrame* fr = tbuf_read(&sim_frames, &fresh);
+        bool game_won = fr->game.won, over = fr->game.over;
+        bool paused = esc_menu || game_won || over;
+        bool turn_new = fr->turn_seq != turns_seen;
+        if(turn_new){ turns_seen = fr->turn_seq; trace_latency_add(&lat_state, fr->turn_state_ms); }
+
+        // Notes from the simulation
+        SimNote note;
+        while(spsc_pop(&sim_notes, &note)){
+            switch(note){
+            case NOTE_DEATH: sfx_play(SFX_DEATH); break;
+            case NOTE_CHOMP: sfx_play(SFX_CHOMP); break;
+            case NOTE_GHOST_EATEN: sfx_play(SFX_GHOST_EATEN); break;
+            case NOTE_WON: play_victory_music(); break;
+            case NOTE_OVER: play_pause_music(); break;   // victory music only for wins
+            case NOTE_SAVED: toast("State saved"); break;
+            case NOTE_LOADED: play_game_music(); toast("State loaded"); break;
+            case NOTE_NO_SAVE: toast("No saved state"); break;
+            case NOTE_RESUMED: if(!esc_menu) play_game_music(); break;
+            case NOTE_AUTOPILOT_OFF: toast("Autopilot off"); break;
+            }
+        }
+        live_poll();
+
         // Events
+        TRACE_BEGIN(t_events);
         SDL_Event e;
         while(SDL_PollEvent(&e)){
             if(e.type==SDL_QUIT) running=false;
+            else if(e.type==SDL_RENDER_TARGETS_RESET || e.type==SDL_RENDER_DEVICE_RESET){
+                // Target texture contents were lost (e.g. Direct3D device reset): re-bake.
+                if(e.type==SDL_RENDER_DEVICE_RESET){ layers_destroy(); scene_destroy(); sprites_destroy(); layers_off = false; }
+                layers_valid = scene_valid = false;
+            }
+            else if(e.type==SDL_WINDOWEVENT) scene_valid = false;    // exposed, restored, resized: present again
             else if(e.type==SDL_KEYDOWN){
                 SDL_Keycode k=e.key.keysym.sym;
+                if(k==SDLK_F3){ show_stats = !show_stats; continue; }
+                if(k==SDLK_F4){ trace_write(); continue; }
 
                 // Global: in menu/controls/credits, ESC often goes back or quits
                 if(g_state == STATE_MAIN_MENU){
@@ -525,18 +1868,15 @@ int main(int argc, char** argv){
                     if(k==SDLK_UP || k==SDLK_w){ main_sel = (main_sel + MAIN_COUNT - 1)%MAIN_COUNT; continue; }
                     if(k==SDLK_DOWN || k==SDLK_s){ main_sel = (main_sel + 1)%MAIN_COUNT; continue; }
                     if(k==SDLK_RETURN || k==SDLK_KP_ENTER || k==SDLK_SPACE){
-                        if(main_sel==0){
-                            // Play
-                            reset_board();
-                            place_starts(&pac, ghosts);
-                            lives=3; score=0; pellets=count_pellets();
-                            game_won=false; over=false; paused=false; eat_streak=0;
-                            last_step=last_ghost=SDL_GetTicks();
+                        const Level* lv = main_sel==0 ? (live ? live_level(live) : &LEVEL_CLASSIC) : main_sel==1 ? pack_level(1) : NULL;
+                        if(lv){
+                            // Play / Level 2
+                            sim_send((SimCmd){ .type = CMD_START, .level = lv });
                             g_state = STATE_PLAYING;
                             // Switch to gameplay music
                             play_game_music();
                         }else if(main_sel==1){
-                            // Locked level
+                            // Locked level (no pack)
                             locked_msg_until = SDL_GetTicks() + 1500;
                         }else if(main_sel==2){
                             g_state = STATE_CONTROLS;
@@ -556,32 +1896,39 @@ int main(int argc, char** argv){
                     }
                 }else if(g_state == STATE_PLAYING){
                     // ===== In-game handling (original behavior) =====
-
                     // ESC toggles the pause menu unless the end screen is up
                     if(k==SDLK_ESCAPE){
                         if(esc_menu){
                             esc_menu=false;
-                            paused = (game_won || over);
                             // Resume correct track
-                            if(!paused && !game_won && !over) play_game_music();
+                            if(!game_won && !over) play_game_music();
                         }else if(!over && !game_won){
                             esc_menu=true;
-                            paused=true;
                             esc_sel = 0;
                             // Switch to pause music
                             play_pause_music();
                         }
+                        paused = esc_menu || game_won || over;
+                        continue;
+                    }
+
+                    if(k==SDLK_F6 && !esc_menu){
+                        bool on = !fr->autopilot && autopilot_start();
+                        sim_send((SimCmd){ .type = CMD_AUTOPILOT, .on = on });
+                        toast(on? "Autopilot on" : "Autopilot off");
+                        continue;
+                    }
+
+                    // Save-states (rewind is polled below, while Backspace is held)
+                    if(!esc_menu && (k==SDLK_F5 || k==SDLK_F9)){
+                        sim_send((SimCmd){ .type = k==SDLK_F5 ? CMD_SAVE : CMD_LOAD });
                         continue;
                     }
 
                     // If end screen is up (game over/win), allow retry via Enter/Space/R
                     if(paused && (over || game_won) && !esc_menu){
                         if(k==SDLK_RETURN || k==SDLK_KP_ENTER || k==SDLK_SPACE || k=='r'){
-                            reset_board();
-                            place_starts(&pac, ghosts);
-                            lives=3; score=0; pellets=count_pellets();
-                            game_won=false; over=false; paused=false; eat_streak=0;
-                            last_step=last_ghost=SDL_GetTicks();
+                            sim_send((SimCmd){ .type = CMD_START });
                             // Back to gameplay music
                             play_game_music();
                         }
@@ -595,151 +1942,136 @@ int main(int argc, char** argv){
                         else if(k==SDLK_RETURN || k==SDLK_KP_ENTER || k==SDLK_SPACE){
                             if(esc_sel==0){
                                 // Resume
-                                esc_menu=false; paused=false;
+                                esc_menu=false;
                                 play_game_music();
                             }else if(esc_sel==1){
                                 // Retry
-                                reset_board();
-                                place_starts(&pac, ghosts);
-                                lives=3; score=0; pellets=count_pellets();
-                                game_won=false; over=false; paused=false; eat_streak=0;
-                                last_step=last_ghost=SDL_GetTicks();
+                                sim_send((SimCmd){ .type = CMD_START });
                                 esc_menu=false;
                                 play_game_music();
                             }else if(esc_sel==2){
                                 // Main Menu
                                 go_to_main_menu();
-                                paused=false;
                                 play_menu_music();
                             }
                         }else if(k=='r'){
                             // quick retry shortcut in menu
-                            reset_board();
-                            place_starts(&pac, ghosts);
-                            lives=3; score=0; pellets=count_pellets();
-                            game_won=false; over=false; paused=false; eat_streak=0;
-                            last_step=last_ghost=SDL_GetTicks();
+                            sim_send((SimCmd){ .type = CMD_START });
                             esc_menu=false;
                             play_game_music();
                         }
+                        paused = esc_menu || game_won || over;
                         continue;
                     }
 
                     // Gameplay input (only when not paused by menu or end screen)
                     if(!paused){
-                        if(k==SDLK_LEFT || k==SDLK_a){ ((Entity*)&pac)->dx=-1; ((Entity*)&pac)->dy=0; }
-                        else if(k==SDLK_DOWN || k==SDLK_s){ ((Entity*)&pac)->dx=0; ((Entity*)&pac)->dy=1; }
-                        else if(k==SDLK_UP || k==SDLK_w){ ((Entity*)&pac)->dx=0; ((Entity*)&pac)->dy=-1; }
-                        else if(k==SDLK_RIGHT || k==SDLK_d){ ((Entity*)&pac)->dx=1; ((Entity*)&pac)->dy=0; }
+                        int dx=0, dy=0;
+                        if(k==SDLK_LEFT || k==SDLK_a) dx=-1;
+                        else if(k==SDLK_DOWN || k==SDLK_s) dy=1;
+                        else if(k==SDLK_UP || k==SDLK_w) dy=-1;
+                        else if(k==SDLK_RIGHT || k==SDLK_d) dx=1;
+                        if(dx || dy) sim_send((SimCmd){ .type = CMD_DIR, .dx = dx, .dy = dy, .repeat = e.key.repeat, .stamp = e.key.timestamp });
                     }
                 }
             }
         }
 
-        Uint32 now=SDL_GetTicks();
+        // The simulation ticks only while a game is on screen and not paused; rewind
+        // runs while Backspace is held.
+        bool want_run = g_state==STATE_PLAYING && !esc_menu;
+        if(want_run != sim_run){ sim_send((SimCmd){ .type = CMD_RUN, .on = want_run }); sim_run = want_run; }
+        bool held = want_run && SDL_GetKeyboardState(NULL)[SDL_SCANCODE_BACKSPACE];
+        if(held != rewind_held){ sim_send((SimCmd){ .type = CMD_REWIND, .on = held }); rewind_held = held; }
+
+        TRACE_END(t_events, "events");
+        double now=clock_ms();
 
         // ===== Scene update + render =====
-        if(g_state == STATE_PLAYING){
-            if(!paused) maybe_switch_modes(ghosts, now);
-
-            // Pac-Man step
-            if(now - last_step >= STEP_MS && !paused){
-                last_step=now;
-                int nx=pac.x+pac.dx, ny=pac.y+pac.dy;
-                if(passable_for_pac(nx,ny)){
-                    pac.x=nx; pac.y=ny; wrap(&pac);
-                    char c = in_bounds(pac.x,pac.y)? board[pac.y][pac.x] : ' ';
-                    if(c=='.'){ board[pac.y][pac.x]=' '; score+=10; pellets--; eat_streak=0; }
-                    else if(c=='o'){ board[pac.y][pac.x]=' '; score+=50; pellets--; eat_streak=0; set_frightened(ghosts); }
-                    if(pellets<=0){
-                        game_won=true; paused=true;
-                        play_victory_music();
-                    }
-                }
+        // Entities are drawn between their last two tiles by the time since the tick.
+        // A frame that finds no new tick after one already drawn at its end position
+        // repeats the picture: the simulation is late.
+        bool moving = g_state==STATE_PLAYING && (fr->running || fr->rewinding) && !esc_menu;
+        bool still = !moving && !show_stats;    // nothing on screen changes by itself
+        float alpha = 1.0f;
+        if(moving){
+            double t = (now - fr->tick_at)/fr->tick_ms;
+            if(!fresh && t >= 1.0 && shown_final) frames_duplicated++;
+            shown_final = t >= 1.0;
+            alpha = t < 0 ? 0.0f : t > 1.0 ? 1.0f : (float)t;
+        }else shown_final = false;
+        if(g_state==STATE_MAIN_MENU && mus_state!=MS_MENU) play_menu_music();   // keep menu music rolling
+
+        bool present = true;
+        if(still && !always_redraw){
+            SceneKey key = scene_key();
+            SDL_Rect damage;
+            present = scene_damage(&key, fresh, &damage);
+            if(present && !scene_draw(ren, font, fr, paused, damage, &key)){
+                always_redraw = true;
+                render_scene(ren, font, fr, alpha, paused);
             }
+        }else{
+            scene_valid = false;
+            render_scene(ren, font, fr, alpha, paused);
+        }
 
-            // Ghost step
-            if(now - last_ghost >= GHOST_MS && !paused){
-                last_ghost=now;
-                for(int i=0;i<4;i++){
-                    // frightened expiry: return to current schedule phase
-                    if(ghosts[i].mode==MODE_FRIGHT && now>=ghosts[i].fright_timer){
-                        ghosts[i].mode = current_phase_mode();
-                    }
-
-                    if(ghosts[i].mode==MODE_FRIGHT){
-                        // random only in frightened
-                        static const int dirs[4][2]={{1,0},{-1,0},{0,1},{0,-1}};
-                        int idx = rand()%4;
-                        ghosts[i].e.dx = dirs[idx][0]; ghosts[i].e.dy = dirs[idx][1];
-                    }else{
-                        Point src={ghosts[i].e.x,ghosts[i].e.y};
-                        Point tgt=ghost_target((GhostId)i, pac, ghosts);
-                        if(tgt.x<0)tgt.x=0; if(tgt.x>=MAP_W)tgt.x=MAP_W-1;
-                        if(tgt.y<0)tgt.y=0; if(tgt.y>=MAP_H)tgt.y=MAP_H-1;
-
-                        Point step=next_step_bfs(src,tgt,passable_for_ghost);
-                        int ndx=step.x-ghosts[i].e.x, ndy=step.y-ghosts[i].e.y;
-                        if(ndx||ndy){
-                            ghosts[i].e.dx = (ndx>0)?1:(ndx<0)?-1:0;
-                            ghosts[i].e.dy = (ndy>0)?1:(ndy<0)?-1:0;
-                        }else{
-                            choose_dir_toward(&ghosts[i].e, tgt, passable_for_ghost);
-                        }
-                    }
-
-                    ghosts[i].e.x += ghosts[i].e.dx;
-                    ghosts[i].e.y += ghosts[i].e.dy;
-                    if(ghosts[i].e.x<0) ghosts[i].e.x=MAP_W-1; if(ghosts[i].e.x>=MAP_W) ghosts[i].e.x=0;
-                    if(!passable_for_ghost(ghosts[i].e.x,ghosts[i].e.y)){
-                        ghosts[i].e.x -= ghosts[i].e.dx;
-                        ghosts[i].e.y -= ghosts[i].e.dy;
-                        ghosts[i].e.dx = -ghosts[i].e.dx;
-                        ghosts[i].e.dy = -ghosts[i].e.dy;
-                    }
-                }
-
-                // Collisions
-                for(int i=0;i<4;i++){
-                    if(pac.x==ghosts[i].e.x && pac.y==ghosts[i].e.y){
-                        if(ghosts[i].mode==MODE_FRIGHT){
-                            int pts = 200 << (eat_streak>3?3:eat_streak);
-                            score += pts; eat_streak++;
-                            ghosts[i].e.x=ghosts[i].e.startx; ghosts[i].e.y=ghosts[i].e.starty;
-                            ghosts[i].mode = current_phase_mode();
-                            ghosts[i].fright_timer=0;
-                        }else{
-                            lives--;
-                            // Play death sfx
-                            if(sfx_death) Mix_PlayChannel(-1, sfx_death, 0);
-                            if(lives<=0){
-                                over=true; paused=true;
-                                // Optional: switch to pause music for end screen; keep victory only for wins
-                                play_pause_music();
-                            }
-                            reset_positions(&pac, ghosts);
-                            break;
-                        }
-                    }
-                }
+        if(present){
+            int created = text_stats(text_sys).textures_created;
+            int tex_allocs = tex_allocs_frame + created - text_textures;
+            text_textures = created; tex_allocs_frame = 0;
+            if(show_stats) render_stats(ren, font, tex_allocs, fr);
+            TRACE_BEGIN(t_present);
+            SDL_RenderPresent(ren);
+            TRACE_END(t_present, "SDL_RenderPresent");
+            if(turn_new) trace_latency_add(&lat_present, SDL_GetTicks() - fr->turn_stamp);
+            text_frame_reset(text_sys);
+            if(first_frame){
+                SDL_Log("First frame %.1f ms after start (%s, %s audio)", ms_since_start(),
+                        asset_pack? "asset archive" : "loose files", sync_assets? "blocking" : "background");
+                first_frame=false;
             }
-
-            render_game(ren, pac, ghosts, score, lives, game_won, over, paused, font);
-        }else if(g_state == STATE_MAIN_MENU){
-            // Keep menu music rolling
-            if(mus_state!=MS_MENU) play_menu_music();
-            render_main_menu(ren, font);
-        }else if(g_state == STATE_CONTROLS){
-            render_controls_screen(ren, font);
-        }else if(g_state == STATE_CREDITS){
-            render_credits_screen(ren, font);
         }
 
-        SDL_Delay(1000/FPS);
+        if(still && !always_redraw){
+            if(present) trace_frame_end();
+            idle_wait();
+            trace_frame_restart();
+        }else{
+            TRACE_BEGIN(t_pace);
+            pacer_wait(&pacer);
+            TRACE_END(t_pace, "pacer_wait");
+            trace_frame_end();
+        }
+        if(still){ idle_wall_ms += clock_ms() - loop_ms; idle_cpu += clock() - loop_cpu; }
     }
 
+    TraceFrameStats fs = trace_frame_stats();
+    if(fs.frames) SDL_Log("Frame time over the last %d frames (%s): mean %.2f ms, p50 %.2f, p95 %.2f, p99 %.2f, max %.2f, jitter %.2f ms",
+                          fs.frames, pacing_desc, fs.mean_ms, fs.p50_ms, fs.p95_ms, fs.p99_ms, fs.max_ms, fs.jitter_ms);
+    SDL_Log("Simulation frames: %u published, %u dropped unseen, %ld frames duplicated waiting for a tick",
+            (unsigned)atomic_load(&sim_frames.published), (unsigned)atomic_load(&sim_frames.overwritten), frames_duplicated);
+
+    sim_stop();                         // the simulation's state is ours again from here
+    telem_finish();
+    latency_log();
+    idle_log();
+    audio_log();
+    autopilot_log();
+    autopilot_quit();
+    if(trace_requested) trace_write();
+    record_flush();
+    replay_free(&input_log);
+    snapring_free(&history);
+    layers_destroy();
+    scene_destroy();
+    sprites_destroy();
+    levelpack_close(level_pack);
+    live_stop();
+    text_destroy(text_sys);
     if(font) TTF_CloseFont(font);
     audio_quit();
+    assetpack_close(asset_pack);        // after everything streaming from it
     TTF_Quit();
     SDL_DestroyRenderer(ren); SDL_DestroyWindow(win); SDL_Quit();
     return 0;
@@ -0,0 +1,165 @@
+// pool.c — pthread work-stealing pool. A worker's remaining chunks are one packed
+// 64-bit [lo, hi) range; the owner pops lo and thieves split off the top half, both
+// by compare-and-swap, so neither side ever holds a lock while chunks run.
+
+#define _POSIX_C_SOURCE 200809L
+#include "pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef struct { _Atomic uint64_t range; char pad[56]; } Deque;   // one cache line each
+
+struct Pool {
+    int nthreads;
+    pthread_t* threads;
+    Deque* deque;
+    pthread_mutex_t mu;
+    pthread_cond_t wake, done;
+    unsigned long generation;
+    int busy;
+    bool quit;
+    PoolFn fn; void* ctx;
+    _Atomic long steals;
+};
+
+typedef struct { Pool* p; int id; } WorkerArg;
+
+static inline uint64_t pack(uint32_t lo, uint32_t hi){ return (uint64_t)hi<<32 | lo; }
+
+int pool_cpu_count(void){
+#ifdef _WIN32
+    SYSTEM_INFO si; GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (int)si.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static bool pop_front(Deque* d, uint32_t* chunk){
+    uint64_t r = atomic_load(&d->range);
+    for(;;){
+        uint32_t lo=(uint32_t)r, hi=(uint32_t)(r>>32);
+        if(lo>=hi) return false;
+        if(atomic_compare_exchange_weak(&d->range, &r, pack(lo+1,hi))){ *chunk=lo; return true; }
+    }
+}
+
+// Take the upper half of a victim's range (at least one chunk); false if it is empty.
+static bool steal_half(Deque* d, uint32_t* lo_out, uint32_t* hi_out){
+    uint64_t r = atomic_load(&d->range);
+    for(;;){
+        uint32_t lo=(uint32_t)r, hi=(uint32_t)(r>>32);
+        if(lo>=hi) return false;
+        uint32_t mid = lo + (hi-lo)/2;
+        if(atomic_compare_exchange_weak(&d->range, &r, pack(lo,mid))){ *lo_out=mid; *hi_out=hi; return true; }
+    }
+}
+
+static void work(Pool* p, int id){
+    Deque* own = &p->deque[id];
+    for(;;){
+        uint32_t c;
+        while(pop_front(own,&c)) p->fn(p->ctx, (int)c, id);
+        bool stole=false;
+        for(int k=1;k<p->nthreads && !stole;k++){
+            uint32_t lo, hi;
+            if(steal_half(&p->deque[(id+k)%p->nthreads], &lo, &hi)){
+                atomic_store(&own->range, pack(lo,hi));
+                atomic_fetch_add(&p->steals, 1);
+                stole=true;
+            }
+        }
+        if(!stole) return;       // every range was empty when looked at: the job is drained
+    }
+}
+
+static void* worker_main(void* arg){
+    WorkerArg* wa = arg;
+    Pool* p = wa->p; int id = wa->id;
+    free(wa);
+    unsigned long seen = 0;
+    pthread_mutex_lock(&p->mu);
+    for(;;){
+        while(!p->quit && p->generation==seen) pthread_cond_wait(&p->wake, &p->mu);
+        if(p->quit) break;
+        seen = p->generation;
+        pthread_mutex_unlock(&p->mu);
+        work(p, id);
+        pthread_mutex_lock(&p->mu);
+        if(--p->busy==0) pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->mu);
+    return NULL;
+}
+
+Pool* pool_create(int threads){
+    if(threads<=0) threads = pool_cpu_count();
+    Pool* p = calloc(1, sizeof *p);
+    if(!p) return NULL;
+    p->nthreads = threads;
+    p->deque = calloc((size_t)threads, sizeof(Deque));
+    p->threads = calloc((size_t)threads, sizeof *p->threads);
+    if(!p->deque || !p->threads){ free(p->deque); free(p->threads); free(p); return NULL; }
+    for(int i=0;i<threads;i++) atomic_init(&p->deque[i].range, 0);
+    atomic_init(&p->steals, 0);
+    pthread_mutex_init(&p->mu, NULL);
+    pthread_cond_init(&p->wake, NULL); pthread_cond_init(&p->done, NULL);
+    for(int i=1;i<threads;i++){
+        WorkerArg* wa = malloc(sizeof *wa);
+        if(wa){ wa->p=p; wa->id=i; }
+        if(!wa || pthread_create(&p->threads[i], NULL, worker_main, wa)!=0){
+            free(wa);
+            p->nthreads = i;     // shut down the ones that did start
+            pool_destroy(p);
+            return NULL;
+        }
+    }
+    return p;
+}
+
+void pool_destroy(Pool* p){
+    if(!p) return;
+    pthread_mutex_lock(&p->mu);
+    p->quit = true;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->mu);
+    for(int i=1;i<p->nthreads;i++) pthread_join(p->threads[i], NULL);
+    pthread_mutex_destroy(&p->mu);
+    pthread_cond_destroy(&p->wake); pthread_cond_destroy(&p->done);
+    free(p->deque); free(p->threads); free(p);
+}
+
+int pool_threads(const Pool* p){ return p->nthreads; }
+long pool_steals(const Pool* p){ return atomic_load(&((Pool*)p)->steals); }
+
+void pool_run(Pool* p, int chunks, PoolFn fn, void* ctx){
+    if(chunks<=0) return;
+    int n = p->nthreads;
+    p->fn = fn; p->ctx = ctx;
+    for(int i=0;i<n;i++){
+        uint32_t lo = (uint32_t)((long long)chunks*i/n), hi = (uint32_t)((long long)chunks*(i+1)/n);
+        atomic_store(&p->deque[i].range, pack(lo,hi));
+    }
+    if(n>1){
+        pthread_mutex_lock(&p->mu);
+        p->busy = n-1;
+        p->generation++;
+        pthread_cond_broadcast(&p->wake);
+        pthread_mutex_unlock(&p->mu);
+    }
+    work(p, 0);
+    if(n>1){
+        pthread_mutex_lock(&p->mu);
+        while(p->busy>0) pthread_cond_wait(&p->done, &p->mu);
+        pthread_mutex_unlock(&p->mu);
+    }
+}
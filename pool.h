@@ -0,0 +1,26 @@
+// pool.h — fixed thread pool that runs numbered chunks of one job with work stealing.
+// Each worker starts with an even share of the chunk range and takes from its front;
+// a worker that runs dry steals the back half of another worker's remaining range.
+#ifndef PACMAN_POOL_H
+#define PACMAN_POOL_H
+
+typedef struct Pool Pool;
+
+// fn runs once per chunk index in [0, chunks); worker is 0..pool_threads()-1.
+typedef void (*PoolFn)(void* ctx, int chunk, int worker);
+
+// threads <= 0 means one per online CPU. The calling thread is worker 0, so
+// threads==1 runs everything inline. NULL if threads could not be started.
+Pool* pool_create(int threads);
+void pool_destroy(Pool* p);
+int pool_threads(const Pool* p);
+
+// Run every chunk and return when all are done. Not reentrant.
+void pool_run(Pool* p, int chunks, PoolFn fn, void* ctx);
+
+// Successful steals since pool_create(), for reporting load balance.
+long pool_steals(const Pool* p);
+
+int pool_cpu_count(void);
+
+#endif
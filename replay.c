@@ -0,0 +1,153 @@
+// replay.c — input-log recording, (de)serialization and lockstep re-simulation.
+
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_MAGIC "PMIL"
+#define LOG_VERSION 2          // 2: game_hash() covers the bit planes
+
+static bool grow(void** p, uint32_t* cap, uint32_t need, size_t elem){
+    if(need <= *cap) return true;
+    uint32_t n = *cap ? *cap : 128;
+    while(n < need) n = n > UINT32_MAX/2 ? need : n*2;
+    if((size_t)n > SIZE_MAX/elem) return false;
+    void* q = realloc(*p, (size_t)n*elem);
+    if(!q) return false;
+    *p = q; *cap = n;
+    return true;
+}
+
+static int sign(int v){ return (v>0) - (v<0); }
+
+void replay_begin(InputLog* log, Game* gm, uint64_t seed){
+    if(log){ log->seed = seed; log->nev = 0; log->ticks = 0; }
+    game_new(gm, seed);
+}
+
+void replay_set_dir(InputLog* log, Game* gm, int dx, int dy){
+    dx = sign(dx); dy = sign(dy);
+    if(gm->pac.dx==dx && gm->pac.dy==dy) return;     // no state change, nothing to record
+    game_set_dir(gm, dx, dy);
+    if(log && grow((void**)&log->ev, &log->cap_ev, log->nev+1, sizeof *log->ev))
+        log->ev[log->nev++] = (InputEvent){ gm->ticks, (int8_t)dx, (int8_t)dy };
+}
+
+int replay_step(InputLog* log, Game* gm){
+    uint32_t before = gm->ticks;
+    int ev = game_step(gm);
+    if(log && gm->ticks != before && grow((void**)&log->hash, &log->cap_hash, log->ticks+1, sizeof *log->hash))
+        log->hash[log->ticks++] = game_hash(gm);
+    return ev;
+}
+
+void replay_rewind(InputLog* log, const Game* gm){
+    if(!log) return;
+    if(log->ticks > gm->ticks) log->ticks = gm->ticks;
+    while(log->nev && log->ev[log->nev-1].tick >= gm->ticks) log->nev--;
+    if(grow((void**)&log->ev, &log->cap_ev, log->nev+1, sizeof *log->ev))
+        log->ev[log->nev++] = (InputEvent){ gm->ticks, (int8_t)gm->pac.dx, (int8_t)gm->pac.dy };
+}
+
+void replay_free(InputLog* log){
+    free(log->ev); free(log->hash);
+    memset(log, 0, sizeof *log);
+}
+
+// ===== File format =====
+static void put_u32(FILE* f, uint32_t v){ for(int i=0;i<4;i++) fputc((int)(v>>(8*i)) & 0xFF, f); }
+static void put_u64(FILE* f, uint64_t v){ put_u32(f,(uint32_t)v); put_u32(f,(uint32_t)(v>>32)); }
+static void put_varint(FILE* f, uint32_t v){
+    while(v >= 0x80){ fputc((int)(v & 0x7F) | 0x80, f); v >>= 7; }
+    fputc((int)v, f);
+}
+
+static bool get_u32(FILE* f, uint32_t* v){
+    *v = 0;
+    for(int i=0;i<4;i++){ int c=fgetc(f); if(c==EOF) return false; *v |= (uint32_t)c << (8*i); }
+    return true;
+}
+static bool get_u64(FILE* f, uint64_t* v){
+    uint32_t lo, hi;
+    if(!get_u32(f,&lo) || !get_u32(f,&hi)) return false;
+    *v = (uint64_t)hi<<32 | lo;
+    return true;
+}
+static bool get_varint(FILE* f, uint32_t* v){
+    *v = 0;
+    for(int shift=0; shift<35; shift+=7){
+        int c=fgetc(f); if(c==EOF) return false;
+        *v |= (uint32_t)(c & 0x7F) << shift;
+        if(!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+// An event is one varint: tick delta from the previous event, then dx+1 and dy+1 in two bits each.
+bool replay_save(const InputLog* log, const char* path){
+    FILE* f = fopen(path, "wb");
+    if(!f) return false;
+    fwrite(LOG_MAGIC, 1, 4, f); fputc(LOG_VERSION, f);
+    put_u64(f, log->seed); put_u32(f, log->nev); put_u32(f, log->ticks);
+    uint32_t prev = 0;
+    for(uint32_t i=0;i<log->nev;i++){
+        const InputEvent* e = &log->ev[i];
+        put_varint(f, (e->tick-prev)<<4 | (uint32_t)(e->dx+1) | (uint32_t)(e->dy+1)<<2);
+        prev = e->tick;
+    }
+    for(uint32_t i=0;i<log->ticks;i++) put_u32(f, log->hash[i]);
+    bool ok = !ferror(f);
+    return fclose(f)==0 && ok;
+}
+
+bool replay_load(InputLog* log, const char* path){
+    memset(log, 0, sizeof *log);
+    FILE* f = fopen(path, "rb");
+    if(!f) return false;
+    char magic[4]; uint32_t nev, ticks;
+    bool ok = fread(magic,1,4,f)==4 && !memcmp(magic,LOG_MAGIC,4) && fgetc(f)==LOG_VERSION
+           && get_u64(f,&log->seed) && get_u32(f,&nev) && get_u32(f,&ticks);
+    // The counts must fit in what follows (an event is at least one byte, a hash four)
+    // before anything is allocated for them.
+    long at = ok ? ftell(f) : -1, end = -1;
+    if(at >= 0 && fseek(f, 0, SEEK_END)==0) end = ftell(f);
+    ok = ok && end >= at && at >= 0 && fseek(f, at, SEEK_SET)==0
+           && (uint64_t)nev + 4*(uint64_t)ticks <= (uint64_t)(end - at)
+           && grow((void**)&log->ev, &log->cap_ev, nev, sizeof *log->ev)
+           && grow((void**)&log->hash, &log->cap_hash, ticks, sizeof *log->hash);
+    uint32_t tick = 0;
+    for(uint32_t i=0; ok && i<nev; i++){
+        uint32_t v;
+        ok = get_varint(f,&v) && (v & 3)!=3 && ((v>>2) & 3)!=3;
+        if(!ok) break;
+        tick += v>>4;
+        log->ev[log->nev++] = (InputEvent){ tick, (int8_t)((int)(v & 3)-1), (int8_t)((int)((v>>2) & 3)-1) };
+    }
+    for(uint32_t i=0; ok && i<ticks; i++){ ok = get_u32(f,&log->hash[i]); if(ok) log->ticks++; }
+    fclose(f);
+    if(!ok) replay_free(log);
+    return ok;
+}
+
+// ===== Re-simulation =====
+bool replay_run_each(const InputLog* log, Game* out, uint32_t* bad_tick,
+                     void (*on_tick)(void* ctx, const Game* gm), void* ctx){
+    game_new(out, log->seed);
+    if(on_tick) on_tick(ctx, out);
+    uint32_t next = 0;
+    for(uint32_t t=0; t<log->ticks; t++){
+        while(next<log->nev && log->ev[next].tick==t){ game_set_dir(out, log->ev[next].dx, log->ev[next].dy); next++; }
+        game_step(out);
+        if(out->ticks != t+1 || game_hash(out) != log->hash[t]){
+            if(bad_tick) *bad_tick = t+1;
+            return false;
+        }
+        if(on_tick) on_tick(ctx, out);
+    }
+    return true;
+}
+
+bool replay_run(const InputLog* log, Game* out, uint32_t* bad_tick){
+    return replay_run_each(log, out, bad_tick, NULL, NULL);
+}
@@ -0,0 +1,41 @@
+// replay.h — input logs for deterministic games. A log is the game seed, every
+// heading change with the tick it was made on, and the game_hash() after each tick.
+// Re-simulating the log at full speed must reproduce every hash; the first tick
+// that does not points straight at the divergence.
+#ifndef PACMAN_REPLAY_H
+#define PACMAN_REPLAY_H
+
+#include "sim.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct { uint32_t tick; int8_t dx, dy; } InputEvent;   // applied before tick+1
+
+typedef struct {
+    uint64_t seed;
+    InputEvent* ev; uint32_t nev, cap_ev;
+    uint32_t* hash; uint32_t ticks, cap_hash;   // hash[i]: game_hash() after tick i+1
+} InputLog;
+
+// Recording wrappers: same as game_new/game_set_dir/game_step, plus the log
+// (log may be NULL to play without recording).
+void replay_begin(InputLog* log, Game* gm, uint64_t seed);
+void replay_set_dir(InputLog* log, Game* gm, int dx, int dy);
+int  replay_step(InputLog* log, Game* gm);
+void replay_free(InputLog* log);
+// Cut the log back to gm's tick after gm was restored to an earlier state (rewind,
+// save-state) and record gm's heading, so the log still replays to gm and onwards.
+void replay_rewind(InputLog* log, const Game* gm);
+
+// Little-endian file: "PMIL", version, seed, counts, varint-packed events, hashes.
+bool replay_save(const InputLog* log, const char* path);
+bool replay_load(InputLog* log, const char* path);
+
+// Re-simulate from the seed and events. Returns true if every hash matches;
+// otherwise *bad_tick is the first tick whose state differs. *out is the final state.
+bool replay_run(const InputLog* log, Game* out, uint32_t* bad_tick);
+// The same, calling on_tick(ctx, out) on the new game and after every tick.
+bool replay_run_each(const InputLog* log, Game* out, uint32_t* bad_tick,
+                     void (*on_tick)(void* ctx, const Game* gm), void* ctx);
+
+#endif
@@ -0,0 +1,431 @@
+// sim.c — Pac-Man rules as a pure, fixed-tick step function (no SDL, no wall clock).
+
+#include "sim.h"
+#include "nav.h"
+#include "graph.h"
+#include "trace.h"
+#include "telemetry.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ===== Level map =====
+const char* LEVEL0[MAP_H] = {
+    "############################",
+    "#............##............#",
+    "#.####.#####.##.#####.####.#",
+    "#o####.#####.##.#####.####o#",
+    "#.####.#####.##.#####.####.#",
+    "#..........................#",
+    "#.####.##.########.##.####.#",
+    "#.####.##.########.##.####.#",
+    "#......##....##....##......#",
+    "######.##### ## #####.######",
+    "     #.##### ## #####.#     ",
+    "     #.##          ##.#     ",
+    "     #.## ###HH### ##.#     ",
+    "######.## #      # ##.######",
+    "      .   #  GG  #   .      ",
+    "######.## #      # ##.######",
+    "     #.## ######## ##.#     ",
+    "     #.##          ##.#     ",
+    "     #.## ######## ##.#     ",
+    "######.## ######## ##.######",
+    "#............##............#",
+    "#.####.#####.##.#####.####.#",
+    "#o..##................##..o#",
+    "###.##.##.########.##.##.###",
+    "#......##....##....##......#",
+    "#.##########.##.##########.#",
+    "#..........................#",
+    "############################",
+    "############################",
+    "############################",
+    "############################"
+};
+
+// ===== Helpers =====
+void reset_board(Game* gm){
+    memset(&gm->bits, 0, sizeof gm->bits);
+    const Level* lv = gm->level;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        char c = gm->board[y][x] = lv->layout[y][x];
+        uint32_t bit = 1u<<x;
+        if(c=='#') gm->bits.wall[y] |= bit;
+        else if(c=='H') gm->bits.gate[y] |= bit;
+        else if(c=='.') gm->bits.pellet[y] |= bit;
+        else if(c=='o') gm->bits.power[y] |= bit;
+    }
+    gm->nav = lv->nav ? lv->nav : nav_for_layout(lv->layout);
+    gm->graph = lv->graph ? lv->graph : graph_for_layout(lv->layout, true);
+}
+
+static void wrap(Entity* e){ if(e->x<0) e->x=MAP_W-1; else if(e->x>=MAP_W) e->x=0; }
+
+bool passable_for_ghost(const Game* gm,int x,int y){ if(!in_bounds(x,y)) return true; return !bit_at(gm->bits.wall,x,y); }
+bool passable_for_pac(const Game* gm,int x,int y){ if(!in_bounds(x,y)) return true; return !((gm->bits.wall[y]|gm->bits.gate[y])>>x & 1u); }
+
+int board_path_dir(const Game* gm, Point src, Point dst, bool ghost){
+    TRACE_COUNT(TC_BFS, 1);
+    uint32_t open[MAP_H];
+    for(int y=0;y<MAP_H;y++) open[y] = ~(gm->bits.wall[y] | (ghost? 0 : gm->bits.gate[y])) & ROW_MASK;
+    if(!in_bounds(src.x,src.y) || !in_bounds(dst.x,dst.y) || !bit_at(open,dst.x,dst.y)) return -1;
+    if(src.x==dst.x && src.y==dst.y) return -1;
+    int nx[4], ny[4];
+    for(int d=0;d<4;d++){
+        nx[d]=src.x+NAV_DIRS[d][0]; ny[d]=src.y+NAV_DIRS[d][1];
+        if(nx[d]<0) nx[d]=MAP_W-1; else if(nx[d]>=MAP_W) nx[d]=0;   // tunnel wrap
+        if(!in_bounds(nx[d],ny[d]) || !bit_at(open,nx[d],ny[d])) ny[d]=-1;
+    }
+    uint32_t seen[MAP_H]={0}, front[MAP_H]={0}, next[MAP_H];
+    seen[dst.y]=front[dst.y]=1u<<dst.x;
+    int lo=dst.y, hi=dst.y;                   // rows the frontier can occupy
+    for(;;){
+        for(int d=0;d<4;d++) if(ny[d]>=0 && bit_at(front,nx[d],ny[d])) return d;
+        if(lo>0) lo--;
+        if(hi<MAP_H-1) hi++;
+        uint32_t any=0;
+        for(int y=lo;y<=hi;y++){
+            uint32_t f=front[y];
+            uint32_t n = f<<1 | f>>1 | (f>>(MAP_W-1) & 1u) | (f&1u)<<(MAP_W-1);
+            if(y>0) n |= front[y-1];
+            if(y<MAP_H-1) n |= front[y+1];
+            next[y] = n & open[y] & ~seen[y];
+            any |= next[y];
+        }
+        if(!any) return -1;
+        for(int y=lo;y<=hi;y++){ front[y]=next[y]; seen[y]|=next[y]; }
+    }
+}
+
+Point next_step_bfs(const Game* gm, Point src, Point dst, bool (*passable)(const Game*,int,int)){
+    static int qx[MAP_W*MAP_H], qy[MAP_W*MAP_H];
+    static short px[MAP_W][MAP_H], py[MAP_W][MAP_H];
+    static unsigned char vis[MAP_W][MAP_H];
+    TRACE_COUNT(TC_BFS, 1);
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){ vis[x][y]=0; px[x][y]=-1; py[x][y]=-1; }
+    int head=0, tail=0;
+    qx[tail]=src.x; qy[tail]=src.y; tail++; vis[src.x][src.y]=1;
+    const int dirs[4][2]={{1,0},{-1,0},{0,1},{0,-1}};
+    while(head<tail){
+        int x=qx[head], y=qy[head]; head++;
+        if(x==dst.x && y==dst.y) break;
+        for(int i=0;i<4;i++){
+            int nx=x+dirs[i][0], ny=y+dirs[i][1];
+            if(!in_bounds(nx,ny) && !(nx<0||nx>=MAP_W)) continue;
+            if(nx<0||nx>=MAP_W){
+                int wx=(nx<0)?MAP_W-1:0;
+                if(!passable(gm,wx,ny) || vis[wx][ny]) continue;
+                vis[wx][ny]=1; px[wx][ny]=x; py[wx][ny]=y; qx[tail]=wx; qy[tail]=ny; tail++;
+            }else{
+                if(!passable(gm,nx,ny) || vis[nx][ny]) continue;
+                vis[nx][ny]=1; px[nx][ny]=x; py[nx][ny]=y; qx[tail]=nx; qy[tail]=ny; tail++;
+            }
+        }
+    }
+    int tx=dst.x, ty=dst.y;
+    if(tx<0||tx>=MAP_W||ty<0||ty>=MAP_H) return src;
+    if(!vis[tx][ty]) return src;
+    while(!(px[tx][ty]==src.x && py[tx][ty]==src.y)){ int ntx=px[tx][ty], nty=py[tx][ty]; if(ntx==-1) break; tx=ntx; ty=nty; }
+    Point step={tx,ty}; return step;
+}
+
+// Deterministic steering toward a target with tie-break U,L,D,R and anti-reverse
+void choose_dir_toward(const Game* gm, Entity* e, Point tgt, bool (*pass)(const Game*,int,int)) {
+    const int DIRS[4][2] = { {0,-1}, {-1,0}, {0,1}, {1,0} }; // U, L, D, R
+    int revx = -e->dx, revy = -e->dy;
+
+    int viable = 0;
+    for (int i = 0; i < 4; i++) {
+        int ndx = DIRS[i][0], ndy = DIRS[i][1];
+        if (ndx == revx && ndy == revy) continue;
+        int nx = e->x + ndx, ny = e->y + ndy;
+        if (pass(gm, nx, ny)) viable++;
+    }
+    if (viable == 0) {
+        int nx = e->x + revx, ny = e->y + revy;
+        if (pass(gm, nx, ny)) { e->dx = revx; e->dy = revy; }
+        return;
+    }
+    int best_i = -1, best_d = 1<<30;
+    for (int i = 0; i < 4; i++) {
+        int ndx = DIRS[i][0], ndy = DIRS[i][1];
+        if (ndx == revx && ndy == revy) continue;
+        int nx = e->x + ndx, ny = e->y + ndy;
+        if (!pass(gm, nx, ny)) continue;
+        int d = abs(nx - tgt.x) + abs(ny - tgt.y);
+        if (d < best_d) { best_d = d; best_i = i; }
+    }
+    if (best_i >= 0) { e->dx = DIRS[best_i][0]; e->dy = DIRS[best_i][1]; }
+}
+
+static Point pac_ahead(Entity pac, int tiles){
+    Point p={pac.x+pac.dx*tiles, pac.y+pac.dy*tiles};
+    if(p.x<0)p.x=MAP_W-1;
+    if(p.x>=MAP_W)p.x=0;
+    return p;
+}
+
+// Classic targets: all ghosts scatter/chase per schedule; frightened ignores target.
+Point ghost_target(GhostId id, Entity pac, const Ghost ghosts[4]){
+    const Ghost* g = &ghosts[id];
+    if (g->mode == MODE_FRIGHT) return (Point){ g->e.x, g->e.y };
+    Point corners[4]={{MAP_W-2,0},{1,0},{MAP_W-2,MAP_H-2},{1,MAP_H-2}};
+    if (g->mode == MODE_SCATTER) return corners[id];
+
+    // MODE_CHASE
+    if (id == RED) { // Blinky
+        return (Point){ pac.x, pac.y };
+    } else if (id == PINK) { // Pinky
+        Point a = pac_ahead(pac, 4); return a;
+    } else if (id == BLUE) { // Inky
+        Point p2 = pac_ahead(pac, 2);
+        int vx = p2.x - ghosts[RED].e.x, vy = p2.y - ghosts[RED].e.y;
+        return (Point){ p2.x + vx, p2.y + vy };
+    } else { // ORANGE (Clyde)
+        int dx = pac.x - g->e.x, dy = pac.y - g->e.y;
+        int dist2 = dx*dx + dy*dy;
+        if (dist2 >= 64) return (Point){ pac.x, pac.y };
+        return corners[ORANGE];
+    }
+}
+
+/* Classic global phase schedule (level 1 timing approximation):
+   S7, C20, S7, C20, S5, C20, S5, C∞
+   0 duration means "infinite" (stay in that mode). */
+const Phase PHASES[] = {
+    {MODE_SCATTER, MS_TO_TICKS(7000)}, {MODE_CHASE, MS_TO_TICKS(20000)},
+    {MODE_SCATTER, MS_TO_TICKS(7000)}, {MODE_CHASE, MS_TO_TICKS(20000)},
+    {MODE_SCATTER, MS_TO_TICKS(5000)}, {MODE_CHASE, MS_TO_TICKS(20000)},
+    {MODE_SCATTER, MS_TO_TICKS(5000)}, {MODE_CHASE, 0}
+};
+
+const int PHASE_COUNT = (int)(sizeof(PHASES)/sizeof(PHASES[0]));
+
+// Pac-Man starts at 13,20 and moves left on the first tick. Ghosts start on the 'G'
+// tiles in reading order; LEVEL0 has two, so the other two share the first.
+const Level LEVEL_CLASSIC = {
+    LEVEL0, {13,20}, {{13,14},{14,14},{13,14},{13,14}},
+    PHASES, (int)(sizeof(PHASES)/sizeof(PHASES[0])), NULL, NULL, 0
+};
+
+GhostMode current_phase_mode(const Game* gm){ return gm->level->phases[gm->phase_idx].mode; }
+
+// Pause/resume the schedule while any ghost is frightened
+static void maybe_switch_modes(Game* gm){
+    Ghost* ghosts = gm->ghosts;
+    bool any_fright=false;
+    for(int i=0;i<4;i++) if(ghosts[i].mode==MODE_FRIGHT) { any_fright=true; break; }
+    if(any_fright) { return; }
+
+    const Level* lv = gm->level;
+    uint32_t dur = lv->phases[gm->phase_idx].dur_ticks;
+    if(dur==0) return;
+
+    if(gm->ticks - gm->phase_start >= dur){
+        if(gm->phase_idx < lv->phase_count - 1){
+            TELEM(gm, TE_PHASE, gm->phase_idx, 0, lv->phases[gm->phase_idx].mode, gm->ticks - gm->phase_start, dur);
+            gm->phase_idx++;
+            gm->phase_start = gm->ticks;
+            GhostMode nm = lv->phases[gm->phase_idx].mode;
+            for(int i=0;i<4;i++){
+                if(ghosts[i].mode != MODE_FRIGHT) ghosts[i].mode = nm;
+            }
+        }
+    }
+}
+
+static void set_frightened(Game* gm){
+    for(int i=0;i<4;i++){
+        gm->ghosts[i].mode = MODE_FRIGHT;
+        gm->ghosts[i].fright_timer = gm->ticks + FRIGHT_TICKS;
+    }
+}
+
+void place_starts(Game* gm){
+    Entity* pac = &gm->pac; Ghost* g = gm->ghosts; const Level* lv = gm->level;
+    pac->x=lv->pac_spawn.x; pac->y=lv->pac_spawn.y; pac->dx=-1; pac->dy=0; pac->startx=pac->x; pac->starty=pac->y;
+    for(int i=0;i<4;i++){
+        Point p = lv->ghost_spawn[i];
+        g[i].e.x=p.x; g[i].e.y=p.y; g[i].e.startx=p.x; g[i].e.starty=p.y;
+        g[i].e.dx=1; g[i].e.dy=0; g[i].mode=lv->phases[0].mode; g[i].fright_timer=0;
+    }
+    // Reset schedule to start at the first phase
+    gm->phase_idx=0; gm->phase_start=gm->ticks;
+}
+
+void reset_positions(Game* gm){
+    Entity* pac = &gm->pac; Ghost* g = gm->ghosts;
+    pac->x=pac->startx; pac->y=pac->starty; pac->dx=-1; pac->dy=0;
+    for(int i=0;i<4;i++){
+        g[i].e.x=g[i].e.startx; g[i].e.y=g[i].e.starty; g[i].e.dx=1; g[i].e.dy=0;
+    }
+}
+
+int count_pellets(const Game* gm){
+    int c=0; for(int y=0;y<MAP_H;y++) c += popcount32(gm->bits.pellet[y] | gm->bits.power[y]); return c;
+}
+
+void game_new(Game* gm, uint64_t seed){ game_new_level(gm, &LEVEL_CLASSIC, seed); }
+
+void game_new_level(Game* gm, const Level* level, uint64_t seed){
+    memset(gm, 0, sizeof *gm);
+    gm->level = level;
+    gm->rng = seed ? seed : SIM_DEFAULT_SEED;
+    reset_board(gm);
+    place_starts(gm);
+    gm->lives=3; gm->score=0; gm->pellets=count_pellets(gm);
+    TELEM(gm, TE_START, 0, 0, level->phase_count, gm->rng, telem_layout_hash(level));
+}
+
+void game_set_dir(Game* gm, int dx, int dy){ gm->pac.dx=dx; gm->pac.dy=dy; }
+
+// First step from src toward tgt as a unit direction; false when there is none
+// (tgt is a wall, unreachable or src itself). Uses the shared next-hop table and
+// only falls back to a live (bit-parallel) BFS if the table could not be built.
+static bool ghost_path_dir(const Game* gm, Point src, Point tgt, int* dx, int* dy){
+    TRACE_COUNT(TC_PATH, 1);
+    if(gm->nav){
+        int dir = nav_next_dir(gm->nav, src, tgt);
+        if(dir<0) return false;
+        *dx = NAV_DIRS[dir][0]; *dy = NAV_DIRS[dir][1];
+        return true;
+    }
+    int dir = board_path_dir(gm, src, tgt, true);
+    if(dir<0) return false;
+    *dx = NAV_DIRS[dir][0]; *dy = NAV_DIRS[dir][1];
+    return true;
+}
+
+static void step_ghosts(Game* gm){
+    Ghost* ghosts = gm->ghosts;
+    for(int i=0;i<4;i++){
+        // frightened expiry: return to current schedule phase
+        if(ghosts[i].mode==MODE_FRIGHT && gm->ticks>=ghosts[i].fright_timer){
+            ghosts[i].mode = current_phase_mode(gm);
+        }
+
+        // Between junctions there is nothing to decide: follow the corridor.
+        int glide = gm->graph? graph_glide_dir(gm->graph, ghosts[i].e.x, ghosts[i].e.y, graph_dir_index(ghosts[i].e.dx, ghosts[i].e.dy)) : -1;
+        if(glide>=0){
+            ghosts[i].e.dx = NAV_DIRS[glide][0]; ghosts[i].e.dy = NAV_DIRS[glide][1];
+        }else if(ghosts[i].mode==MODE_FRIGHT){
+            // random only in frightened
+            static const int dirs[4][2]={{1,0},{-1,0},{0,1},{0,-1}};
+            int idx = (int)(sim_rand(&gm->rng)%4);
+            ghosts[i].e.dx = dirs[idx][0]; ghosts[i].e.dy = dirs[idx][1];
+        }else{
+            Point src={ghosts[i].e.x,ghosts[i].e.y};
+            Point tgt=ghost_target((GhostId)i, gm->pac, ghosts);
+            if(tgt.x<0)tgt.x=0;
+            if(tgt.x>=MAP_W)tgt.x=MAP_W-1;
+            if(tgt.y<0)tgt.y=0;
+            if(tgt.y>=MAP_H)tgt.y=MAP_H-1;
+
+            if(!ghost_path_dir(gm, src, tgt, &ghosts[i].e.dx, &ghosts[i].e.dy)){
+                choose_dir_toward(gm, &ghosts[i].e, tgt, passable_for_ghost);
+            }
+        }
+
+        ghosts[i].e.x += ghosts[i].e.dx;
+        ghosts[i].e.y += ghosts[i].e.dy;
+        if(ghosts[i].e.x<0) ghosts[i].e.x=MAP_W-1;
+        if(ghosts[i].e.x>=MAP_W) ghosts[i].e.x=0;
+        if(!passable_for_ghost(gm,ghosts[i].e.x,ghosts[i].e.y)){
+            ghosts[i].e.x -= ghosts[i].e.dx;
+            ghosts[i].e.y -= ghosts[i].e.dy;
+            ghosts[i].e.dx = -ghosts[i].e.dx;
+            ghosts[i].e.dy = -ghosts[i].e.dy;
+        }
+    }
+}
+
+static int resolve_collisions(Game* gm){
+    Ghost* ghosts = gm->ghosts;
+    int ev = 0;
+    for(int i=0;i<4;i++){
+        if(gm->pac.x==ghosts[i].e.x && gm->pac.y==ghosts[i].e.y){
+            if(ghosts[i].mode==MODE_FRIGHT){
+                int pts = 200 << (gm->eat_streak>3?3:gm->eat_streak);
+                gm->score += pts; gm->eat_streak++;
+                ghosts[i].e.x=ghosts[i].e.startx; ghosts[i].e.y=ghosts[i].e.starty;
+                ghosts[i].mode = current_phase_mode(gm);
+                ghosts[i].fright_timer=0;
+                ev |= EV_GHOST_EATEN;
+                TELEM(gm, TE_GHOST_EATEN, gm->pac.x, gm->pac.y, i, gm->eat_streak, pts);
+            }else{
+                gm->lives--;
+                ev |= EV_DEATH;
+                TELEM(gm, TE_DEATH, gm->pac.x, gm->pac.y, i, gm->lives, ghosts[i].mode);
+                if(gm->lives<=0){ gm->over=true; ev |= EV_OVER; TELEM(gm, TE_OVER, gm->pac.x, gm->pac.y, 0, gm->score, 0); }
+                reset_positions(gm);
+                break;
+            }
+        }
+    }
+    return ev;
+}
+
+int game_step(Game* gm){
+    if(gm->won || gm->over) return 0;
+    gm->ticks++;
+    TRACE_COUNT(TC_TICKS, 1);
+    TRACE_BEGIN(t_modes);
+    maybe_switch_modes(gm);
+    TRACE_END(t_modes, "maybe_switch_modes");
+
+    // Pac-Man step
+    TRACE_BEGIN(t_pac);
+    int ev = 0;
+    Entity* pac = &gm->pac;
+    int nx=pac->x+pac->dx, ny=pac->y+pac->dy;
+    if(passable_for_pac(gm,nx,ny)){
+        pac->x=nx; pac->y=ny; wrap(pac);
+        TELEM(gm, TE_MOVE, pac->x, pac->y, 0, 0, 0);
+        if(is_food_at(gm,pac->x,pac->y)){
+            uint32_t bit = 1u<<pac->x;
+            bool power = gm->bits.power[pac->y] & bit;
+            gm->bits.pellet[pac->y] &= ~bit; gm->bits.power[pac->y] &= ~bit;
+            gm->board[pac->y][pac->x]=' '; gm->pellets--; gm->eat_streak=0;
+            if(power){ gm->score+=50; set_frightened(gm); ev|=EV_POWER; }
+            else { gm->score+=10; ev|=EV_PELLET; }
+            TELEM(gm, power? TE_POWER : TE_PELLET, pac->x, pac->y, 0, gm->pellets, 0);
+        }
+        if(gm->pellets<=0){ gm->won=true; TELEM(gm, TE_WON, pac->x, pac->y, 0, gm->score, gm->lives); TRACE_END(t_pac, "pac_step"); return ev|EV_WON; }
+    }
+    TRACE_END(t_pac, "pac_step");
+
+    // Ghost step
+    TRACE_BEGIN(t_ghosts);
+    step_ghosts(gm);
+    TRACE_END(t_ghosts, "ghost_step");
+    TRACE_BEGIN(t_coll);
+    ev |= resolve_collisions(gm);
+    TRACE_END(t_coll, "collisions");
+    return ev;
+}
+
+static uint32_t fnv(uint32_t h, const void* p, size_t n){
+    const unsigned char* b = p;
+    for(size_t i=0;i<n;i++){ h ^= b[i]; h *= 16777619u; }
+    return h;
+}
+static uint32_t fnv_int(uint32_t h, int64_t v){ return fnv(h, &v, sizeof v); }
+
+static uint32_t hash_entity(uint32_t h, const Entity* e){
+    h = fnv_int(h, e->x); h = fnv_int(h, e->y);
+    return fnv_int(fnv_int(h, e->dx), e->dy);
+}
+
+uint32_t game_hash(const Game* gm){
+    // Field by field rather than the raw struct: no padding bytes, no pointers.
+    uint32_t h = fnv(2166136261u, &gm->bits, sizeof gm->bits);
+    h = hash_entity(h, &gm->pac);
+    for(int i=0;i<4;i++){
+        h = hash_entity(h, &gm->ghosts[i].e);
+        h = fnv_int(fnv_int(h, gm->ghosts[i].mode), gm->ghosts[i].fright_timer);
+    }
+    int64_t v[] = { gm->score, gm->lives, gm->pellets, gm->eat_streak, gm->won, gm->over,
+                    gm->ticks, (int64_t)gm->rng, gm->phase_idx, gm->phase_start };
+    for(size_t i=0;i<sizeof v/sizeof v[0];i++) h = fnv_int(h, v[i]);
+    return h;
+}
@@ -0,0 +1,149 @@
+// sim.h — Pac-Man game rules with no SDL dependency: board, entities, ghost AI,
+// scatter/chase schedule and a fixed-tick step function. Used by the SDL game
+// (pacman2.c) and by the headless runner (headless.c).
+#ifndef PACMAN_SIM_H
+#define PACMAN_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAP_W 28
+#define MAP_H 31
+
+#define STEP_MS 110          // Pac-Man step timing
+#define GHOST_MS 110         // Ghost step timing
+#define FRIGHT_MS 6000       // frightened mode duration
+
+// One simulation tick is one Pac-Man step; ghosts move on the same tick.
+// Game time is counted in ticks only; millisecond figures are converted once here.
+#define TICK_MS STEP_MS
+#define MS_TO_TICKS(ms) (((ms) + TICK_MS/2) / TICK_MS)
+#define FRIGHT_TICKS MS_TO_TICKS(FRIGHT_MS)
+
+typedef enum { MODE_SCATTER, MODE_CHASE, MODE_FRIGHT } GhostMode;
+typedef enum { RED=0, PINK=1, BLUE=2, ORANGE=3 } GhostId;
+
+typedef struct { int x,y; int dx,dy; int startx,starty; } Entity;
+typedef struct { Entity e; GhostMode mode; uint32_t fright_timer; } Ghost;   // fright_timer: tick it ends
+typedef struct { int x,y; } Point;
+
+// Bit planes over the board: bit x of row y, one 32-bit mask per row. Passability
+// and pellet tests are mask tests; the char board is kept in step for rendering.
+#define ROW_MASK ((uint32_t)((1ull<<MAP_W)-1))
+typedef struct {
+    uint32_t wall[MAP_H], gate[MAP_H], pellet[MAP_H], power[MAP_H];
+} BoardBits;
+
+struct NavTable;
+struct MazeGraph;
+
+// Scatter/chase schedule entry; dur_ticks 0 means the phase lasts forever.
+typedef struct { GhostMode mode; uint32_t dur_ticks; } Phase;
+
+// A playable maze: tiles, spawn points, scatter/chase schedule and, optionally, its
+// navigation tables already built. LEVEL_CLASSIC is LEVEL0 with PHASES; other levels
+// come from a memory-mapped level pack (levelpack.h) and carry their tables.
+#define LEVEL_MAX_PHASES 8
+typedef struct Level {
+    const char* const* layout;     // MAP_H rows of MAP_W tiles: '#', 'H', '.', 'o', ' ', 'G'
+    Point pac_spawn, ghost_spawn[4];
+    const Phase* phases; int phase_count;
+    const struct NavTable* nav;    // NULL: nav_for_layout() builds and caches one
+    const struct MazeGraph* graph; // ghost-passability graph; NULL: graph_for_layout()
+    uint32_t gen;                  // 0 for fixed levels; levelwatch.h numbers each generation
+} Level;
+
+// Everything a running game needs; no hidden globals, so several can coexist.
+typedef struct {
+    char board[MAP_H][MAP_W];     // char view of bits: '#', 'H', '.', 'o', ' '
+    BoardBits bits;
+    const Level* level;
+    const struct NavTable* nav;   // shared next-hop table for the layout (nav.h)
+    const struct MazeGraph* graph;// shared junction graph, ghost passability (graph.h)
+    Entity pac;
+    Ghost ghosts[4];
+    int score, lives, pellets, eat_streak;
+    bool won, over;
+    uint32_t ticks;        // simulated ticks since game_new()
+    uint64_t rng;          // per-game PRNG state (frightened ghosts), see sim_rand()
+    int phase_idx;
+    uint32_t phase_start;  // tick the current scatter/chase phase began
+} Game;
+
+// Events reported by game_step() so the front end can play sounds / music.
+enum {
+    EV_PELLET      = 1<<0,
+    EV_POWER       = 1<<1,
+    EV_GHOST_EATEN = 1<<2,
+    EV_DEATH       = 1<<3,
+    EV_WON         = 1<<4,
+    EV_OVER        = 1<<5
+};
+
+extern const char* LEVEL0[MAP_H];
+
+// Classic scatter/chase schedule (LEVEL_CLASSIC's, and the batch simulator's).
+extern const Phase PHASES[];
+extern const int PHASE_COUNT;
+extern const Level LEVEL_CLASSIC;
+
+// xorshift64*: same seed, same game. Never returns to a zero state, so a zero
+// seed is replaced by SIM_DEFAULT_SEED.
+#define SIM_DEFAULT_SEED 0x9E3779B97F4A7C15ULL
+static inline uint32_t sim_rand(uint64_t* state){
+    uint64_t x = *state;
+    x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+    *state = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static inline int popcount32(uint32_t v){
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(v);
+#else
+    v = v - ((v >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+    return (int)((((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#endif
+}
+
+static inline bool in_bounds(int x,int y){ return x>=0 && x<MAP_W && y>=0 && y<MAP_H; }
+static inline bool bit_at(const uint32_t* plane,int x,int y){ return (plane[y]>>x) & 1u; }
+static inline bool is_wall_at(const Game* gm,int x,int y){ if(!in_bounds(x,y)) return true; return bit_at(gm->bits.wall,x,y); }
+static inline bool is_gate_at(const Game* gm,int x,int y){ return in_bounds(x,y) && bit_at(gm->bits.gate,x,y); }
+static inline bool is_food_at(const Game* gm,int x,int y){ return in_bounds(x,y) && ((gm->bits.pellet[y]|gm->bits.power[y])>>x & 1u); }
+
+bool passable_for_ghost(const Game* gm,int x,int y);
+bool passable_for_pac(const Game* gm,int x,int y);
+
+void reset_board(Game* gm);
+void place_starts(Game* gm);
+void reset_positions(Game* gm);
+int count_pellets(const Game* gm);   // popcount of the pellet and power planes
+
+// Fresh game: board, spawn points, 3 lives, score 0, tick 0. The whole game is a
+// function of the level, the seed and the game_set_dir() calls made between ticks.
+void game_new(Game* gm, uint64_t seed);                         // LEVEL_CLASSIC
+void game_new_level(Game* gm, const Level* level, uint64_t seed);
+// Request a new Pac-Man heading (applied on the next tick if passable).
+void game_set_dir(Game* gm, int dx, int dy);
+// Advance one tick: Pac-Man step, ghost step, collisions. Returns EV_* flags.
+// No-op once the game is won or over.
+int game_step(Game* gm);
+// FNV-1a over every field that affects later ticks; equal hashes on the same tick
+// mean a replay is still in lockstep with the recording.
+uint32_t game_hash(const Game* gm);
+
+GhostMode current_phase_mode(const Game* gm);
+
+// Shortest-path first step from src toward dst as a NAV_DIRS index (nav.h), -1 if
+// none. Bit-parallel BFS: floods out from dst a whole row mask at a time with
+// shifts and ANDs, and picks the lowest-index neighbour of src that the flood
+// reaches first, which is the step next_step_bfs() and the nav table return.
+int board_path_dir(const Game* gm, Point src, Point dst, bool ghost);
+
+Point next_step_bfs(const Game* gm, Point src, Point dst, bool (*passable)(const Game*,int,int));
+void choose_dir_toward(const Game* gm, Entity* e, Point tgt, bool (*pass)(const Game*,int,int));
+Point ghost_target(GhostId id, Entity pac, const Ghost ghosts[4]);
+
+#endif
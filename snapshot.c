@@ -0,0 +1,290 @@
+// snapshot.c — save/restore, delta coding and the history ring (see snapshot.h).
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(Snapshot)==320, "Snapshot layout");
+
+// ===== Save / restore =====
+static SnapEntity pack_entity(const Entity* e){ return (SnapEntity){ (int8_t)e->x, (int8_t)e->y, (int8_t)e->dx, (int8_t)e->dy }; }
+static void unpack_entity(Entity* e, SnapEntity s){ e->x=s.x; e->y=s.y; e->dx=s.dx; e->dy=s.dy; }
+
+void snapshot_save(const Game* gm, Snapshot* s){
+    memcpy(s->pellet, gm->bits.pellet, sizeof s->pellet);
+    memcpy(s->power, gm->bits.power, sizeof s->power);
+    s->pac = pack_entity(&gm->pac);
+    for(int i=0;i<4;i++){
+        s->ghost[i] = pack_entity(&gm->ghosts[i].e);
+        s->ghost_mode[i] = (uint8_t)gm->ghosts[i].mode;
+        s->fright_timer[i] = gm->ghosts[i].fright_timer;
+    }
+    s->score = gm->score; s->pellets = gm->pellets;
+    s->ticks = gm->ticks; s->phase_start = gm->phase_start;
+    s->rng = gm->rng;
+    s->lives = (uint8_t)gm->lives; s->eat_streak = (uint8_t)gm->eat_streak;
+    s->phase_idx = (uint8_t)gm->phase_idx;
+    s->flags = (uint8_t)((gm->won ? SNAP_WON : 0) | (gm->over ? SNAP_OVER : 0));
+}
+
+void snapshot_load(Game* gm, const Snapshot* s){
+    // Only tiles whose food differs are rewritten in the char view.
+    for(int y=0;y<MAP_H;y++){
+        uint32_t diff = (gm->bits.pellet[y] ^ s->pellet[y]) | (gm->bits.power[y] ^ s->power[y]);
+        for(int x=0; diff; x++, diff>>=1)
+            if(diff & 1) gm->board[y][x] = (s->pellet[y]>>x & 1) ? '.' : (s->power[y]>>x & 1) ? 'o' : ' ';
+    }
+    memcpy(gm->bits.pellet, s->pellet, sizeof s->pellet);
+    memcpy(gm->bits.power, s->power, sizeof s->power);
+    unpack_entity(&gm->pac, s->pac);
+    for(int i=0;i<4;i++){
+        unpack_entity(&gm->ghosts[i].e, s->ghost[i]);
+        gm->ghosts[i].mode = (GhostMode)s->ghost_mode[i];
+        gm->ghosts[i].fright_timer = s->fright_timer[i];
+    }
+    gm->score = s->score; gm->pellets = s->pellets;
+    gm->ticks = s->ticks; gm->phase_start = s->phase_start;
+    gm->rng = s->rng;
+    gm->lives = s->lives; gm->eat_streak = s->eat_streak; gm->phase_idx = s->phase_idx;
+    gm->won = s->flags & SNAP_WON; gm->over = s->flags & SNAP_OVER;
+}
+
+// ===== Delta coding =====
+// varint tick delta, a section mask, then the sections in mask-bit order:
+//   D_PAC      entity step          D_GHOSTS  ghost mask byte, a step per set bit
+//   D_FOOD     varint n, n varint bit indices toggled (plane*TILES + y*MAP_W + x)
+//   D_SCORE    zigzag varint score and pellet-count deltas
+//   D_RNG      8 raw bytes          D_MODES   per ghost: mode byte, varint fright_timer
+//   D_MISC     lives, eat_streak, phase_idx, flags bytes, varint phase_start
+// An entity step is one byte, (ddx+1) | (ddy+1)<<2 | (dx+1)<<4 | (dy+1)<<6, when it
+// moved at most one tile; otherwise 0x03 (never a valid step) and x, y, dx, dy.
+enum { D_PAC=1, D_GHOSTS=2, D_FOOD=4, D_SCORE=8, D_RNG=16, D_MODES=32, D_MISC=64 };
+#define TILES (MAP_W*MAP_H)
+#define SNAP_FOOD_MAX 64          // toggled bits per delta; keeps every delta under SNAP_DELTA_MAX
+#define STEP_ESCAPE 0x03
+
+static uint8_t* put_varint(uint8_t* p, uint32_t v){
+    while(v >= 0x80){ *p++ = (uint8_t)(v | 0x80); v >>= 7; }
+    *p++ = (uint8_t)v;
+    return p;
+}
+static uint32_t zigzag(int32_t v){ return ((uint32_t)v << 1) ^ (uint32_t)-(int32_t)((uint32_t)v >> 31); }
+static int32_t unzigzag(uint32_t v){ return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+static bool same_entity(SnapEntity a, SnapEntity b){ return a.x==b.x && a.y==b.y && a.dx==b.dx && a.dy==b.dy; }
+
+static uint8_t* put_step(uint8_t* p, SnapEntity a, SnapEntity b){
+    int ddx = b.x-a.x, ddy = b.y-a.y;
+    if(ddx>=-1 && ddx<=1 && ddy>=-1 && ddy<=1 && b.dx>=-1 && b.dx<=1 && b.dy>=-1 && b.dy<=1){
+        *p++ = (uint8_t)((ddx+1) | (ddy+1)<<2 | (b.dx+1)<<4 | (b.dy+1)<<6);
+        return p;
+    }
+    *p++ = STEP_ESCAPE;
+    *p++ = (uint8_t)b.x; *p++ = (uint8_t)b.y; *p++ = (uint8_t)b.dx; *p++ = (uint8_t)b.dy;
+    return p;
+}
+
+size_t snapshot_delta(const Snapshot* a, const Snapshot* b, uint8_t* out){
+    if(b->ticks < a->ticks) return 0;
+    int food = 0;
+    for(int y=0;y<MAP_H;y++) food += popcount32(a->pellet[y]^b->pellet[y]) + popcount32(a->power[y]^b->power[y]);
+    if(food > SNAP_FOOD_MAX) return 0;
+
+    uint8_t* p = put_varint(out, b->ticks - a->ticks);
+    uint8_t* mask = p++;
+    *mask = 0;
+    if(!same_entity(a->pac, b->pac)){ *mask |= D_PAC; p = put_step(p, a->pac, b->pac); }
+    uint8_t gm = 0;
+    for(int i=0;i<4;i++) if(!same_entity(a->ghost[i], b->ghost[i])) gm |= (uint8_t)(1u<<i);
+    if(gm){
+        *mask |= D_GHOSTS; *p++ = gm;
+        for(int i=0;i<4;i++) if(gm>>i & 1) p = put_step(p, a->ghost[i], b->ghost[i]);
+    }
+    if(food){
+        *mask |= D_FOOD; p = put_varint(p, (uint32_t)food);
+        for(int plane=0;plane<2;plane++){
+            const uint32_t* pa = plane ? a->power : a->pellet; const uint32_t* pb = plane ? b->power : b->pellet;
+            for(int y=0;y<MAP_H;y++){
+                uint32_t diff = pa[y]^pb[y];
+                for(int x=0; diff; x++, diff>>=1) if(diff & 1) p = put_varint(p, (uint32_t)(plane*TILES + y*MAP_W + x));
+            }
+        }
+    }
+    if(a->score!=b->score || a->pellets!=b->pellets){
+        *mask |= D_SCORE;
+        p = put_varint(p, zigzag(b->score - a->score));
+        p = put_varint(p, zigzag(b->pellets - a->pellets));
+    }
+    if(a->rng!=b->rng){
+        *mask |= D_RNG;
+        for(int i=0;i<8;i++) *p++ = (uint8_t)(b->rng >> (8*i));
+    }
+    if(memcmp(a->ghost_mode, b->ghost_mode, 4)!=0 || memcmp(a->fright_timer, b->fright_timer, sizeof a->fright_timer)!=0){
+        *mask |= D_MODES;
+        for(int i=0;i<4;i++){ *p++ = b->ghost_mode[i]; p = put_varint(p, b->fright_timer[i]); }
+    }
+    if(a->lives!=b->lives || a->eat_streak!=b->eat_streak || a->phase_idx!=b->phase_idx || a->flags!=b->flags || a->phase_start!=b->phase_start){
+        *mask |= D_MISC;
+        *p++ = b->lives; *p++ = b->eat_streak; *p++ = b->phase_idx; *p++ = b->flags;
+        p = put_varint(p, b->phase_start);
+    }
+    return (size_t)(p - out);
+}
+
+typedef struct { const uint8_t* p; const uint8_t* end; bool ok; } Reader;
+
+static uint8_t get_u8(Reader* r){
+    if(r->p >= r->end){ r->ok = false; return 0; }
+    return *r->p++;
+}
+static uint32_t get_varint(Reader* r){
+    uint32_t v = 0;
+    for(int shift=0; shift<35; shift+=7){
+        uint8_t c = get_u8(r);
+        v |= (uint32_t)(c & 0x7F) << shift;
+        if(!(c & 0x80)) return v;
+    }
+    r->ok = false;
+    return 0;
+}
+static void get_step(Reader* r, SnapEntity* e){
+    uint8_t c = get_u8(r);
+    if((c & 3)==STEP_ESCAPE){
+        e->x = (int8_t)get_u8(r); e->y = (int8_t)get_u8(r); e->dx = (int8_t)get_u8(r); e->dy = (int8_t)get_u8(r);
+        return;
+    }
+    e->x = (int8_t)(e->x + (c & 3) - 1); e->y = (int8_t)(e->y + (c>>2 & 3) - 1);
+    e->dx = (int8_t)((c>>4 & 3) - 1); e->dy = (int8_t)((c>>6 & 3) - 1);
+}
+
+bool snapshot_apply(Snapshot* s, const uint8_t* in, size_t len){
+    Reader r = { in, in + len, true };
+    s->ticks += get_varint(&r);
+    uint8_t mask = get_u8(&r);
+    if(mask & D_PAC) get_step(&r, &s->pac);
+    if(mask & D_GHOSTS){
+        uint8_t gm = get_u8(&r);
+        for(int i=0;i<4;i++) if(gm>>i & 1) get_step(&r, &s->ghost[i]);
+    }
+    if(mask & D_FOOD){
+        uint32_t n = get_varint(&r);
+        for(uint32_t i=0; i<n && r.ok; i++){
+            uint32_t b = get_varint(&r);
+            if(b >= 2*TILES){ r.ok = false; break; }
+            uint32_t* plane = b >= TILES ? s->power : s->pellet;
+            b %= TILES;
+            plane[b / MAP_W] ^= 1u << (b % MAP_W);
+        }
+    }
+    if(mask & D_SCORE){
+        s->score += unzigzag(get_varint(&r));
+        s->pellets += unzigzag(get_varint(&r));
+    }
+    if(mask & D_RNG){
+        uint64_t v = 0;
+        for(int i=0;i<8;i++) v |= (uint64_t)get_u8(&r) << (8*i);
+        s->rng = v;
+    }
+    if(mask & D_MODES)
+        for(int i=0;i<4;i++){ s->ghost_mode[i] = get_u8(&r); s->fright_timer[i] = get_varint(&r); }
+    if(mask & D_MISC){
+        s->lives = get_u8(&r); s->eat_streak = get_u8(&r); s->phase_idx = get_u8(&r); s->flags = get_u8(&r);
+        s->phase_start = get_varint(&r);
+    }
+    return r.ok && r.p == r.end;
+}
+
+// ===== History ring =====
+#define SNAP_BYTES_PER_FRAME 32   // delta budget per frame; typical ticks need half that
+
+static int key_count(const SnapRing* r){ return r->frames / SNAP_KEY_EVERY; }
+static Snapshot* key_for(const SnapRing* r, uint32_t f){ return &r->keys[(f / SNAP_KEY_EVERY) % (uint32_t)key_count(r)]; }
+static size_t slot(const SnapRing* r, uint32_t f){ return f % (uint32_t)r->frames; }
+static size_t tail(const SnapRing* r){ return r->first < r->next ? r->start[slot(r, r->first)] : r->head; }
+
+bool snapring_init(SnapRing* r, int frames){
+    memset(r, 0, sizeof *r);
+    if(frames < SNAP_KEY_EVERY) frames = SNAP_KEY_EVERY;
+    r->frames = (frames + SNAP_KEY_EVERY-1) / SNAP_KEY_EVERY * SNAP_KEY_EVERY;
+    r->cap = (size_t)r->frames * SNAP_BYTES_PER_FRAME;
+    if(r->cap < (size_t)SNAP_KEY_EVERY * SNAP_DELTA_MAX) r->cap = (size_t)SNAP_KEY_EVERY * SNAP_DELTA_MAX;
+    r->keys = malloc((size_t)key_count(r) * sizeof *r->keys);
+    r->bytes = malloc(r->cap);
+    r->start = malloc((size_t)r->frames * sizeof *r->start);
+    r->len = malloc((size_t)r->frames * sizeof *r->len);
+    if(!r->keys || !r->bytes || !r->start || !r->len){ snapring_free(r); return false; }
+    return true;
+}
+
+void snapring_free(SnapRing* r){
+    free(r->keys); free(r->bytes); free(r->start); free(r->len);
+    memset(r, 0, sizeof *r);
+}
+
+static void restart(SnapRing* r, const Snapshot* s){
+    r->first = 0; r->next = 1;
+    *key_for(r, 0) = *s;
+    r->start[0] = r->head; r->len[0] = 0;
+    r->last = *s;
+}
+
+void snapring_reset(SnapRing* r, const Game* gm){
+    if(!r->frames) return;
+    Snapshot s; snapshot_save(gm, &s);
+    restart(r, &s);
+}
+
+void snapring_push(SnapRing* r, const Game* gm){
+    if(!r->frames) return;
+    Snapshot cur; snapshot_save(gm, &cur);
+    if(r->next==0){ restart(r, &cur); return; }
+    uint8_t tmp[SNAP_DELTA_MAX];
+    uint32_t f = r->next;
+    size_t n = 0;
+    if(f % SNAP_KEY_EVERY){
+        n = snapshot_delta(&r->last, &cur, tmp);
+        if(!n){ restart(r, &cur); return; }
+    }
+    // Evict whole groups so the oldest kept frame is always a keyframe. The current
+    // group always fits: cap holds SNAP_KEY_EVERY maximal deltas.
+    while(f+1 - r->first > (uint32_t)r->frames || r->head + n - tail(r) > r->cap) r->first += SNAP_KEY_EVERY;
+    size_t i = slot(r, f);
+    r->start[i] = r->head; r->len[i] = (uint16_t)n;
+    if(n) for(size_t k=0;k<n;k++) r->bytes[(r->head + k) % r->cap] = tmp[k];
+    else *key_for(r, f) = cur;
+    r->head += n;
+    r->last = cur;
+    r->next = f+1;
+}
+
+int snapring_count(const SnapRing* r){ return (int)(r->next - r->first); }
+
+bool snapring_get(const SnapRing* r, int back, Snapshot* out){
+    if(back < 0 || back >= snapring_count(r)) return false;
+    uint32_t f = r->next-1 - (uint32_t)back;
+    if(back==0){ *out = r->last; return true; }
+    uint32_t k = f - f % SNAP_KEY_EVERY;           // >= first: first is always a keyframe
+    *out = *key_for(r, k);
+    uint8_t tmp[SNAP_DELTA_MAX];
+    for(uint32_t g=k+1; g<=f; g++){
+        size_t i = slot(r, g), n = r->len[i];
+        for(size_t j=0;j<n;j++) tmp[j] = r->bytes[(r->start[i] + j) % r->cap];
+        if(!snapshot_apply(out, tmp, n)) return false;
+    }
+    return true;
+}
+
+void snapring_drop(SnapRing* r, int back){
+    int count = snapring_count(r);
+    if(back > count-1) back = count-1;
+    if(back <= 0) return;
+    if(!snapring_get(r, back, &r->last)) return;
+    uint32_t f = r->next-1 - (uint32_t)back;
+    r->head = r->start[slot(r, f+1)];
+    r->next = f+1;
+}
+
+size_t snapring_bytes(const SnapRing* r){
+    if(r->first >= r->next) return 0;
+    size_t keys = (r->next-1) / SNAP_KEY_EVERY - r->first / SNAP_KEY_EVERY + 1;
+    return r->head - tail(r) + keys * sizeof(Snapshot);
+}
@@ -0,0 +1,75 @@
+// snapshot.h — packed save-states of a running game and a delta-compressed history of
+// them. A Snapshot holds only what changes during play: the food bit planes, entity
+// positions and headings, ghost modes, scores, schedule and PRNG state. Walls, gate,
+// spawn points and navigation tables stay with the level, so a snapshot is a few
+// hundred bytes and restoring one is a handful of copies.
+//
+// SnapRing keeps the last N ticks of one game for rewind and rollback: a full snapshot
+// every SNAP_KEY_EVERY frames, and in between the difference from the previous frame
+// (tick delta, pellet bits eaten, entity steps, changed counters), typically around a
+// dozen bytes per tick. Any kept frame is a keyframe plus at most SNAP_KEY_EVERY-1
+// deltas away.
+#ifndef PACMAN_SNAPSHOT_H
+#define PACMAN_SNAPSHOT_H
+
+#include "sim.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct { int8_t x, y, dx, dy; } SnapEntity;
+
+typedef struct {
+    uint32_t pellet[MAP_H], power[MAP_H];
+    SnapEntity pac, ghost[4];
+    uint8_t ghost_mode[4];
+    uint32_t fright_timer[4];
+    int32_t score, pellets;
+    uint32_t ticks, phase_start;
+    uint64_t rng;
+    uint8_t lives, eat_streak, phase_idx, flags;   // flags: SNAP_WON | SNAP_OVER
+} Snapshot;
+
+#define SNAP_WON  1
+#define SNAP_OVER 2
+
+void snapshot_save(const Game* gm, Snapshot* s);
+// gm must already be on the snapshot's level (game_new_level() with the same Level).
+void snapshot_load(Game* gm, const Snapshot* s);
+
+// Delta from prev to cur, at most SNAP_DELTA_MAX bytes; 0 if it does not fit
+// (a new board rather than a tick of play). snapshot_apply() turns prev into cur in
+// place and returns false on malformed input.
+#define SNAP_DELTA_MAX 256
+size_t snapshot_delta(const Snapshot* prev, const Snapshot* cur, uint8_t* out);
+bool snapshot_apply(Snapshot* s, const uint8_t* in, size_t len);
+
+#define SNAP_KEY_EVERY 32
+
+typedef struct {
+    int frames;                 // capacity, a multiple of SNAP_KEY_EVERY
+    uint32_t first, next;       // kept frames [first, next), numbered from the last reset
+    Snapshot* keys;             // frame f % SNAP_KEY_EVERY == 0 at keys[f/SNAP_KEY_EVERY % (frames/SNAP_KEY_EVERY)]
+    Snapshot last;              // frame next-1, the base of the next delta
+    uint8_t* bytes; size_t cap; // delta bytes, a ring addressed by running offsets
+    size_t* start; uint16_t* len;   // per frame slot (f % frames): its delta in bytes
+    size_t head;                // running offset of the next delta byte
+} SnapRing;
+
+// History of about `frames` ticks; false if out of memory.
+bool snapring_init(SnapRing* r, int frames);
+void snapring_free(SnapRing* r);
+// Forget everything and start again from gm's current state (new game, level load).
+void snapring_reset(SnapRing* r, const Game* gm);
+// Append gm's state after a tick. When the history is full the oldest
+// SNAP_KEY_EVERY frames go; a state that is no delta of the last restarts it.
+void snapring_push(SnapRing* r, const Game* gm);
+int snapring_count(const SnapRing* r);
+// The frame `back` ticks before the newest (0 = newest); false if not kept.
+bool snapring_get(const SnapRing* r, int back, Snapshot* out);
+// Drop the newest `back` frames, e.g. after rewinding to snapring_get(r, back).
+// The oldest frame is always kept.
+void snapring_drop(SnapRing* r, int back);
+size_t snapring_bytes(const SnapRing* r);   // delta bytes plus keyframes in use
+
+#endif
@@ -0,0 +1,235 @@
+// stress.c — large generated mazes, shared flow field, spatial-hash collisions.
+
+#include "stress.h"
+#include "nav.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t rand_below(StressWorld* sw, uint32_t n){ return sim_rand(&sw->rng) % n; }
+
+static inline int step_of(const StressWorld* sw, int dir){ return NAV_DIRS[dir][0] + NAV_DIRS[dir][1]*sw->w; }
+static inline bool open_at(const StressWorld* sw, uint32_t i){ return sw->tile[i]!=ST_WALL; }
+
+// Recursive backtracker on the odd-coordinate cells, then braid: most dead ends get
+// an extra opening so there are loops to run around, like a real Pac-Man maze.
+static void generate(StressWorld* sw){
+    int w=sw->w, h=sw->h;
+    memset(sw->tile, ST_WALL, (size_t)w*h);
+    uint32_t* stack = sw->queue;            // reuse: at most one entry per cell
+    int top=0;
+    uint32_t start = 1u*w + 1u;
+    sw->tile[start]=ST_OPEN; stack[top++]=start;
+    while(top>0){
+        uint32_t c=stack[top-1];
+        int cx=(int)(c%w), cy=(int)(c/w);
+        int opts[4], n=0;
+        for(int d=0;d<4;d++){
+            int nx=cx+2*NAV_DIRS[d][0], ny=cy+2*NAV_DIRS[d][1];
+            if(nx<1 || ny<1 || nx>w-2 || ny>h-2) continue;
+            if(sw->tile[(uint32_t)ny*w+nx]==ST_WALL) opts[n++]=d;
+        }
+        if(!n){ top--; continue; }
+        int d=opts[rand_below(sw,(uint32_t)n)];
+        uint32_t mid = c + step_of(sw,d), nxt = mid + step_of(sw,d);
+        sw->tile[mid]=ST_OPEN; sw->tile[nxt]=ST_OPEN; stack[top++]=nxt;
+    }
+    for(int y=1;y<h-1;y+=2) for(int x=1;x<w-1;x+=2){
+        uint32_t c=(uint32_t)y*w+x;
+        int exits=0; for(int d=0;d<4;d++) exits += open_at(sw, c+step_of(sw,d));
+        if(exits!=1 || rand_below(sw,4)==0) continue;
+        for(int tries=0;tries<4;tries++){
+            int d=(int)rand_below(sw,4);
+            int nx=x+2*NAV_DIRS[d][0], ny=y+2*NAV_DIRS[d][1];
+            if(nx<1 || ny<1 || nx>w-2 || ny>h-2) continue;
+            uint32_t mid=c+step_of(sw,d);
+            if(sw->tile[mid]==ST_WALL){ sw->tile[mid]=ST_OPEN; break; }
+        }
+    }
+    sw->pellets=0;
+    for(uint32_t i=0;i<(uint32_t)(w*h);i++) if(sw->tile[i]==ST_OPEN){
+        sw->tile[i] = rand_below(sw,2000)==0 ? ST_POWER : ST_PELLET;
+        sw->pellets++;
+    }
+}
+
+static uint32_t random_open(StressWorld* sw){
+    for(;;){ uint32_t i=rand_below(sw,(uint32_t)(sw->w*sw->h)); if(open_at(sw,i)) return i; }
+}
+
+bool stress_init(StressWorld* sw, int w, int h, int nghosts, uint64_t seed){
+    memset(sw, 0, sizeof *sw);
+    if(w<1 || h<1 || w>STRESS_MAX_SIZE || h>STRESS_MAX_SIZE || nghosts<1 || nghosts>STRESS_MAX_GHOSTS) return false;
+    if(w<5) w=5;
+    if(h<5) h=5;
+    sw->w=w; sw->h=h; sw->nghosts=nghosts;
+    sw->rng = seed ? seed : SIM_DEFAULT_SEED;
+    size_t n=(size_t)w*h;
+    uint32_t buckets=16; while(buckets < 2u*(uint32_t)nghosts) buckets<<=1;
+    sw->bucket_mask=buckets-1;
+    sw->tile=malloc(n); sw->flow=malloc(n);
+    sw->dist=malloc(n*sizeof *sw->dist); sw->seen=calloc(n,sizeof *sw->seen); sw->queue=malloc(n*sizeof *sw->queue);
+    sw->ghosts=calloc(nghosts, sizeof *sw->ghosts);
+    sw->bucket_head=calloc(buckets, sizeof *sw->bucket_head);
+    sw->bucket_next=calloc(nghosts, sizeof *sw->bucket_next);
+    if(!sw->tile || !sw->flow || !sw->dist || !sw->seen || !sw->queue || !sw->ghosts || !sw->bucket_head || !sw->bucket_next){
+        stress_free(sw); return false;
+    }
+    generate(sw);
+    sw->pac = sw->pac_prev = sw->pac_spawn = (uint32_t)((h/2)|1)*w + (uint32_t)((w/2)|1);
+    sw->pac_dir = 0;
+    for(int i=0;i<nghosts;i++){
+        uint32_t at; int tries=0;
+        do{
+            at=random_open(sw);
+            int dx=abs((int)(at%w)-(int)(sw->pac%w)), dy=abs((int)(at/w)-(int)(sw->pac/w));
+            if(dx+dy>20) break;
+        }while(++tries<64);
+        sw->ghosts[i]=(StressGhost){ at, at, at, false };
+    }
+    return true;
+}
+
+void stress_free(StressWorld* sw){
+    free(sw->tile); free(sw->flow); free(sw->dist); free(sw->seen); free(sw->queue);
+    free(sw->ghosts); free(sw->bucket_head); free(sw->bucket_next);
+    memset(sw, 0, sizeof *sw);
+}
+
+void stress_build_field(StressWorld* sw){
+    uint32_t stamp = ++sw->stamp;
+    int head=0, tail=0;
+    sw->queue[tail++]=sw->pac; sw->seen[sw->pac]=stamp; sw->dist[sw->pac]=0; sw->flow[sw->pac]=ST_NO_DIR;
+    while(head<tail){
+        uint32_t c=sw->queue[head++];
+        for(int d=0;d<4;d++){
+            uint32_t n=c+step_of(sw,d);
+            if(!open_at(sw,n) || sw->seen[n]==stamp) continue;
+            sw->seen[n]=stamp; sw->dist[n]=sw->dist[c]+1;
+            sw->flow[n]=(uint8_t)(d^1);          // step back toward c, i.e. toward Pac-Man
+            sw->queue[tail++]=n;
+        }
+    }
+    sw->bfs_tiles += tail;
+}
+
+static void move_pac(StressWorld* sw){
+    uint32_t p=sw->pac;
+    int opts[4], n=0, exits=0;
+    for(int d=0;d<4;d++) if(open_at(sw,p+step_of(sw,d))){ exits++; if(d!=(sw->pac_dir^1)) opts[n++]=d; }
+    if(!exits) return;
+    if(!n) opts[n++]=sw->pac_dir^1;                           // dead end: turn around
+    if(exits!=2 || !open_at(sw,p+step_of(sw,sw->pac_dir)))    // junction or blocked: pick a way
+        sw->pac_dir=opts[rand_below(sw,(uint32_t)n)];
+    sw->pac_prev=p;
+    sw->pac=p+step_of(sw,sw->pac_dir);
+    uint8_t* t=&sw->tile[sw->pac];
+    if(*t==ST_PELLET){ *t=ST_OPEN; sw->score+=10; sw->pellets--; }
+    else if(*t==ST_POWER){
+        *t=ST_OPEN; sw->score+=50; sw->pellets--;
+        sw->fright_until=sw->ticks+FRIGHT_TICKS;
+        for(int i=0;i<sw->nghosts;i++) sw->ghosts[i].fright=true;
+    }
+}
+
+// Frightened ghosts run down the same field: take the neighbour farthest from Pac-Man.
+static void flee(StressWorld* sw, StressGhost* g){
+    uint32_t best=g->at, best_d=sw->seen[g->at]==sw->stamp? sw->dist[g->at] : 0;
+    for(int d=0;d<4;d++){
+        uint32_t n=g->at+step_of(sw,d);
+        if(open_at(sw,n) && sw->seen[n]==sw->stamp && sw->dist[n]>best_d){ best=n; best_d=sw->dist[n]; }
+    }
+    g->at=best;
+}
+
+static void expire_fright(StressWorld* sw){
+    if(sw->fright_until && sw->ticks>=sw->fright_until){
+        sw->fright_until=0;
+        for(int i=0;i<sw->nghosts;i++) sw->ghosts[i].fright=false;
+    }
+}
+
+void stress_move(StressWorld* sw){
+    sw->ticks++;
+    expire_fright(sw);
+    move_pac(sw);
+    // The field was built from Pac-Man's tile at the start of the tick; ghosts chase
+    // where he was, which is what a per-ghost BFS issued at the same moment would do.
+    for(int i=0;i<sw->nghosts;i++){
+        StressGhost* g=&sw->ghosts[i];
+        g->prev=g->at;
+        if(g->fright){ flee(sw,g); continue; }
+        if(sw->seen[g->at]!=sw->stamp) continue;              // walled off from Pac-Man
+        uint8_t d=sw->flow[g->at];
+        if(d!=ST_NO_DIR) g->at+=step_of(sw,d);
+    }
+}
+
+void stress_move_per_ghost_bfs(StressWorld* sw){
+    sw->ticks++;
+    expire_fright(sw);
+    uint32_t target=sw->pac;
+    move_pac(sw);
+    bool any_fright=false;
+    for(int i=0;i<sw->nghosts;i++){
+        StressGhost* g=&sw->ghosts[i];
+        g->prev=g->at;
+        if(g->fright){ any_fright=true; continue; }
+        if(g->at==target) continue;
+        // Early-exit BFS from the ghost, remembering the first step taken.
+        uint32_t stamp=++sw->stamp;
+        int head=0, tail=0;
+        sw->queue[tail++]=g->at; sw->seen[g->at]=stamp;
+        uint8_t found=ST_NO_DIR;
+        while(head<tail && found==ST_NO_DIR){
+            uint32_t c=sw->queue[head++];
+            for(int d=0;d<4;d++){
+                uint32_t n=c+step_of(sw,d);
+                if(!open_at(sw,n) || sw->seen[n]==stamp) continue;
+                sw->seen[n]=stamp; sw->flow[n] = (c==g->at)? (uint8_t)d : sw->flow[c];
+                if(n==target){ found=sw->flow[n]; break; }
+                sw->queue[tail++]=n;
+            }
+        }
+        sw->bfs_tiles += tail;
+        if(found!=ST_NO_DIR) g->at+=step_of(sw,found);
+    }
+    if(any_fright){
+        uint32_t now=sw->pac; sw->pac=target;
+        stress_build_field(sw);
+        sw->pac=now;
+        for(int i=0;i<sw->nghosts;i++) if(sw->ghosts[i].fright) flee(sw,&sw->ghosts[i]);
+    }
+}
+
+static inline uint32_t bucket_of(const StressWorld* sw, uint32_t tile){ return (tile*2654435761u >> 7) & sw->bucket_mask; }
+
+void stress_collide(StressWorld* sw){
+    memset(sw->bucket_head, 0, (sw->bucket_mask+1)*sizeof *sw->bucket_head);
+    for(int i=0;i<sw->nghosts;i++){
+        uint32_t b=bucket_of(sw, sw->ghosts[i].at);
+        sw->bucket_next[i]=sw->bucket_head[b]; sw->bucket_head[b]=(uint32_t)i+1;
+    }
+    // Same tile after the move, or Pac-Man and a ghost swapped tiles through each other.
+    uint32_t probes[2]={ sw->pac, sw->pac_prev };
+    for(int p=0;p<2;p++){
+        for(uint32_t k=sw->bucket_head[bucket_of(sw,probes[p])]; k; k=sw->bucket_next[k-1]){
+            StressGhost* g=&sw->ghosts[k-1];
+            bool hit = p==0 ? g->at==sw->pac : (g->at==sw->pac_prev && g->prev==sw->pac);
+            if(!hit) continue;
+            if(g->fright){
+                g->fright=false; g->at=g->prev=g->spawn;
+                sw->score+=200; sw->ghosts_eaten++;
+            }else{
+                sw->deaths++;
+                sw->pac=sw->pac_prev=sw->pac_spawn;
+                return;
+            }
+        }
+    }
+}
+
+void stress_step(StressWorld* sw){
+    stress_build_field(sw);
+    stress_move(sw);
+    stress_collide(sw);
+}
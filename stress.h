@@ -0,0 +1,59 @@
+// stress.h — stress scenarios on large generated mazes with hundreds of ghosts.
+// Unlike sim.h (fixed 28x31 board, four ghosts), sizes here are chosen at run time.
+// Chasing ghosts share one reverse-BFS flow field from Pac-Man, rebuilt once per tick,
+// and collisions go through a tile-bucket spatial hash, so a tick costs O(maze) once
+// plus O(ghosts) rather than O(maze x ghosts).
+#ifndef PACMAN_STRESS_H
+#define PACMAN_STRESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum { ST_WALL=0, ST_OPEN=1, ST_PELLET=2, ST_POWER=3 };
+#define ST_NO_DIR 0xFF
+
+typedef struct {
+    uint32_t at, prev;          // tile index (y*w+x) now and before the last move
+    uint32_t spawn;
+    bool fright;
+} StressGhost;
+
+typedef struct {
+    int w, h;
+    uint8_t*  tile;             // ST_* per tile
+    uint8_t*  flow;             // direction (NAV_DIRS order) toward Pac-Man, ST_NO_DIR if unreached
+    uint32_t* dist;             // steps to Pac-Man, valid where seen[i]==stamp
+    uint32_t* seen; uint32_t stamp;
+    uint32_t* queue;
+
+    int nghosts;
+    StressGhost* ghosts;
+    uint32_t* bucket_head;      // spatial hash: tile -> first ghost+1 (0 = empty)
+    uint32_t* bucket_next;      // per ghost: next ghost+1 in the same bucket
+    uint32_t  bucket_mask;
+
+    uint32_t pac, pac_prev, pac_spawn; int pac_dir;
+    uint64_t rng;
+    uint32_t ticks, fright_until;
+    long score, deaths, ghosts_eaten, pellets;
+    long bfs_tiles;             // tiles expanded by path searches, for reporting
+} StressWorld;
+
+#define STRESS_MAX_SIZE 4097         // maze width and height
+#define STRESS_MAX_GHOSTS (1<<20)
+
+// Generate a braided w x h maze (odd sizes work best) with nghosts ghosts. Returns
+// false if out of memory, or if w, h or nghosts is outside 1..STRESS_MAX_*.
+bool stress_init(StressWorld* sw, int w, int h, int nghosts, uint64_t seed);
+void stress_free(StressWorld* sw);
+
+// One tick = the three phases below, in order.
+void stress_step(StressWorld* sw);
+void stress_build_field(StressWorld* sw);          // reverse BFS from Pac-Man
+void stress_move(StressWorld* sw);                 // Pac-Man random walk + ghosts follow/flee the field
+void stress_collide(StressWorld* sw);              // spatial hash lookup at Pac-Man's tile
+
+// Baseline for comparison: one early-exit BFS per chasing ghost instead of the shared field.
+void stress_move_per_ghost_bfs(StressWorld* sw);
+
+#endif
@@ -0,0 +1,193 @@
+// swrender.c — CPU framebuffer drawing and the software game renderer (see swrender.h).
+#include "swrender.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// ===== Framebuffer =====
+bool fb_init(Framebuffer* fb, int w, int h){
+    fb->px = calloc((size_t)w*(size_t)h, sizeof *fb->px);
+    fb->w = fb->px ? w : 0; fb->h = fb->px ? h : 0; fb->stride = fb->w;
+    return fb->px != NULL;
+}
+
+void fb_free(Framebuffer* fb){ free(fb->px); memset(fb, 0, sizeof *fb); }
+
+// Clip a rect to the framebuffer; false if nothing is left.
+static bool clip(const Framebuffer* fb, int* x, int* y, int* w, int* h){
+    if(*x < 0){ *w += *x; *x = 0; }
+    if(*y < 0){ *h += *y; *y = 0; }
+    if(*x + *w > fb->w) *w = fb->w - *x;
+    if(*y + *h > fb->h) *h = fb->h - *y;
+    return *w > 0 && *h > 0;
+}
+
+static void fill_row(uint32_t* p, int n, uint32_t rgb){
+    int i = 0;
+#if defined(__SSE2__)
+    __m128i v = _mm_set1_epi32((int)rgb);
+    for(; i+4<=n; i+=4) _mm_storeu_si128((__m128i*)(p+i), v);
+#elif defined(__ARM_NEON)
+    uint32x4_t v = vdupq_n_u32(rgb);
+    for(; i+4<=n; i+=4) vst1q_u32(p+i, v);
+#endif
+    for(; i<n; i++) p[i] = rgb;
+}
+
+void fb_fill(Framebuffer* fb, int x, int y, int w, int h, uint32_t rgb){
+    if(!clip(fb, &x, &y, &w, &h)) return;
+    for(int r=0;r<h;r++) fill_row(fb->px + (size_t)(y+r)*fb->stride + x, w, rgb);
+}
+
+// dst = (rgb*alpha + dst*(256-alpha)) >> 8 per channel, alpha scaled to 0..256.
+static void blend_row(uint32_t* p, int n, uint32_t rgb, int a){
+    int i = 0;
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int)rgb), zero), _mm_set1_epi16((short)a));
+    __m128i ia = _mm_set1_epi16((short)(256-a));
+    for(; i+4<=n; i+=4){
+        __m128i d = _mm_loadu_si128((const __m128i*)(p+i));
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), ia), src), 8);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), ia), src), 8);
+        _mm_storeu_si128((__m128i*)(p+i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    uint32_t sr = (rgb>>16 & 255)*a, sg = (rgb>>8 & 255)*a, sb = (rgb & 255)*a;
+    for(; i<n; i++){
+        uint32_t d = p[i], ia = 256-(uint32_t)a;
+        p[i] = ((((d>>16 & 255)*ia + sr) >> 8) << 16) | ((((d>>8 & 255)*ia + sg) >> 8) << 8) | (((d & 255)*ia + sb) >> 8);
+    }
+}
+
+void fb_blend(Framebuffer* fb, int x, int y, int w, int h, uint32_t rgb, int alpha){
+    if(alpha <= 0 || !clip(fb, &x, &y, &w, &h)) return;
+    if(alpha >= 255){ fb_fill(fb, x, y, w, h, rgb); return; }
+    int a = alpha + (alpha >> 7);                       // 0..255 -> 0..256
+    for(int r=0;r<h;r++) blend_row(fb->px + (size_t)(y+r)*fb->stride + x, w, rgb & 0xFFFFFF, a);
+}
+
+void fb_blit(Framebuffer* dst, int dx, int dy, const Framebuffer* src, int sx, int sy, int w, int h){
+    // Clip against the source, then the destination, moving the other origin along.
+    if(sx < 0){ w += sx; dx -= sx; sx = 0; }
+    if(sy < 0){ h += sy; dy -= sy; sy = 0; }
+    if(sx + w > src->w) w = src->w - sx;
+    if(sy + h > src->h) h = src->h - sy;
+    int cx = dx, cy = dy;
+    if(!clip(dst, &cx, &cy, &w, &h)) return;
+    sx += cx - dx; sy += cy - dy;
+    for(int r=0;r<h;r++)
+        memcpy(dst->px + (size_t)(cy+r)*dst->stride + cx, src->px + (size_t)(sy+r)*src->stride + sx, (size_t)w*sizeof(uint32_t));
+}
+
+// ===== Text =====
+// 5x7 dots per glyph for ASCII 32..95, a row per byte with bit 4 on the left.
+static const uint8_t FONT[64][7] = {
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x04,0x04,0x04,0x04,0x04,0x00,0x04}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00},   //  !"#
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x18,0x19,0x02,0x04,0x08,0x13,0x03}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x0C,0x04,0x08,0x00,0x00,0x00,0x00},   // $%&'
+    {0x02,0x04,0x08,0x08,0x08,0x04,0x02}, {0x08,0x04,0x02,0x02,0x02,0x04,0x08}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x00,0x04,0x04,0x1F,0x04,0x04,0x00},   // ()*+
+    {0x00,0x00,0x00,0x00,0x0C,0x04,0x08}, {0x00,0x00,0x00,0x1F,0x00,0x00,0x00}, {0x00,0x00,0x00,0x00,0x00,0x0C,0x0C}, {0x00,0x01,0x02,0x04,0x08,0x10,0x00},   // ,-./
+    {0x0E,0x11,0x13,0x15,0x19,0x11,0x0E}, {0x04,0x0C,0x04,0x04,0x04,0x04,0x0E}, {0x0E,0x11,0x01,0x02,0x04,0x08,0x1F}, {0x1F,0x02,0x04,0x02,0x01,0x11,0x0E},   // 0123
+    {0x02,0x06,0x0A,0x12,0x1F,0x02,0x02}, {0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E}, {0x06,0x08,0x10,0x1E,0x11,0x11,0x0E}, {0x1F,0x01,0x02,0x04,0x08,0x08,0x08},   // 4567
+    {0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E}, {0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C}, {0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00},   // 89:;
+    {0x02,0x04,0x08,0x10,0x08,0x04,0x02}, {0x00,0x00,0x1F,0x00,0x1F,0x00,0x00}, {0x08,0x04,0x02,0x01,0x02,0x04,0x08}, {0x0E,0x11,0x01,0x02,0x04,0x00,0x04},   // <=>?
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x0E,0x11,0x11,0x1F,0x11,0x11,0x11}, {0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E}, {0x0E,0x11,0x10,0x10,0x10,0x11,0x0E},   // @ABC
+    {0x1C,0x12,0x11,0x11,0x11,0x12,0x1C}, {0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F}, {0x1F,0x10,0x10,0x1E,0x10,0x10,0x10}, {0x0E,0x11,0x10,0x17,0x11,0x11,0x0F},   // DEFG
+    {0x11,0x11,0x11,0x1F,0x11,0x11,0x11}, {0x0E,0x04,0x04,0x04,0x04,0x04,0x0E}, {0x07,0x02,0x02,0x02,0x02,0x12,0x0C}, {0x11,0x12,0x14,0x18,0x14,0x12,0x11},   // HIJK
+    {0x10,0x10,0x10,0x10,0x10,0x10,0x1F}, {0x11,0x1B,0x15,0x15,0x11,0x11,0x11}, {0x11,0x11,0x19,0x15,0x13,0x11,0x11}, {0x0E,0x11,0x11,0x11,0x11,0x11,0x0E},   // LMNO
+    {0x1E,0x11,0x11,0x1E,0x10,0x10,0x10}, {0x0E,0x11,0x11,0x11,0x15,0x12,0x0D}, {0x1E,0x11,0x11,0x1E,0x14,0x12,0x11}, {0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E},   // PQRS
+    {0x1F,0x04,0x04,0x04,0x04,0x04,0x04}, {0x11,0x11,0x11,0x11,0x11,0x11,0x0E}, {0x11,0x11,0x11,0x11,0x11,0x0A,0x04}, {0x11,0x11,0x11,0x15,0x15,0x15,0x0A},   // TUVW
+    {0x11,0x11,0x0A,0x04,0x0A,0x11,0x11}, {0x11,0x11,0x11,0x0A,0x04,0x04,0x04}, {0x1F,0x01,0x02,0x04,0x08,0x10,0x1F}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00},   // XYZ[
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x00,0x00,0x00,0x00,0x1F},   // \]^_
+};
+
+void fb_text(Framebuffer* fb, int x, int y, const char* s, uint32_t rgb, int scale){
+    for(; *s; s++, x += 6*scale){
+        int c = (unsigned char)*s;
+        if(c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        if(c < 32 || c > 95) c = '?';
+        const uint8_t* g = FONT[c-32];
+        for(int row=0;row<7;row++)
+            for(int col=0;col<5;col++)
+                if(g[row] >> (4-col) & 1) fb_fill(fb, x+col*scale, y+row*scale, scale, scale, rgb);
+    }
+}
+
+int fb_text_width(const char* s, int scale){
+    int n = (int)strlen(s);
+    return n ? (6*n-1)*scale : 0;
+}
+
+// ===== Game =====
+// Colours and geometry match render_game() in pacman2.c.
+#define COL_WALL    SW_RGB(0,0,160)
+#define COL_GATE    SW_RGB(80,80,80)
+#define COL_PELLET  SW_RGB(255,215,0)
+#define COL_POWER   SW_RGB(255,255,255)
+#define COL_PAC     SW_RGB(255,255,0)
+#define COL_FRIGHT  SW_RGB(0,0,255)
+#define COL_SCORE   SW_RGB(50,200,50)
+static const uint32_t GHOST_COL[4] = { SW_RGB(255,0,0), SW_RGB(255,105,180), SW_RGB(0,255,255), SW_RGB(255,165,0) };
+
+static void draw_tile(Framebuffer* fb, int x, int y, char c){
+    int px = x*SW_TILE, py = y*SW_TILE;
+    fb_fill(fb, px, py, SW_TILE, SW_TILE, 0);
+    if(c=='#') fb_fill(fb, px, py, SW_TILE, SW_TILE, COL_WALL);
+    else if(c=='H') fb_fill(fb, px, py, SW_TILE, 4, COL_GATE);
+    else if(c=='.') fb_fill(fb, px+SW_TILE/2-2, py+SW_TILE/2-2, 4, 4, COL_PELLET);
+    else if(c=='o') fb_fill(fb, px+SW_TILE/2-5, py+SW_TILE/2-5, 10, 10, COL_POWER);
+}
+
+bool swr_init(SwRenderer* sr){
+    memset(sr, 0, sizeof *sr);
+    return fb_init(&sr->board, SW_W, SW_H);
+}
+
+void swr_free(SwRenderer* sr){ fb_free(&sr->board); sr->level = NULL; }
+
+void swr_positions(const Game* gm, Point out[5]){
+    out[0] = (Point){gm->pac.x, gm->pac.y};
+    for(int i=0;i<4;i++) out[i+1] = (Point){gm->ghosts[i].e.x, gm->ghosts[i].e.y};
+}
+
+// Pixel coordinate between two tiles; a jump of more than one tile (tunnel wrap,
+// respawn) snaps instead of sliding across the board.
+static int lerp_px(int from, int to, float alpha){
+    if(from-to>1 || to-from>1) return to*SW_TILE;
+    return (int)((float)(from*SW_TILE) + (float)((to-from)*SW_TILE)*alpha + 0.5f);
+}
+
+void swr_draw(SwRenderer* sr, Framebuffer* out, const Game* gm, const Point* prev, float alpha){
+    // Board: bake on the first frame, then redraw only tiles that changed; a new or
+    // reloaded level is just more of them.
+    bool rebake = !sr->level;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        char c = gm->board[y][x];
+        if(rebake || sr->shown[y][x] != c){ draw_tile(&sr->board, x, y, c); sr->shown[y][x] = c; }
+    }
+    sr->level = gm->level;
+    fb_blit(out, 0, 0, &sr->board, 0, 0, SW_W, SW_H);
+
+    if(!prev) alpha = 1.0f;
+    Point pos[5]; swr_positions(gm, pos);
+    for(int i=0;i<5;i++){
+        Point from = prev ? prev[i] : pos[i];
+        uint32_t col = i==0 ? COL_PAC : gm->ghosts[i-1].mode==MODE_FRIGHT ? COL_FRIGHT : GHOST_COL[i-1];
+        fb_fill(out, lerp_px(from.x, pos[i].x, alpha), lerp_px(from.y, pos[i].y, alpha), SW_TILE, SW_TILE, col);
+    }
+    fb_fill(out, 0, SW_H-6, (gm->score%2000)*SW_W/2000, 6, COL_SCORE);
+    for(int i=0;i<gm->lives;i++) fb_fill(out, i*14, 0, 12, 6, COL_PAC);
+
+    if(gm->won || gm->over){
+        const char* title = gm->won ? "YOU WIN" : "GAME OVER";
+        char score[32]; snprintf(score, sizeof score, "SCORE %d", gm->score);
+        fb_blend(out, SW_W/2-160, SW_H/2-80, 320, 160, 0, 180);
+        fb_text(out, SW_W/2 - fb_text_width(title, 4)/2, SW_H/2-50, title, SW_RGB(255,255,255), 4);
+        fb_text(out, SW_W/2 - fb_text_width(score, 3)/2, SW_H/2+20, score, SW_RGB(255,255,255), 3);
+    }
+}
@@ -0,0 +1,53 @@
+// swrender.h — software renderer: draws the game into a plain 32-bit CPU framebuffer
+// with no SDL, GPU or font library, for machines without a display and for video
+// capture (capture.h). Same layout as the window (pacman2.c render_game): baked
+// walls and pellets, interpolated entities (as the flat rects of --flat-sprites, not
+// the window's sprites), score and lives bars, plus the end-of-game banner in a
+// built-in 5x7 font.
+//
+// Fills and blends of the TILE-sized rects use SSE2 or NEON where the compiler has
+// them (plain loops otherwise); the board is baked once into its own framebuffer,
+// patched tile by tile as pellets go or a level changes, and copied row by row each frame.
+#ifndef PACMAN_SWRENDER_H
+#define PACMAN_SWRENDER_H
+
+#include "sim.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SW_TILE 20                  // same scale as the window (TILE in pacman2.c)
+#define SW_W (MAP_W*SW_TILE)
+#define SW_H (MAP_H*SW_TILE)
+
+#define SW_RGB(r,g,b) ((uint32_t)(r)<<16 | (uint32_t)(g)<<8 | (uint32_t)(b))
+
+// Pixels are 0x00RRGGBB; stride is in pixels. fb_init() owns its pixels, a
+// Framebuffer may also wrap someone else's (a capture slot).
+typedef struct { uint32_t* px; int w, h, stride; } Framebuffer;
+
+bool fb_init(Framebuffer* fb, int w, int h);
+void fb_free(Framebuffer* fb);
+// All drawing is clipped to the framebuffer.
+void fb_fill(Framebuffer* fb, int x, int y, int w, int h, uint32_t rgb);
+void fb_blend(Framebuffer* fb, int x, int y, int w, int h, uint32_t rgb, int alpha);   // alpha 0..255
+void fb_blit(Framebuffer* dst, int dx, int dy, const Framebuffer* src, int sx, int sy, int w, int h);
+// Upper-case 5x7 glyphs (lower case is drawn as upper), `scale` pixels per dot.
+void fb_text(Framebuffer* fb, int x, int y, const char* s, uint32_t rgb, int scale);
+int fb_text_width(const char* s, int scale);
+
+typedef struct {
+    Framebuffer board;              // walls and pellets
+    char shown[MAP_H][MAP_W];       // board contents the baked framebuffer shows
+    const Level* level;             // level of the last frame; NULL before the first
+} SwRenderer;
+
+bool swr_init(SwRenderer* sr);
+void swr_free(SwRenderer* sr);
+// Entity tiles before a tick, for interpolation: [0] Pac-Man, [1..4] the ghosts.
+void swr_positions(const Game* gm, Point out[5]);
+// One frame of gm into out (at least SW_W x SW_H). prev may be NULL to draw entities
+// on their tiles; alpha is the fraction of the tick elapsed (0..1). The end banner
+// shows when the game is won or over.
+void swr_draw(SwRenderer* sr, Framebuffer* out, const Game* gm, const Point* prev, float alpha);
+
+#endif
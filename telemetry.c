@@ -0,0 +1,162 @@
+// telemetry.c — per-thread event rings and the background writer (see telemetry.h).
+#define _POSIX_C_SOURCE 200809L
+#include "telemetry.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RING_MASK (TELEM_RING-1u)
+
+// Owner and writer fields on separate cache lines: the owner only moves head, the
+// writer only moves tail.
+struct TelemRing {
+    TelemEvent ev[TELEM_RING];
+    _Alignas(64) _Atomic uint32_t head;         // events put so far; slot is head & RING_MASK
+    _Atomic uint32_t dropped;
+    _Alignas(64) _Atomic uint32_t tail;         // events written out so far
+    _Atomic bool detached;                      // owner is gone: free once drained
+    uint32_t stream;
+    TelemLog* log;
+    TelemRing* next;
+};
+
+struct TelemLog {
+    FILE* f;
+    pthread_t thread;
+    pthread_mutex_t mu;                         // rings list, stream numbers, stop
+    pthread_cond_t wake;
+    bool stop, failed;
+    TelemRing* rings;
+    uint32_t streams;
+    TelemStats st;
+};
+
+_Thread_local TelemRing* telem_ring = NULL;
+
+void telem_put(TelemRing* r, uint32_t tick, int type, int x, int y, int arg, int32_t value, int32_t value2){
+    uint32_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if(h - atomic_load_explicit(&r->tail, memory_order_acquire) >= TELEM_RING){
+        atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    TelemEvent* e = &r->ev[h & RING_MASK];
+    e->tick = tick; e->type = (uint8_t)type; e->x = (uint8_t)x; e->y = (uint8_t)y; e->arg = (uint8_t)arg;
+    e->value = value; e->value2 = value2;
+    atomic_store_explicit(&r->head, h+1, memory_order_release);
+}
+
+uint32_t telem_layout_hash(const Level* lv){
+    uint32_t h = 2166136261u;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){ h ^= (unsigned char)lv->layout[y][x]; h *= 16777619u; }
+    return h;
+}
+
+// ===== Writer =====
+// One block per ring with anything new: the events between tail and head, in at most
+// two pieces when they wrap.
+static void drain(TelemLog* lg, TelemRing* r){
+    uint32_t h = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t lost = atomic_exchange_explicit(&r->dropped, 0, memory_order_relaxed);
+    if(h==t && !lost) return;
+    TelemBlock b = { {'P','M','T','B'}, r->stream, h-t, lost };
+    uint32_t at = t & RING_MASK, first = h-t < TELEM_RING-at ? h-t : TELEM_RING-at;
+    bool ok = fwrite(&b, sizeof b, 1, lg->f)==1 &&
+              fwrite(&r->ev[at], sizeof(TelemEvent), first, lg->f)==first &&
+              fwrite(&r->ev[0], sizeof(TelemEvent), h-t-first, lg->f)==h-t-first;
+    if(!ok) lg->failed = true;
+    atomic_store_explicit(&r->tail, h, memory_order_release);
+    lg->st.events += h-t; lg->st.dropped += lost; lg->st.blocks++;
+    lg->st.bytes += sizeof b + (uint64_t)(h-t)*sizeof(TelemEvent);
+}
+
+static void* writer_main(void* arg){
+    TelemLog* lg = arg;
+    pthread_mutex_lock(&lg->mu);
+    for(;;){
+        bool stop = lg->stop;
+        for(TelemRing** pr = &lg->rings; *pr; ){
+            TelemRing* r = *pr;
+            bool gone = atomic_load(&r->detached);     // before draining, so its last events are in
+            drain(lg, r);
+            if(gone){ *pr = r->next; free(r); }
+            else pr = &r->next;
+        }
+        if(fflush(lg->f)!=0) lg->failed = true;
+        if(stop) break;
+        struct timespec ts; clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += TELEM_FLUSH_MS*1000000L;
+        if(ts.tv_nsec >= 1000000000L){ ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+        pthread_cond_timedwait(&lg->wake, &lg->mu, &ts);
+    }
+    pthread_mutex_unlock(&lg->mu);
+    return NULL;
+}
+
+// ===== Sessions =====
+TelemLog* telem_open(const char* path, char* err, size_t errlen){
+    TelemLog* lg = calloc(1, sizeof *lg);
+    if(!lg){ snprintf(err, errlen, "telemetry: out of memory"); return NULL; }
+    if(!(lg->f = fopen(path, "ab"))){
+        snprintf(err, errlen, "telemetry: cannot open %s: %s", path, strerror(errno));
+        free(lg); return NULL;
+    }
+    setvbuf(lg->f, NULL, _IOFBF, 1<<20);
+    TelemHeader hd = { {'P','M','T','L'}, TELEM_VERSION, sizeof(TelemEvent), MAP_W, MAP_H, TICK_MS, 0, (int64_t)time(NULL) };
+    if(fwrite(&hd, sizeof hd, 1, lg->f)!=1){
+        snprintf(err, errlen, "telemetry: cannot write %s", path);
+        fclose(lg->f); free(lg); return NULL;
+    }
+    lg->st.bytes = sizeof hd;
+    pthread_mutex_init(&lg->mu, NULL);
+    pthread_cond_init(&lg->wake, NULL);
+    if(pthread_create(&lg->thread, NULL, writer_main, lg)!=0){
+        snprintf(err, errlen, "telemetry: cannot start the writer thread");
+        pthread_mutex_destroy(&lg->mu); pthread_cond_destroy(&lg->wake);
+        fclose(lg->f); free(lg); return NULL;
+    }
+    return lg;
+}
+
+bool telem_attach(TelemLog* lg){
+    if(telem_ring) telem_detach();
+    TelemRing* r = aligned_alloc(64, sizeof *r);
+    if(!r) return false;
+    atomic_init(&r->head, 0); atomic_init(&r->tail, 0); atomic_init(&r->dropped, 0);
+    atomic_init(&r->detached, false);
+    r->log = lg;
+    pthread_mutex_lock(&lg->mu);
+    r->stream = ++lg->streams;
+    r->next = lg->rings; lg->rings = r;
+    pthread_mutex_unlock(&lg->mu);
+    telem_ring = r;
+    return true;
+}
+
+void telem_detach(void){
+    if(!telem_ring) return;
+    atomic_store(&telem_ring->detached, true);
+    telem_ring = NULL;
+}
+
+bool telem_close(TelemLog* lg, TelemStats* stats){
+    if(!lg) return false;
+    if(telem_ring && telem_ring->log==lg) telem_detach();
+    pthread_mutex_lock(&lg->mu);
+    lg->stop = true;
+    pthread_cond_signal(&lg->wake);
+    pthread_mutex_unlock(&lg->mu);
+    pthread_join(lg->thread, NULL);
+    // The last pass drained everything; rings still listed belong to threads that never
+    // detached and are not written to again.
+    while(lg->rings){ TelemRing* r = lg->rings; lg->rings = r->next; free(r); }
+    bool ok = fclose(lg->f)==0 && !lg->failed;
+    if(stats) *stats = lg->st;
+    pthread_mutex_destroy(&lg->mu); pthread_cond_destroy(&lg->wake);
+    free(lg);
+    return ok;
+}
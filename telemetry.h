@@ -0,0 +1,95 @@
+// telemetry.h — gameplay event log for tuning difficulty from real sessions. The
+// rules in sim.c report what happened (game start, Pac-Man entering a tile, pellets,
+// power pellets, ghosts eaten with the eat streak, deaths, schedule phase switches,
+// games won or lost) as 16-byte records; tools/telemstat.c turns a log into per-tile
+// death and traffic heatmaps and phase-timing statistics.
+//
+// Logging never waits: each thread that joins with telem_attach() appends to its own
+// single-producer ring, and a background writer drains every ring into the file in
+// blocks. A full ring drops the event and counts it instead of blocking the step.
+// Like trace.h the switch is per thread, so copies of a game stepped elsewhere
+// (autopilot search, benchmarks) stay silent; a thread that never attached pays one
+// branch per site. Build with -DPACMAN_NO_TELEMETRY to compile the sites out.
+//
+// File layout, native byte order, append-only: every telem_open() starts a session
+// with a TelemHeader, followed by TelemBlocks of `count` TelemEvents each. Blocks of
+// different threads interleave; within one stream they are in order, and a stream's
+// games are its TE_START records. A session cut short (crash, kill) loses at most the
+// events still in the rings and can leave a partial block at the end of the file.
+#ifndef PACMAN_TELEMETRY_H
+#define PACMAN_TELEMETRY_H
+
+#include "sim.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEM_VERSION 1
+#define TELEM_RING 65536        // events per thread (power of two)
+#define TELEM_FLUSH_MS 20       // writer wakes this often
+
+// x, y: Pac-Man's tile unless noted. value/value2 per type:
+typedef enum {
+    TE_START,                   // game_new_level: arg phase count, value seed (low 32 bits), value2 layout hash
+    TE_MOVE,                    // Pac-Man entered tile x,y
+    TE_PELLET,                  // value pellets left
+    TE_POWER,                   // value pellets left
+    TE_GHOST_EATEN,             // arg ghost, value eat_streak after this one (1 = first), value2 points
+    TE_DEATH,                   // x,y where it happened; arg ghost, value lives left, value2 the ghost's mode
+    TE_PHASE,                   // schedule switch, x: index of the phase that ended, arg its mode,
+                                // value ticks it lasted (frightened ghosts hold a switch back), value2 its scheduled ticks
+    TE_WON,                     // value score, value2 lives
+    TE_OVER,                    // value score
+    TE_COUNT
+} TelemType;
+
+typedef struct {
+    uint32_t tick;
+    uint8_t type, x, y, arg;
+    int32_t value, value2;
+} TelemEvent;
+
+typedef struct {
+    char magic[4];              // "PMTL"
+    uint16_t version, event_size;
+    uint16_t map_w, map_h;
+    uint16_t tick_ms, reserved;
+    int64_t started;            // Unix time of telem_open()
+} TelemHeader;
+
+typedef struct {
+    char magic[4];              // "PMTB"
+    uint32_t stream;            // attaching thread, numbered from 1 within a session
+    uint32_t count;             // events that follow
+    uint32_t dropped;           // events this stream lost to a full ring since its last block
+} TelemBlock;
+
+typedef struct { uint64_t events, dropped, blocks, bytes; } TelemStats;
+
+typedef struct TelemRing TelemRing;
+typedef struct TelemLog TelemLog;
+
+extern _Thread_local TelemRing* telem_ring;     // NULL: this thread does not log
+
+// Append to path (created if missing) and start the writer; NULL with the reason in err.
+TelemLog* telem_open(const char* path, char* err, size_t errlen);
+// Log from the calling thread from now on; false if out of memory.
+bool telem_attach(TelemLog* log);
+// Stop logging from the calling thread; what it logged is still written.
+void telem_detach(void);
+// Write everything left and close the file. Every thread must have detached.
+// stats (may be NULL) gets the session totals; false if a write failed.
+bool telem_close(TelemLog* log, TelemStats* stats);
+
+void telem_put(TelemRing* r, uint32_t tick, int type, int x, int y, int arg, int32_t value, int32_t value2);
+// Layout fingerprint for TE_START, so an analyzer can keep levels apart.
+uint32_t telem_layout_hash(const Level* lv);
+
+#ifndef PACMAN_NO_TELEMETRY
+#define TELEM(gm, type, x, y, arg, v, v2) \
+    do{ if(telem_ring) telem_put(telem_ring, (gm)->ticks, (type), (x), (y), (arg), (int32_t)(v), (int32_t)(v2)); }while(0)
+#else
+#define TELEM(gm, type, x, y, arg, v, v2) do{}while(0)
+#endif
+
+#endif
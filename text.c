@@ -0,0 +1,224 @@
+// text.c — glyph atlas, quad batching and a (text, colour) layout cache.
+
+#include "text.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ATLAS_W 512
+#define CACHE_SLOTS 64
+
+typedef struct { Uint32 cp; SDL_Rect src; int advance; } Glyph;
+
+// Printable ASCII, Latin-1, and the typographic punctuation the menus use.
+static const Uint32 EXTRA_CPS[] = { 0x2013, 0x2014, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2026 };
+#define EXTRA_COUNT ((int)(sizeof EXTRA_CPS / sizeof EXTRA_CPS[0]))
+#define MAX_GLYPHS (95 + 96 + EXTRA_COUNT)
+
+typedef struct {
+    Uint32 hash; char* text; SDL_Color color;
+    SDL_Vertex* verts; int nverts; int width;
+    Uint32 last_used;
+} CacheEntry;
+
+struct TextSys {
+    SDL_Renderer* r;
+    SDL_Texture* atlas;
+    int atlas_h, line_h;
+    Glyph glyphs[MAX_GLYPHS]; int nglyphs;
+    short latin[256];                 // cp < 256 -> glyph slot, -1 if absent
+    int fallback;                     // slot used for unknown code points ('?')
+    CacheEntry cache[CACHE_SLOTS];
+    Uint32 clock;
+    SDL_Vertex* scratch; int* indices; int scratch_cap;   // in quads
+    TextStats stats;
+};
+
+static Uint32 next_cp(const char** s){
+    const unsigned char* p=(const unsigned char*)*s;
+    Uint32 cp; int n;
+    if(p[0]<0x80){ cp=p[0]; n=1; }
+    else if((p[0]&0xE0)==0xC0 && p[1]){ cp=((p[0]&0x1Fu)<<6)|(p[1]&0x3Fu); n=2; }
+    else if((p[0]&0xF0)==0xE0 && p[1] && p[2]){ cp=((p[0]&0x0Fu)<<12)|((p[1]&0x3Fu)<<6)|(p[2]&0x3Fu); n=3; }
+    else if((p[0]&0xF8)==0xF0 && p[1] && p[2] && p[3]){ cp=((p[0]&0x07u)<<18)|((p[1]&0x3Fu)<<12)|((p[2]&0x3Fu)<<6)|(p[3]&0x3Fu); n=4; }
+    else { cp='?'; n=1; }
+    *s += n;
+    return cp;
+}
+
+static void put_utf8(char* out, Uint32 cp){
+    if(cp<0x80){ out[0]=(char)cp; out[1]=0; }
+    else if(cp<0x800){ out[0]=(char)(0xC0|(cp>>6)); out[1]=(char)(0x80|(cp&0x3F)); out[2]=0; }
+    else { out[0]=(char)(0xE0|(cp>>12)); out[1]=(char)(0x80|((cp>>6)&0x3F)); out[2]=(char)(0x80|(cp&0x3F)); out[3]=0; }
+}
+
+static const Glyph* glyph_for(const TextSys* ts, Uint32 cp){
+    if(cp<256){ int s=ts->latin[cp]; return &ts->glyphs[s>=0? s : ts->fallback]; }
+    for(int i=0;i<ts->nglyphs;i++) if(ts->glyphs[i].cp==cp) return &ts->glyphs[i];
+    return &ts->glyphs[ts->fallback];
+}
+
+TextSys* text_create(SDL_Renderer* r, TTF_Font* font){
+    if(!r || !font) return NULL;
+    TextSys* ts = calloc(1, sizeof *ts);
+    if(!ts) return NULL;
+    ts->r = r;
+    ts->line_h = TTF_FontHeight(font);
+    for(int i=0;i<256;i++) ts->latin[i]=-1;
+
+    Uint32 cps[MAX_GLYPHS]; int n=0;
+    for(Uint32 c=32;c<127;c++) cps[n++]=c;
+    for(Uint32 c=160;c<256;c++) cps[n++]=c;
+    for(int i=0;i<EXTRA_COUNT;i++) cps[n++]=EXTRA_CPS[i];
+
+    // Rasterize each glyph once (white; colour comes from the vertices) and shelf-pack.
+    SDL_Surface* surf[MAX_GLYPHS] = {0};
+    int x=0, y=0;
+    for(int i=0;i<n;i++){
+        char buf[5]; put_utf8(buf, cps[i]);
+        if(cps[i]>=0x80 && !TTF_GlyphIsProvided(font, (Uint16)cps[i])) continue;
+        SDL_Surface* s = (cps[i]==' ')? NULL : TTF_RenderUTF8_Blended(font, buf, (SDL_Color){255,255,255,255});
+        int adv=0, w=0, h=0;
+        if(TTF_GlyphMetrics(font, (Uint16)cps[i], NULL, NULL, NULL, NULL, &adv)!=0){ TTF_SizeUTF8(font, buf, &w, &h); adv=w; }
+        Glyph* g = &ts->glyphs[ts->nglyphs];
+        g->cp = cps[i]; g->advance = adv;
+        g->src = (SDL_Rect){0,0,0,0};
+        if(s){
+            if(x + s->w > ATLAS_W){ x=0; y+=ts->line_h+1; }
+            g->src = (SDL_Rect){ x, y, s->w, s->h };
+            x += s->w + 1;
+        }
+        surf[ts->nglyphs] = s;
+        if(cps[i]<256) ts->latin[cps[i]] = (short)ts->nglyphs;
+        if(cps[i]=='?') ts->fallback = ts->nglyphs;
+        ts->nglyphs++;
+    }
+    ts->atlas_h = 1; while(ts->atlas_h < y + ts->line_h + 1) ts->atlas_h <<= 1;
+
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_W, ts->atlas_h, 32, SDL_PIXELFORMAT_RGBA32);
+    if(sheet){
+        SDL_FillRect(sheet, NULL, 0);
+        for(int i=0;i<ts->nglyphs;i++) if(surf[i]){
+            SDL_Rect dst = ts->glyphs[i].src;
+            SDL_SetSurfaceBlendMode(surf[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surf[i], NULL, sheet, &dst);
+        }
+        ts->atlas = SDL_CreateTextureFromSurface(r, sheet);
+        SDL_FreeSurface(sheet);
+    }
+    for(int i=0;i<ts->nglyphs;i++) if(surf[i]) SDL_FreeSurface(surf[i]);
+    if(!ts->atlas){ SDL_Log("Glyph atlas failed: %s", SDL_GetError()); free(ts); return NULL; }
+    SDL_SetTextureBlendMode(ts->atlas, SDL_BLENDMODE_BLEND);
+    ts->stats.textures_created = 1;
+    return ts;
+}
+
+void text_destroy(TextSys* ts){
+    if(!ts) return;
+    for(int i=0;i<CACHE_SLOTS;i++){ free(ts->cache[i].text); free(ts->cache[i].verts); }
+    free(ts->scratch); free(ts->indices);
+    if(ts->atlas) SDL_DestroyTexture(ts->atlas);
+    free(ts);
+}
+
+static Uint32 key_hash(const char* msg, SDL_Color c){
+    Uint32 h=2166136261u;
+    for(const unsigned char* p=(const unsigned char*)msg; *p; p++){ h^=*p; h*=16777619u; }
+    h^=(Uint32)c.r | (Uint32)c.g<<8 | (Uint32)c.b<<16 | (Uint32)c.a<<24; h*=16777619u;
+    return h;
+}
+
+static bool ensure_scratch(TextSys* ts, int quads){
+    if(quads <= ts->scratch_cap) return true;
+    int cap = ts->scratch_cap? ts->scratch_cap : 64;
+    while(cap < quads) cap *= 2;
+    SDL_Vertex* v = realloc(ts->scratch, (size_t)cap*4*sizeof *v);
+    if(!v) return false;
+    ts->scratch = v;
+    int* idx = realloc(ts->indices, (size_t)cap*6*sizeof *idx);
+    if(!idx) return false;
+    ts->indices = idx;
+    for(int q=ts->scratch_cap;q<cap;q++){
+        int* o=&idx[q*6]; int b=q*4;
+        o[0]=b; o[1]=b+1; o[2]=b+2; o[3]=b; o[4]=b+2; o[5]=b+3;
+    }
+    ts->scratch_cap = cap;
+    return true;
+}
+
+// Lay msg out at the origin: one quad (4 vertices) per visible glyph.
+static CacheEntry* layout(TextSys* ts, const char* msg, SDL_Color c, Uint32 hash){
+    CacheEntry* victim=&ts->cache[0];
+    for(int i=0;i<CACHE_SLOTS;i++){
+        CacheEntry* e=&ts->cache[i];
+        if(e->text && e->hash==hash && memcmp(&e->color,&c,sizeof c)==0 && strcmp(e->text,msg)==0){
+            e->last_used=++ts->clock; ts->stats.cache_hits++; return e;
+        }
+        if(!e->text || e->last_used < victim->last_used) victim = e;
+        if(!e->text) break;
+    }
+    ts->stats.cache_misses++;
+    int glyphs=0; for(const char* p=msg; *p; ){ next_cp(&p); glyphs++; }
+    SDL_Vertex* v = malloc((size_t)(glyphs? glyphs:1)*4*sizeof *v);
+    char* copy = malloc(strlen(msg)+1);
+    if(!v || !copy){ free(v); free(copy); return NULL; }
+    strcpy(copy, msg);
+    float iw=1.0f/ATLAS_W, ih=1.0f/ts->atlas_h;
+    int pen=0, nv=0;
+    for(const char* p=msg; *p; ){
+        const Glyph* g = glyph_for(ts, next_cp(&p));
+        if(g->src.w){
+            float x0=(float)pen, y0=0, x1=x0+g->src.w, y1=(float)g->src.h;
+            float u0=g->src.x*iw, v0=g->src.y*ih, u1=(g->src.x+g->src.w)*iw, v1=(g->src.y+g->src.h)*ih;
+            v[nv++]=(SDL_Vertex){{x0,y0},c,{u0,v0}}; v[nv++]=(SDL_Vertex){{x1,y0},c,{u1,v0}};
+            v[nv++]=(SDL_Vertex){{x1,y1},c,{u1,v1}}; v[nv++]=(SDL_Vertex){{x0,y1},c,{u0,v1}};
+        }
+        pen += g->advance;
+    }
+    free(victim->text); free(victim->verts);
+    *victim = (CacheEntry){ hash, copy, c, v, nv, pen, ++ts->clock };
+    return victim;
+}
+
+void text_draw(TextSys* ts, const char* msg, int x, int y, SDL_Color color){
+    if(!ts || !msg || !*msg) return;
+    ts->stats.draws++;
+    CacheEntry* e = layout(ts, msg, color, key_hash(msg, color));
+    if(!e || !e->nverts || !ensure_scratch(ts, e->nverts/4)) return;
+    for(int i=0;i<e->nverts;i++){
+        ts->scratch[i]=e->verts[i];
+        ts->scratch[i].position.x += (float)x; ts->scratch[i].position.y += (float)y;
+    }
+    ts->stats.quads += e->nverts/4;
+#if SDL_VERSION_ATLEAST(2,0,18)
+    SDL_RenderGeometry(ts->r, ts->atlas, ts->scratch, e->nverts, ts->indices, e->nverts/4*6);
+#else
+    SDL_SetTextureColorMod(ts->atlas, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(ts->atlas, color.a);
+    for(int q=0;q<e->nverts;q+=4){
+        const SDL_Vertex* v=&ts->scratch[q];
+        SDL_Rect src={ (int)(v[0].tex_coord.x*ATLAS_W+0.5f), (int)(v[0].tex_coord.y*ts->atlas_h+0.5f),
+                       (int)(v[2].position.x-v[0].position.x), (int)(v[2].position.y-v[0].position.y) };
+        SDL_Rect dst={ (int)v[0].position.x, (int)v[0].position.y, src.w, src.h };
+        SDL_RenderCopy(ts->r, ts->atlas, &src, &dst);
+    }
+#endif
+}
+
+int text_width(TextSys* ts, const char* msg){
+    if(!ts || !msg) return 0;
+    int w=0;
+    for(const char* p=msg; *p; ) w += glyph_for(ts, next_cp(&p))->advance;
+    return w;
+}
+
+int text_height(const TextSys* ts){ return ts? ts->line_h : 0; }
+
+TextStats text_stats(const TextSys* ts){ TextStats z={0}; return ts? ts->stats : z; }
+
+void text_frame_reset(TextSys* ts){
+    if(!ts) return;
+    int created = ts->stats.textures_created;
+    memset(&ts->stats, 0, sizeof ts->stats);
+    ts->stats.textures_created = created;
+}
@@ -0,0 +1,32 @@
+// text.h — glyph-atlas text rendering. Glyphs are rasterized once into a single
+// texture; strings are drawn as one batch of textured quads, and their laid-out
+// geometry is cached by (text, colour) so static menu strings are never re-shaped.
+#ifndef PACMAN_TEXT_H
+#define PACMAN_TEXT_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+typedef struct TextSys TextSys;
+
+typedef struct {
+    int draws;              // text_draw() calls
+    int cache_hits, cache_misses;
+    int quads;              // glyph quads submitted
+    int textures_created;   // cumulative: the atlas, normally exactly 1
+} TextStats;
+
+// Build the atlas from an open font. NULL on failure (callers fall back to TTF_RenderUTF8).
+TextSys* text_create(SDL_Renderer* r, TTF_Font* font);
+void text_destroy(TextSys* ts);
+
+void text_draw(TextSys* ts, const char* msg, int x, int y, SDL_Color color);
+// Pixel width of msg as text_draw() lays it out (no rasterization).
+int text_width(TextSys* ts, const char* msg);
+int text_height(const TextSys* ts);
+
+// Per-frame counters are zeroed by text_frame_reset(); textures_created is cumulative.
+TextStats text_stats(const TextSys* ts);
+void text_frame_reset(TextSys* ts);
+
+#endif
@@ -0,0 +1,50 @@
+// assetc.c — packs game assets into one archive for the front end to map (assetpack.h).
+// Build: cc -O2 -I. tools/assetc.c assetpack.c mapfile.c -o assetc
+// Usage: ./assetc build OUT.pak ROOT FILE...   store each FILE under its path below ROOT
+//        ./assetc list ARCHIVE                 print the directory and verify checksums
+//
+// e.g.   ./assetc build assets/assets.pak assets assets/DejaVuSans.ttf assets/audio/*
+#include "assetpack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int list(const char* path){
+    char err[256];
+    AssetPack* p = assetpack_open(path, err, sizeof err);
+    if(!p){ fprintf(stderr, "%s\n", err); return 1; }
+    size_t total = 0;
+    for(int i=0;i<assetpack_count(p);i++){
+        const ArchiveEntry* e = assetpack_entry(p, i);
+        printf("%10u  %08x  %s\n", e->size, e->checksum, e->name);
+        total += e->size;
+    }
+    int bad = assetpack_verify(p, err, sizeof err);
+    printf("%d assets, %zu bytes%s%s\n", assetpack_count(p), total, bad ? "; " : "", bad ? err : "");
+    assetpack_close(p);
+    return bad ? 1 : 0;
+}
+
+int main(int argc, char** argv){
+    if(argc>=5 && strcmp(argv[1], "build")==0){
+        int n = argc-4;
+        const char* root = argv[3]; size_t rl = strlen(root);
+        while(rl && root[rl-1]=='/') rl--;
+        const char** names = calloc((size_t)n, sizeof *names);
+        if(!names){ fprintf(stderr, "out of memory\n"); return 1; }
+        for(int i=0;i<n;i++){
+            const char* f = argv[4+i];
+            if(strncmp(f, root, rl)!=0 || f[rl]!='/'){ fprintf(stderr, "%s: not below %s\n", f, root); free(names); return 1; }
+            names[i] = f + rl + 1;
+        }
+        char err[256];
+        bool ok = assetpack_write(argv[2], names, (const char* const*)argv+4, n, err, sizeof err);
+        free(names);
+        if(!ok){ fprintf(stderr, "%s\n", err); return 1; }
+        printf("wrote %s\n", argv[2]);
+        return list(argv[2]);
+    }
+    if(argc==3 && strcmp(argv[1], "list")==0) return list(argv[2]);
+    fprintf(stderr, "usage: %s build OUT.pak ROOT FILE...\n       %s list ARCHIVE\n", argv[0], argv[0]);
+    return 2;
+}
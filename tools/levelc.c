@@ -0,0 +1,32 @@
+// levelc.c — offline level compiler: text mazes in, binary level pack out (levelpack.h).
+// Build: cc -O2 -pthread -I. tools/levelc.c levelpack.c mapfile.c sim.c nav.c graph.c trace.c telemetry.c -o levelc
+// Usage: ./levelc build OUT.pack LEVEL.txt...   compile, then validate the result
+//        ./levelc check PACK                    validate an existing pack
+// Text format: see levelpack_parse_text() in levelpack.h.
+
+#include "levelpack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char** argv){
+    if(argc>=4 && strcmp(argv[1], "build")==0){
+        int n = argc-3;
+        LevelSource* src = calloc((size_t)n, sizeof *src);
+        if(!src){ fprintf(stderr, "out of memory\n"); return 1; }
+        char err[256];
+        for(int i=0;i<n;i++) if(!levelpack_parse_text(argv[3+i], &src[i], err, sizeof err)){ fprintf(stderr, "%s\n", err); free(src); return 1; }
+        bool ok = levelpack_write(argv[2], src, n, err, sizeof err);
+        free(src);
+        if(!ok){ fprintf(stderr, "%s\n", err); return 1; }
+        printf("wrote %s (%d levels)\n", argv[2], n);
+        return levelpack_validate(argv[2], stdout) ? 1 : 0;
+    }
+    if(argc==3 && strcmp(argv[1], "check")==0){
+        int errors = levelpack_validate(argv[2], stdout);
+        if(errors) printf("%d error(s)\n", errors);
+        return errors ? 1 : 0;
+    }
+    fprintf(stderr, "usage: %s build OUT.pack LEVEL.txt...\n       %s check PACK\n", argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,282 @@
+// telemstat.c — offline reader for gameplay telemetry logs (telemetry.h). For every
+// level seen (told apart by layout hash) it prints per-tile death and traffic heatmaps,
+// where and to whom lives are lost, ghost eat streaks, and how long each schedule
+// phase really lasted against its scheduled length. The files are streamed through one
+// fixed buffer, so memory stays flat however many gigabytes of logs go in.
+// Build: cc -O2 -I. tools/telemstat.c -lm -o telemstat
+// Usage: ./telemstat [--csv PREFIX] LOG...
+//        --csv PREFIX  also write PREFIX-<hash>-deaths.csv and -traffic.csv per level
+//                      (MAP_H rows of MAP_W counts)
+
+#define _POSIX_C_SOURCE 199309L
+#include "telemetry.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_LEVELS 16
+#define MAX_PHASES 16
+#define MAX_STREAMS 4096            // per session; higher stream numbers share slots
+#define HIST_TICKS 4096             // phase lengths, one bucket per tick; the last holds longer
+#define BUF_BYTES (8u<<20)
+
+typedef struct {
+    uint64_t n, sum, deaths;        // deaths: lives lost while this phase was current
+    uint32_t sched, min, max;
+    int mode;
+    uint32_t hist[HIST_TICKS+1];
+} PhaseStat;
+
+typedef struct {
+    uint32_t hash;
+    int phase_count;
+    uint64_t games, won, over, score, ticks;       // score and ticks over finished games
+    uint64_t pellets, powers, eaten, streak[4];    // streak: 1st, 2nd, 3rd, 4th+ ghost of a power pellet
+    uint64_t deaths, by_ghost[4], by_mode[3];
+    uint64_t death[MAP_H][MAP_W], traffic[MAP_H][MAP_W];
+    PhaseStat phase[MAX_PHASES];
+} LevelStat;
+
+typedef struct { int level, phase; } Stream;       // level -1: no TE_START seen yet
+
+static LevelStat* levels[MAX_LEVELS];
+static int nlevels;
+static Stream streams[MAX_STREAMS];
+static struct { uint64_t bytes, events, blocks, sessions, dropped, orphans, skipped_levels; } tot;
+
+static double now_sec(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static int level_for(uint32_t hash, int phase_count){
+    for(int i=0;i<nlevels;i++) if(levels[i]->hash==hash) return i;
+    if(nlevels==MAX_LEVELS) return -1;
+    LevelStat* l = calloc(1, sizeof *l);
+    if(!l) return -1;
+    l->hash = hash; l->phase_count = phase_count;
+    for(int p=0;p<MAX_PHASES;p++){ l->phase[p].min = UINT32_MAX; l->phase[p].mode = -1; }
+    levels[nlevels] = l;
+    return nlevels++;
+}
+
+static void event(Stream* s, const TelemEvent* e){
+    if(e->type==TE_START){
+        s->level = level_for((uint32_t)e->value2, e->arg);
+        s->phase = 0;
+        if(s->level<0){ tot.skipped_levels++; return; }
+        levels[s->level]->games++;
+        return;
+    }
+    if(s->level<0){ tot.orphans++; return; }
+    LevelStat* l = levels[s->level];
+    bool on_board = e->x<MAP_W && e->y<MAP_H;
+    switch(e->type){
+    case TE_MOVE: if(on_board) l->traffic[e->y][e->x]++; break;
+    case TE_PELLET: l->pellets++; break;
+    case TE_POWER: l->powers++; break;
+    case TE_GHOST_EATEN:
+        l->eaten++;
+        l->streak[e->value<1 ? 0 : e->value>4 ? 3 : e->value-1]++;
+        break;
+    case TE_DEATH:
+        l->deaths++;
+        if(on_board) l->death[e->y][e->x]++;
+        if(e->arg<4) l->by_ghost[e->arg]++;
+        if(e->value2>=0 && e->value2<3) l->by_mode[e->value2]++;
+        if(s->phase<MAX_PHASES) l->phase[s->phase].deaths++;
+        break;
+    case TE_PHASE: {
+        if(e->x<MAX_PHASES){
+            PhaseStat* p = &l->phase[e->x];
+            uint32_t d = e->value<0 ? 0 : (uint32_t)e->value;
+            p->n++; p->sum += d; p->sched = (uint32_t)e->value2; p->mode = e->arg;
+            if(d<p->min) p->min = d;
+            if(d>p->max) p->max = d;
+            p->hist[d>HIST_TICKS ? HIST_TICKS : d]++;
+        }
+        s->phase = e->x+1;
+        break;
+    }
+    case TE_WON: l->won++; l->score += (uint64_t)e->value; l->ticks += e->tick; break;
+    case TE_OVER: l->over++; l->score += (uint64_t)e->value; l->ticks += e->tick; break;
+    }
+}
+
+// ===== Reading =====
+typedef struct { FILE* f; uint8_t* buf; size_t have, pos; uint64_t off; } Reader;
+
+// At least n unread bytes in the buffer; false at the end of the file.
+static bool need(Reader* r, size_t n){
+    if(r->have - r->pos >= n) return true;
+    memmove(r->buf, r->buf + r->pos, r->have - r->pos);
+    r->have -= r->pos; r->off += r->pos; r->pos = 0;
+    r->have += fread(r->buf + r->have, 1, BUF_BYTES - r->have, r->f);
+    return r->have >= n;
+}
+
+static bool read_log(const char* path, uint8_t* buf){
+    Reader r = { fopen(path, "rb"), buf, 0, 0, 0 };
+    if(!r.f){ fprintf(stderr, "%s: cannot open\n", path); return false; }
+    bool ok = true, session = false;
+    while(need(&r, 4)){
+        const uint8_t* p = r.buf + r.pos;
+        if(!memcmp(p, "PMTL", 4)){
+            TelemHeader h;
+            if(!need(&r, sizeof h)){ fprintf(stderr, "%s: partial header at the end\n", path); break; }
+            memcpy(&h, r.buf + r.pos, sizeof h); r.pos += sizeof h;
+            if(h.version!=TELEM_VERSION || h.event_size!=sizeof(TelemEvent) || h.map_w!=MAP_W || h.map_h!=MAP_H){
+                fprintf(stderr, "%s: session at byte %llu is version %u, %u-byte events, %ux%u map; cannot read it\n",
+                        path, (unsigned long long)(r.off + r.pos - sizeof h), h.version, h.event_size, h.map_w, h.map_h);
+                ok = false; break;
+            }
+            for(int i=0;i<MAX_STREAMS;i++) streams[i] = (Stream){ -1, 0 };
+            tot.sessions++; session = true;
+        }else if(!memcmp(p, "PMTB", 4) && session){
+            TelemBlock b;
+            if(!need(&r, sizeof b)){ fprintf(stderr, "%s: partial block at the end\n", path); break; }
+            memcpy(&b, r.buf + r.pos, sizeof b); r.pos += sizeof b;
+            Stream* s = &streams[b.stream % MAX_STREAMS];
+            tot.blocks++; tot.dropped += b.dropped;
+            uint32_t left = b.count;
+            while(left>0){
+                if(!need(&r, sizeof(TelemEvent))) break;
+                size_t n = (r.have - r.pos) / sizeof(TelemEvent);
+                if(n>left) n = left;
+                for(size_t i=0;i<n;i++){
+                    TelemEvent e; memcpy(&e, r.buf + r.pos + i*sizeof e, sizeof e);
+                    event(s, &e);
+                }
+                r.pos += n*sizeof(TelemEvent); left -= (uint32_t)n; tot.events += n;
+            }
+            if(left>0){ fprintf(stderr, "%s: last block cut short, %u events missing\n", path, left); break; }
+        }else{
+            fprintf(stderr, "%s: not a telemetry record at byte %llu\n", path, (unsigned long long)(r.off + r.pos));
+            ok = false; break;
+        }
+    }
+    tot.bytes += r.off + r.pos;
+    fclose(r.f);
+    return ok;
+}
+
+// ===== Report =====
+// '#' never entered, ' ' entered but none, then a square-root scale up to the busiest tile.
+static char shade(uint64_t n, uint64_t max, uint64_t entered){
+    static const char ramp[] = ".:-=+*%@";
+    if(!n) return entered ? ' ' : '#';
+    int k = (int)(sqrt((double)n / (double)max) * 7.0 + 0.5);
+    return ramp[k>7 ? 7 : k];
+}
+
+static uint32_t phase_pct(const PhaseStat* p, int pct){
+    uint64_t want = (p->n*(uint64_t)pct + 99)/100, seen = 0;
+    for(uint32_t t=0;t<=HIST_TICKS;t++){ seen += p->hist[t]; if(seen>=want) return t; }
+    return HIST_TICKS;
+}
+
+static void report(const LevelStat* l){
+    static const char* MODE[3] = { "scatter", "chase", "fright" };
+    static const char* GHOST[4] = { "red", "pink", "blue", "orange" };
+    uint64_t done = l->won + l->over;
+    printf("\nlevel %08X: %llu games, %llu won, %llu lost, %llu unfinished", l->hash,
+           (unsigned long long)l->games, (unsigned long long)l->won, (unsigned long long)l->over,
+           (unsigned long long)(l->games - done));
+    if(done) printf("; finished games avg score %.1f, %.1f ticks (%.1f s)",
+                    (double)l->score/done, (double)l->ticks/done, (double)l->ticks/done*TICK_MS/1000.0);
+    printf("\n");
+
+    uint64_t dmax = 0, tmax = 0;
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++){
+        if(l->death[y][x]>dmax) dmax = l->death[y][x];
+        if(l->traffic[y][x]>tmax) tmax = l->traffic[y][x];
+    }
+    printf("%-*s   traffic (max %llu entries on a tile)\n", MAP_W, "deaths", (unsigned long long)tmax);
+    for(int y=0;y<MAP_H;y++){
+        char a[MAP_W+1], b[MAP_W+1];
+        for(int x=0;x<MAP_W;x++){
+            a[x] = shade(l->death[y][x], dmax, l->traffic[y][x]);
+            b[x] = shade(l->traffic[y][x], tmax, 0);
+        }
+        a[MAP_W] = b[MAP_W] = 0;
+        printf("%s   %s\n", a, b);
+    }
+    printf("'#' never entered, ' ' none, then %s up to the busiest tile, square-root scale\n", "\".:-=+*%@\"");
+
+    printf("deaths %llu, %.2f per game", (unsigned long long)l->deaths, l->games ? (double)l->deaths/l->games : 0.0);
+    for(int g=0;g<4;g++) printf("%s %s %llu", g ? "," : " |", GHOST[g], (unsigned long long)l->by_ghost[g]);
+    printf(" | in scatter %llu, chase %llu\n", (unsigned long long)l->by_mode[MODE_SCATTER], (unsigned long long)l->by_mode[MODE_CHASE]);
+    if(l->deaths){
+        printf("deadliest tiles:");
+        bool taken[MAP_H][MAP_W] = {{false}};
+        for(int k=0;k<5;k++){
+            int bx=0, by=0; uint64_t best = 0;
+            for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++)
+                if(!taken[y][x] && l->death[y][x]>best){ best = l->death[y][x]; bx = x; by = y; }
+            if(!best) break;
+            taken[by][bx] = true;
+            printf(" (%d,%d) %.1f%%", bx, by, 100.0*best/l->deaths);
+        }
+        printf("\n");
+    }
+    printf("pellets %llu, power pellets %llu, ghosts eaten %llu (1st %llu, 2nd %llu, 3rd %llu, 4th %llu)\n",
+           (unsigned long long)l->pellets, (unsigned long long)l->powers, (unsigned long long)l->eaten,
+           (unsigned long long)l->streak[0], (unsigned long long)l->streak[1],
+           (unsigned long long)l->streak[2], (unsigned long long)l->streak[3]);
+
+    printf("phase  mode     sched   switches   mean    p50    p95    max  overrun  deaths   (ticks of %d ms)\n", TICK_MS);
+    int last_phase = l->phase_count > MAX_PHASES ? MAX_PHASES : l->phase_count;
+    while(last_phase>0 && !l->phase[last_phase-1].n && !l->phase[last_phase-1].deaths) last_phase--;   // never reached
+    for(int i=0;i<last_phase;i++){
+        const PhaseStat* p = &l->phase[i];
+        if(!p->n){
+            printf("%5d  %-7s  %5s  %9s  %5s  %5s  %5s  %5s  %7s  %6llu\n", i, "-", "-", "0", "-", "-", "-", "-", "-", (unsigned long long)p->deaths);
+            continue;
+        }
+        double mean = (double)p->sum/p->n;
+        printf("%5d  %-7s  %5u  %9llu  %5.1f  %5u  %5u  %5u  %+7.1f  %6llu\n", i, p->mode>=0 && p->mode<3 ? MODE[p->mode] : "?",
+               p->sched, (unsigned long long)p->n, mean, phase_pct(p, 50), phase_pct(p, 95), p->max, mean - p->sched,
+               (unsigned long long)p->deaths);
+    }
+}
+
+static bool write_csv(const char* prefix, const LevelStat* l, const char* what, uint64_t (*grid)[MAP_W]){
+    char path[1024]; snprintf(path, sizeof path, "%s-%08X-%s.csv", prefix, l->hash, what);
+    FILE* f = fopen(path, "w");
+    if(!f){ fprintf(stderr, "cannot write %s\n", path); return false; }
+    for(int y=0;y<MAP_H;y++) for(int x=0;x<MAP_W;x++) fprintf(f, "%llu%c", (unsigned long long)grid[y][x], x==MAP_W-1 ? '\n' : ',');
+    return fclose(f)==0;
+}
+
+int main(int argc, char** argv){
+    const char* csv = NULL;
+    int first = 1;
+    if(argc>2 && !strcmp(argv[1], "--csv")){ csv = argv[2]; first = 3; }
+    if(first>=argc){ fprintf(stderr, "usage: %s [--csv PREFIX] LOG...\n", argv[0]); return 2; }
+    uint8_t* buf = malloc(BUF_BYTES);
+    if(!buf){ fprintf(stderr, "out of memory\n"); return 1; }
+    bool ok = true;
+    double t0 = now_sec();
+    for(int i=first;i<argc;i++) ok &= read_log(argv[i], buf);
+    double dt = now_sec() - t0;
+    free(buf);
+
+    printf("%d file(s), %.1f MB, %llu sessions, %llu events in %llu blocks, %llu dropped by the game, read in %.2f s (%.0f MB/s)\n",
+           argc-first, tot.bytes/1048576.0, (unsigned long long)tot.sessions, (unsigned long long)tot.events,
+           (unsigned long long)tot.blocks, (unsigned long long)tot.dropped, dt, dt>0 ? tot.bytes/1048576.0/dt : 0.0);
+    if(tot.orphans) printf("%llu events before their stream's game start (ignored)\n", (unsigned long long)tot.orphans);
+    if(tot.skipped_levels) printf("%llu games on levels past the first %d (ignored)\n", (unsigned long long)tot.skipped_levels, MAX_LEVELS);
+
+    // Busiest level first.
+    for(int i=1;i<nlevels;i++) for(int j=i; j>0 && levels[j]->games > levels[j-1]->games; j--){
+        LevelStat* t = levels[j]; levels[j] = levels[j-1]; levels[j-1] = t;
+    }
+    for(int i=0;i<nlevels;i++){
+        report(levels[i]);
+        if(csv) ok &= write_csv(csv, levels[i], "deaths", levels[i]->death) && write_csv(csv, levels[i], "traffic", levels[i]->traffic);
+        free(levels[i]);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+// trace.c — span ring, frame-time window and Chrome trace export (see trace.h).
+#define _POSIX_C_SOURCE 199309L
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t mono_ns(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+_Thread_local bool trace_on = false;
+static _Thread_local uint32_t trace_tid = 1;
+_Atomic uint32_t trace_counts[TC_COUNT];
+uint64_t (*trace_clock)(void) = mono_ns;
+static uint64_t clock_freq = 1000000000u;
+
+typedef struct { const char* name; uint64_t start, end; uint32_t tid; } Span;
+static Span ring[TRACE_RING];
+static _Atomic uint32_t ring_head;              // total spans recorded; slot is head % TRACE_RING
+
+typedef struct { uint64_t end; uint32_t dur; uint32_t counts[TC_COUNT]; } Frame;
+static Frame frames[TRACE_FRAMES];              // dur in clock ticks, clamped to 32 bits
+static uint32_t frame_head;
+static uint64_t frame_start;
+
+static const char* COUNTER_NAMES[TC_COUNT] = { "ticks", "path queries", "bfs", "draw calls" };
+
+static void counts_take(uint32_t* out){
+    for(int c=0;c<TC_COUNT;c++){
+        uint32_t n = atomic_exchange_explicit(&trace_counts[c], 0, memory_order_relaxed);
+        if(out) out[c] = n;
+    }
+}
+
+void trace_enable(bool on){
+    if(on && !trace_on) frame_start = trace_clock();
+    trace_on = on;
+    counts_take(NULL);
+}
+
+void trace_thread(int tid){ trace_on = true; trace_tid = (uint32_t)tid; }
+
+void trace_set_clock(uint64_t (*now)(void), uint64_t freq){
+    trace_clock = now ? now : mono_ns;
+    clock_freq = now && freq ? freq : 1000000000u;
+    atomic_store(&ring_head, 0); frame_head = 0;
+    frame_start = trace_clock();
+}
+
+void trace_span(const char* name, uint64_t start, uint64_t end){
+    Span* s = &ring[atomic_fetch_add_explicit(&ring_head, 1, memory_order_relaxed) % TRACE_RING];
+    s->name = name; s->start = start; s->end = end; s->tid = trace_tid;
+}
+
+void trace_frame_end(void){
+    if(!trace_on) return;
+    uint64_t now = trace_clock();
+    Frame* f = &frames[frame_head++ % TRACE_FRAMES];
+    uint64_t d = now - frame_start;
+    f->end = now; f->dur = d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+    counts_take(f->counts);
+    trace_span("frame", frame_start, now);
+    frame_start = now;
+}
+
+void trace_frame_restart(void){ if(trace_on) frame_start = trace_clock(); }
+
+static int cmp_u32(const void* a, const void* b){
+    uint32_t x=*(const uint32_t*)a, y=*(const uint32_t*)b; return (x>y)-(x<y);
+}
+
+TraceFrameStats trace_frame_stats(void){
+    TraceFrameStats st; memset(&st, 0, sizeof st);
+    int n = frame_head < TRACE_FRAMES ? (int)frame_head : TRACE_FRAMES;
+    if(n==0) return st;
+    uint32_t d[TRACE_FRAMES];
+    double ms = 1000.0 / (double)clock_freq, sum = 0, dev = 0;
+    for(int i=0;i<n;i++){ d[i] = frames[i].dur; sum += d[i]*ms; }
+    st.mean_ms = sum / n;
+    for(int i=0;i<n;i++){ double x = d[i]*ms - st.mean_ms; dev += x < 0 ? -x : x; }
+    st.jitter_ms = dev / n;
+    qsort(d, (size_t)n, sizeof d[0], cmp_u32);
+    st.p50_ms = d[(n-1)*50/100]*ms; st.p95_ms = d[(n-1)*95/100]*ms;
+    st.p99_ms = d[(n-1)*99/100]*ms; st.max_ms = d[n-1]*ms;
+    st.frames = n;
+    memcpy(st.last, frames[(frame_head-1) % TRACE_FRAMES].counts, sizeof st.last);
+    return st;
+}
+
+void trace_latency_add(TraceLatency* h, uint32_t ms){
+    h->bucket[ms < TRACE_LAT_MAX ? ms : TRACE_LAT_MAX]++;
+    h->n++; h->sum_ms += ms;
+    if(ms > h->max_ms) h->max_ms = ms;
+}
+
+uint32_t trace_latency_pct(const TraceLatency* h, int pct){
+    if(!h->n) return 0;
+    uint64_t want = ((uint64_t)h->n*pct + 99)/100, seen = 0;
+    for(uint32_t ms=0; ms<TRACE_LAT_MAX; ms++) if((seen += h->bucket[ms]) >= want) return ms;
+    return h->max_ms;
+}
+
+void trace_latency_line(const TraceLatency* h, char* out, size_t len){
+    if(!h->n){ snprintf(out, len, "n 0"); return; }
+    snprintf(out, len, "n %u | mean %.1f p50 %u p95 %u p99 %u max %u ms", h->n, h->sum_ms/h->n,
+             trace_latency_pct(h, 50), trace_latency_pct(h, 95), trace_latency_pct(h, 99), h->max_ms);
+}
+
+void trace_latency_chart(const TraceLatency* h, int bin_ms, void (*emit)(void* ctx, const char* row), void* ctx){
+    enum { BAR = 40 };
+    int bins = TRACE_LAT_MAX/bin_ms + 1;
+    uint32_t c[TRACE_LAT_MAX+1] = {0}, top = 0;
+    int first = -1, last = -1;
+    for(int ms=0; ms<=TRACE_LAT_MAX; ms++) c[ms/bin_ms] += h->bucket[ms];
+    for(int b=0; b<bins; b++) if(c[b]){ if(first<0) first = b; last = b; if(c[b] > top) top = c[b]; }
+    for(int b=first; b>=0 && b<=last; b++){
+        char row[96], bar[BAR+1];
+        int w = (int)((uint64_t)c[b]*BAR/top);
+        if(c[b] && !w) w = 1;
+        memset(bar, '#', (size_t)w); bar[w] = 0;
+        if((b+1)*bin_ms > TRACE_LAT_MAX) snprintf(row, sizeof row, "  >=%3d ms %6u %s", b*bin_ms, c[b], bar);
+        else snprintf(row, sizeof row, "%3d-%3d ms %6u %s", b*bin_ms, (b+1)*bin_ms-1, c[b], bar);
+        emit(ctx, row);
+    }
+}
+
+bool trace_dump(const char* path){
+    FILE* f = fopen(path, "w");
+    if(!f) return false;
+    // Other threads may still be recording; a span written during the dump can come
+    // out torn, which the viewers tolerate.
+    uint32_t head = atomic_load(&ring_head);
+    uint32_t n = head < TRACE_RING ? head : TRACE_RING;
+    uint32_t first = head - n;
+    uint64_t base = n ? ring[first % TRACE_RING].start : 0;
+    uint32_t nf = frame_head < TRACE_FRAMES ? frame_head : TRACE_FRAMES;
+    for(uint32_t i=frame_head-nf;i<frame_head;i++) if(frames[i % TRACE_FRAMES].end < base) base = frames[i % TRACE_FRAMES].end;
+    double us = 1e6 / (double)clock_freq;
+    bool comma = false;
+    fprintf(f, "{\"traceEvents\":[\n");
+    for(uint32_t i=first;i<head;i++){
+        const Span* s = &ring[i % TRACE_RING];
+        fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                comma ? ",\n" : "", s->name, s->tid, (double)(s->start-base)*us, (double)(s->end-s->start)*us);
+        comma = true;
+    }
+    for(uint32_t i=frame_head-nf;i<frame_head;i++){
+        const Frame* fr = &frames[i % TRACE_FRAMES];
+        for(int c=0;c<TC_COUNT;c++){
+            fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":{\"value\":%u}}",
+                    comma ? ",\n" : "", COUNTER_NAMES[c], (double)(fr->end-base)*us, fr->counts[c]);
+            comma = true;
+        }
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    return fclose(f)==0;
+}
@@ -0,0 +1,87 @@
+// trace.h — scoped timing spans and per-frame counters for the hot paths. Spans go
+// into a fixed ring buffer that can be written out as Chrome/Perfetto trace JSON
+// (chrome://tracing, ui.perfetto.dev); counters are summed per frame for the perf
+// overlay. No SDL dependency: the front end installs SDL_GetPerformanceCounter as
+// the clock, otherwise a monotonic nanosecond clock is used.
+//
+// Recording is off until trace_enable(true), so headless runs pay one branch per
+// site. Build with -DPACMAN_NO_TRACE to compile every TRACE_* site out entirely.
+// The switch is per thread: the game loop enables it, the simulation thread joins
+// with trace_thread() and shows as its own track, and sim code on other threads
+// (autopilot search) stays silent. Counters and the ring take atomic increments.
+#ifndef PACMAN_TRACE_H
+#define PACMAN_TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRACE_RING 16384        // spans kept (power of two); older ones are overwritten
+#define TRACE_FRAMES 240        // frame times kept for the percentile readout
+
+typedef enum {
+    TC_TICKS,                   // simulation ticks run
+    TC_PATH,                    // ghost path queries (next-hop table lookups)
+    TC_BFS,                     // live BFS searches (next_step_bfs, board_path_dir)
+    TC_DRAW,                    // renderer draw calls (fills, copies, text and sprite batches)
+    TC_COUNT
+} TraceCounter;
+
+typedef struct {
+    double p50_ms, p95_ms, p99_ms, max_ms;   // over the last TRACE_FRAMES frames
+    double mean_ms, jitter_ms;               // jitter: mean absolute deviation from mean_ms
+    int frames;                              // frames in the window
+    uint32_t last[TC_COUNT];                 // counters of the last finished frame
+} TraceFrameStats;
+
+// Latency histogram in whole milliseconds, for intervals measured on a millisecond
+// clock such as SDL event timestamps (input-to-state, input-to-present). One bucket
+// per ms up to TRACE_LAT_MAX; the last bucket also holds everything longer. Not
+// switched by trace_enable(): adding a sample is one increment.
+#define TRACE_LAT_MAX 250
+
+typedef struct {
+    uint32_t bucket[TRACE_LAT_MAX+1];
+    uint32_t n, max_ms;
+    double sum_ms;
+} TraceLatency;
+
+extern _Thread_local bool trace_on;
+extern _Atomic uint32_t trace_counts[TC_COUNT];
+extern uint64_t (*trace_clock)(void);
+
+void trace_enable(bool on);
+// Record from the calling thread as well, as track tid in the exported trace (the
+// thread that called trace_enable() is track 1).
+void trace_thread(int tid);
+// Clock used for spans and frame times, with its ticks per second.
+void trace_set_clock(uint64_t (*now)(void), uint64_t freq);
+void trace_span(const char* name, uint64_t start, uint64_t end);
+// Close the current frame: record its duration, keep its counters, start new ones.
+void trace_frame_end(void);
+// Start the current frame now: time spent idle since the last one is not frame time.
+void trace_frame_restart(void);
+TraceFrameStats trace_frame_stats(void);
+void trace_latency_add(TraceLatency* h, uint32_t ms);
+// Smallest latency that pct percent of the samples do not exceed; 0 with no samples.
+uint32_t trace_latency_pct(const TraceLatency* h, int pct);
+// "n 42 | mean 63.1 p50 61 p95 104 p99 110 max 118 ms"
+void trace_latency_line(const TraceLatency* h, char* out, size_t len);
+// Bar chart in bins of bin_ms, one row per bin from the first to the last non-empty
+// one, handed to emit() (a logger).
+void trace_latency_chart(const TraceLatency* h, int bin_ms, void (*emit)(void* ctx, const char* row), void* ctx);
+// Write the ring as {"traceEvents":[...]}; false if the file cannot be written.
+bool trace_dump(const char* path);
+
+#ifndef PACMAN_NO_TRACE
+#define TRACE_BEGIN(var)        uint64_t var = trace_on ? trace_clock() : 0
+#define TRACE_END(var, name)    do{ if(trace_on && (var)) trace_span((name), (var), trace_clock()); }while(0)
+#define TRACE_COUNT(c, n)       do{ if(trace_on) atomic_fetch_add_explicit(&trace_counts[c], (uint32_t)(n), memory_order_relaxed); }while(0)
+#else
+#define TRACE_BEGIN(var)        do{}while(0)
+#define TRACE_END(var, name)    do{}while(0)
+#define TRACE_COUNT(c, n)       do{}while(0)
+#endif
+
+#endif